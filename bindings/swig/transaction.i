@@ -106,8 +106,8 @@ typedef libdnf::CompsPackageType CompsPackageType;
 %include "libdnf/transaction/CompsEnvironmentItem.hpp"
 %include "libdnf/transaction/CompsGroupItem.hpp"
 %include "libdnf/transaction/RPMItem.hpp"
+%include "libdnf/transaction/Transformer.hpp"
 %include "libdnf/transaction/Swdb.hpp"
 %include "libdnf/transaction/Transaction.hpp"
 %include "libdnf/transaction/TransactionItem.hpp"
 %include "libdnf/transaction/MergedTransaction.hpp"
-%include "libdnf/transaction/Transformer.hpp"
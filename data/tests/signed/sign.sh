@@ -0,0 +1,4 @@
+# signed copy of ../modules/modules/_all/x86_64/basesystem-11-3.noarch.rpm,
+# the passphrase of the test key is libhif
+cp ../modules/modules/_all/x86_64/basesystem-11-3.noarch.rpm .
+rpmsign --define "_gpg_path ../gpgkey" --define "_gpg_name test@email.com" --addsign basesystem-11-3.noarch.rpm
@@ -110,6 +110,7 @@ typedef struct
     gchar            *vendor_cache_dir;
     gchar            *vendor_solv_dir;
     gchar            *lock_dir;
+    gchar            *package_store_dir;
     gchar            *os_info;
     gchar            *arch_info;
     gchar            *install_root;
@@ -120,10 +121,12 @@ typedef struct
     gchar            *user_agent;
     gchar            *arch;
     guint            cache_age;     /*seconds*/
+    guint64          package_store_size;
     gboolean         check_disk_space;
     gboolean         check_transaction;
     gboolean         only_trusted;
     gboolean         enable_filelists;
+    gboolean         enable_deltarpm;
     gboolean         keep_cache;
     gboolean         enrollment_valid;
     DnfLock         *lock;
@@ -168,6 +171,7 @@ dnf_context_finalize(GObject *object)
     g_free(priv->vendor_cache_dir);
     g_free(priv->vendor_solv_dir);
     g_free(priv->lock_dir);
+    g_free(priv->package_store_dir);
     g_free(priv->rpm_verbosity);
     g_free(priv->install_root);
     g_free(priv->source_root);
@@ -742,6 +746,51 @@ dnf_context_get_only_trusted(DnfContext *context)
     return priv->only_trusted;
 }
 
+/**
+ * dnf_context_get_enable_deltarpm:
+ * @context: a #DnfContext instance.
+ *
+ * Returns: %TRUE if packages are rebuilt from delta RPMs
+ *
+ * Since: 0.19.1
+ */
+gboolean
+dnf_context_get_enable_deltarpm (DnfContext     *context)
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+    return priv->enable_deltarpm;
+}
+
+/**
+ * dnf_context_get_package_store_dir:
+ * @context: a #DnfContext instance.
+ *
+ * Returns: the package store directory, or %NULL if not used
+ *
+ * Since: 0.19.1
+ */
+const gchar *
+dnf_context_get_package_store_dir (DnfContext     *context)
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+    return priv->package_store_dir;
+}
+
+/**
+ * dnf_context_get_package_store_size:
+ * @context: a #DnfContext instance.
+ *
+ * Returns: the maximum size of the package store in bytes, 0 for unlimited
+ *
+ * Since: 0.19.1
+ */
+guint64
+dnf_context_get_package_store_size (DnfContext     *context)
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+    return priv->package_store_size;
+}
+
 /**
  * dnf_context_get_enable_filelists:
  * @context: a #DnfContext instance.
@@ -1062,6 +1111,67 @@ dnf_context_set_keep_cache(DnfContext *context, gboolean keep_cache)
     priv->keep_cache = keep_cache;
 }
 
+/**
+ * dnf_context_set_enable_deltarpm:
+ * @context: a #DnfContext instance.
+ * @enable_deltarpm: %TRUE to rebuild packages from delta RPMs
+ *
+ * Enables or disables the download and parsing of the presto delta
+ * metadata, and rebuilding updated packages from delta RPMs when they
+ * are smaller than the full packages. Rebuilding needs applydeltarpm
+ * and is only used for the / install root.
+ *
+ * Since: 0.19.1
+ **/
+void
+dnf_context_set_enable_deltarpm (DnfContext     *context,
+                                 gboolean        enable_deltarpm)
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+    priv->enable_deltarpm = enable_deltarpm;
+}
+
+/**
+ * dnf_context_set_package_store_dir:
+ * @context: a #DnfContext instance.
+ * @package_store_dir: the package store directory, or %NULL
+ *
+ * Sets the directory of a package store shared by the repo caches.
+ * Packages are stored by their checksum, downloaded packages are
+ * published to the store and packages already in the store are
+ * hard linked (or reflinked) into the repo caches instead of being
+ * downloaded again. The store isn't used by default.
+ *
+ * Since: 0.19.1
+ **/
+void
+dnf_context_set_package_store_dir (DnfContext     *context,
+                                   const gchar    *package_store_dir)
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+    g_free(priv->package_store_dir);
+    priv->package_store_dir = g_strdup(package_store_dir);
+}
+
+/**
+ * dnf_context_set_package_store_size:
+ * @context: a #DnfContext instance.
+ * @package_store_size: the maximum size in bytes, 0 for unlimited
+ *
+ * Sets the maximum size of the package store. The least recently
+ * used packages are evicted from the store after each download
+ * which makes it grow over the limit.
+ *
+ * Since: 0.19.1
+ **/
+void
+dnf_context_set_package_store_size (DnfContext     *context,
+                                    guint64         package_store_size)
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+    priv->package_store_size = package_store_size;
+}
+
 /**
  * dnf_context_set_enable_filelists:
  * @context: a #DnfContext instance.
@@ -1312,6 +1422,8 @@ dnf_context_setup_sack_with_flags(DnfContext               *context,
         add_flags = static_cast<DnfSackAddFlags>(add_flags | DNF_SACK_ADD_FLAG_UPDATEINFO);
     if (priv->enable_filelists && !((flags & DNF_CONTEXT_SETUP_SACK_FLAG_SKIP_FILELISTS) > 0))
         add_flags = static_cast<DnfSackAddFlags>(add_flags | DNF_SACK_ADD_FLAG_FILELISTS);
+    if (priv->enable_deltarpm)
+        add_flags = static_cast<DnfSackAddFlags>(add_flags | DNF_SACK_ADD_FLAG_PRESTO);
 
     /* add remote */
     ret = dnf_sack_add_repos(priv->sack,
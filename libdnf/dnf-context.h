@@ -128,6 +128,9 @@ guint            dnf_context_get_cache_age              (DnfContext     *context
 guint            dnf_context_get_installonly_limit      (DnfContext     *context);
 const gchar     *dnf_context_get_http_proxy             (DnfContext     *context);
 gboolean         dnf_context_get_enable_filelists       (DnfContext     *context);
+gboolean         dnf_context_get_enable_deltarpm        (DnfContext     *context);
+const gchar     *dnf_context_get_package_store_dir      (DnfContext     *context);
+guint64          dnf_context_get_package_store_size     (DnfContext     *context);
 GPtrArray       *dnf_context_get_repos                  (DnfContext     *context);
 #ifndef __GI_SCANNER__
 DnfRepoLoader   *dnf_context_get_repo_loader            (DnfContext     *context);
@@ -171,6 +174,12 @@ void             dnf_context_set_keep_cache             (DnfContext     *context
                                                          gboolean        keep_cache);
 void             dnf_context_set_enable_filelists       (DnfContext     *context,
                                                          gboolean        enable_filelists);
+void             dnf_context_set_enable_deltarpm        (DnfContext     *context,
+                                                         gboolean        enable_deltarpm);
+void             dnf_context_set_package_store_dir      (DnfContext     *context,
+                                                         const gchar    *package_store_dir);
+void             dnf_context_set_package_store_size     (DnfContext     *context,
+                                                         guint64         package_store_size);
 void             dnf_context_set_only_trusted           (DnfContext     *context,
                                                          gboolean        only_trusted);
 void             dnf_context_set_cache_age              (DnfContext     *context,
@@ -299,3 +299,71 @@ out:
         Fclose(fd);
     return ret;
 }
+
+typedef struct {
+    const gchar *filename;
+    GError **error;
+} DnfKeyringCheckJob;
+
+static void
+dnf_keyring_check_untrusted_file_cb(gpointer data, gpointer user_data)
+{
+    auto job = static_cast< DnfKeyringCheckJob * >(data);
+    auto keyring = static_cast< rpmKeyring >(user_data);
+    dnf_keyring_check_untrusted_file(keyring, job->filename, job->error);
+}
+
+/**
+ * dnf_keyring_check_untrusted_files:
+ * @keyring: a #rpmKeyring instance.
+ * @filenames: (element-type utf8): package files to check
+ * @errors: array of @filenames->len errors to set, %NULL for trusted files
+ * @error: A #GError or %NULL
+ *
+ * Checks the files like dnf_keyring_check_untrusted_file() does, using
+ * a thread for each processor. Each check creates its own rpmts and
+ * header, only the keyring is shared. The errors are stored in the order
+ * of @filenames, so the caller can decide which failure to report.
+ *
+ * Returns: %FALSE if the threads could not be started
+ *
+ * Since: 0.19.1
+ */
+gboolean
+dnf_keyring_check_untrusted_files(rpmKeyring keyring,
+                                  GPtrArray *filenames,
+                                  GError **errors,
+                                  GError **error)
+{
+    GThreadPool *pool;
+    g_autofree DnfKeyringCheckJob *jobs = NULL;
+
+    if (filenames->len == 0)
+        return TRUE;
+
+    /* not worth the threads */
+    if (filenames->len == 1) {
+        dnf_keyring_check_untrusted_file(keyring,
+                                         static_cast< const gchar * >(g_ptr_array_index(filenames, 0)),
+                                         &errors[0]);
+        return TRUE;
+    }
+
+    pool = g_thread_pool_new(dnf_keyring_check_untrusted_file_cb,
+                             keyring,
+                             MIN(g_get_num_processors(), filenames->len),
+                             FALSE,
+                             error);
+    if (pool == NULL)
+        return FALSE;
+    jobs = g_new0(DnfKeyringCheckJob, filenames->len);
+    for (guint i = 0; i < filenames->len; i++) {
+        jobs[i].filename = static_cast< const gchar * >(g_ptr_array_index(filenames, i));
+        jobs[i].error = &errors[i];
+        g_thread_pool_push(pool, &jobs[i], NULL);
+    }
+
+    /* wait for all the checks */
+    g_thread_pool_free(pool, FALSE, TRUE);
+    return TRUE;
+}
@@ -36,6 +36,10 @@ gboolean         dnf_keyring_add_public_keys    (rpmKeyring              keyring
 gboolean         dnf_keyring_check_untrusted_file (rpmKeyring            keyring,
                                                  const gchar            *filename,
                                                  GError                 **error);
+gboolean         dnf_keyring_check_untrusted_files (rpmKeyring           keyring,
+                                                 GPtrArray              *filenames,
+                                                 GError                 **errors,
+                                                 GError                 **error);
 
 G_END_DECLS
 
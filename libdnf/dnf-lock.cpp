@@ -139,6 +139,8 @@ dnf_lock_type_to_string(DnfLockType lock_type)
         return "metadata";
     if (lock_type == DNF_LOCK_TYPE_CONFIG)
         return "config";
+    if (lock_type == DNF_LOCK_TYPE_PACKAGE_STORE)
+        return "package-store";
     return "unknown";
 }
 
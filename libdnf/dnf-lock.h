@@ -51,6 +51,7 @@ struct _DnfLockClass
  * @DNF_LOCK_TYPE_REPO:                         The repodir lock
  * @DNF_LOCK_TYPE_METADATA:                     The metadata lock
  * @DNF_LOCK_TYPE_CONFIG:                       The config lock
+ * @DNF_LOCK_TYPE_PACKAGE_STORE:                The package store lock
  *
  * The lock type.
  **/
@@ -59,6 +60,7 @@ typedef enum {
         DNF_LOCK_TYPE_REPO,
         DNF_LOCK_TYPE_METADATA,
         DNF_LOCK_TYPE_CONFIG,
+        DNF_LOCK_TYPE_PACKAGE_STORE,
         /*< private >*/
         DNF_LOCK_TYPE_LAST
 } DnfLockType;
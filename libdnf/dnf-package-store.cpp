@@ -0,0 +1,394 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * The package store keeps one copy of each package shared by all the
+ * repo caches. Packages are stored by their checksum as
+ * <store_dir>/<checksum type>/<first two hex digits>/<hex checksum>
+ * and the repo caches hold hard links (or reflinks when the store is on
+ * another filesystem) to them. A hard link shares the data with the
+ * store, so the downloads unlink a cache file with other links before
+ * writing it, and the checkout verifies the object it links.
+ *
+ * Files are always created under a temporary name starting with a dot
+ * and renamed into place, so concurrent writers publishing the same
+ * package never expose a partial file and the last rename just wins.
+ * Only the eviction is serialized by the package store lock, readers
+ * which lose the race with it simply download the package again.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include "dnf-lock.h"
+#include "dnf-package-store.hpp"
+#include "dnf-types.h"
+#include "hy-package.h"
+#include "hy-util.h"
+
+/* temporary files of crashed writers are removed after a day */
+#define DNF_PACKAGE_STORE_TMP_AGE       (24 * 60 * 60)
+
+typedef struct {
+    gchar       *path;
+    guint64      size;
+    gint64       mtime;
+} DnfPackageStoreEntry;
+
+static void
+dnf_package_store_entry_free(DnfPackageStoreEntry *entry)
+{
+    g_free(entry->path);
+    g_slice_free(DnfPackageStoreEntry, entry);
+}
+
+/**
+ * dnf_package_store_get_path:
+ *
+ * Returns: the path of @pkg in the store, or %NULL if it has no checksum
+ **/
+static gchar *
+dnf_package_store_get_path(const gchar *store_dir, DnfPackage *pkg)
+{
+    const unsigned char *chksum;
+    int chksum_type;
+    gchar prefix[3];
+    g_autofree gchar *chksum_str = NULL;
+
+    chksum = dnf_package_get_chksum(pkg, &chksum_type);
+    if (chksum == NULL)
+        return NULL;
+    chksum_str = hy_chksum_str(chksum, chksum_type);
+    if (chksum_str == NULL)
+        return NULL;
+    g_strlcpy(prefix, chksum_str, sizeof(prefix));
+    return g_build_filename(store_dir,
+                            hy_chksum_name(chksum_type),
+                            prefix,
+                            chksum_str,
+                            NULL);
+}
+
+/**
+ * dnf_package_store_reflink:
+ *
+ * Creates @dest sharing the data extents of @src, which works across
+ * directories on one filesystem which supports it even where hard
+ * links don't.
+ **/
+static gboolean
+dnf_package_store_reflink(const gchar *src, const gchar *dest, GError **error)
+{
+#ifdef FICLONE
+    int fd_src;
+    int fd_dest;
+    int rc;
+
+    fd_src = open(src, O_RDONLY | O_CLOEXEC);
+    if (fd_src < 0) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    "failed to open %s: %s",
+                    src, g_strerror(errno));
+        return FALSE;
+    }
+    fd_dest = open(dest, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd_dest < 0) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    "failed to create %s: %s",
+                    dest, g_strerror(errno));
+        close(fd_src);
+        return FALSE;
+    }
+    rc = ioctl(fd_dest, FICLONE, fd_src);
+    if (rc != 0) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    "failed to reflink %s to %s: %s",
+                    src, dest, g_strerror(errno));
+    }
+    close(fd_dest);
+    close(fd_src);
+    if (rc != 0) {
+        g_unlink(dest);
+        return FALSE;
+    }
+    return TRUE;
+#else
+    g_set_error(error,
+                DNF_ERROR,
+                DNF_ERROR_FILE_INVALID,
+                "reflinks are not supported for %s to %s",
+                src, dest);
+    return FALSE;
+#endif
+}
+
+/**
+ * dnf_package_store_link:
+ *
+ * Atomically replaces @dest by a hard link or a reflink of @src.
+ **/
+static gboolean
+dnf_package_store_link(const gchar *src, const gchar *dest, GError **error)
+{
+    g_autofree gchar *dirname = g_path_get_dirname(dest);
+    g_autofree gchar *basename = g_path_get_basename(dest);
+    g_autofree gchar *dest_tmp = NULL;
+
+    if (g_mkdir_with_parents(dirname, 0755) != 0) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    "failed to create %s: %s",
+                    dirname, g_strerror(errno));
+        return FALSE;
+    }
+
+    /* unique for both the processes and the threads */
+    dest_tmp = g_strdup_printf("%s/.%s.%i.%08x",
+                               dirname, basename,
+                               (gint) getpid(), g_random_int());
+    if (link(src, dest_tmp) != 0) {
+        if (errno != EXDEV && errno != EPERM && errno != EMLINK) {
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_FILE_INVALID,
+                        "failed to link %s to %s: %s",
+                        src, dest_tmp, g_strerror(errno));
+            return FALSE;
+        }
+        if (!dnf_package_store_reflink(src, dest_tmp, error))
+            return FALSE;
+    }
+    if (g_rename(dest_tmp, dest) != 0) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    "failed to rename %s to %s: %s",
+                    dest_tmp, dest, g_strerror(errno));
+        g_unlink(dest_tmp);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * dnf_package_store_checkout:
+ * @store_dir: the package store directory
+ * @pkg: a #DnfPackage
+ *
+ * Links the package from the store to its location in the repo cache
+ * and marks it as recently used. An object which doesn't match the
+ * checksum of the package is removed from the store. Any failure just
+ * means the package has to be downloaded.
+ *
+ * Returns: %TRUE if a valid copy of the package was found in the store
+ **/
+gboolean
+dnf_package_store_checkout(const gchar *store_dir, DnfPackage *pkg)
+{
+    const gchar *filename = dnf_package_get_filename(pkg);
+    gboolean valid = FALSE;
+    g_autofree gchar *path = NULL;
+    g_autoptr(GError) error_local = NULL;
+
+    if (filename == NULL)
+        return FALSE;
+    path = dnf_package_store_get_path(store_dir, pkg);
+    if (path == NULL || !g_file_test(path, G_FILE_TEST_IS_REGULAR))
+        return FALSE;
+    if (!dnf_package_store_link(path, filename, &error_local)) {
+        g_debug("failed to check out %s: %s", path, error_local->message);
+        return FALSE;
+    }
+    if (!dnf_package_check_filename(pkg, &valid, &error_local) || !valid) {
+        g_debug("removing %s which doesn't match its checksum", path);
+        g_unlink(filename);
+        g_unlink(path);
+        return FALSE;
+    }
+    g_utime(path, NULL);
+    return TRUE;
+}
+
+/**
+ * dnf_package_store_publish:
+ * @store_dir: the package store directory
+ * @pkg: a downloaded #DnfPackage
+ * @error: a #GError or %NULL.
+ *
+ * Adds the package file from the repo cache to the store.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+dnf_package_store_publish(const gchar *store_dir, DnfPackage *pkg, GError **error)
+{
+    const gchar *filename = dnf_package_get_filename(pkg);
+    g_autofree gchar *path = NULL;
+
+    if (filename == NULL)
+        return TRUE;
+    path = dnf_package_store_get_path(store_dir, pkg);
+    if (path == NULL)
+        return TRUE;
+
+    /* already published by somebody else */
+    if (g_file_test(path, G_FILE_TEST_IS_REGULAR)) {
+        g_utime(path, NULL);
+        return TRUE;
+    }
+    return dnf_package_store_link(filename, path, error);
+}
+
+/**
+ * dnf_package_store_scan:
+ *
+ * Collects the packages in the store and removes the stale temporary
+ * files, @depth is the number of directory levels above the packages.
+ **/
+static gboolean
+dnf_package_store_scan(const gchar *dirname,
+                       guint depth,
+                       gint64 now,
+                       GPtrArray *entries,
+                       guint64 *total,
+                       GError **error)
+{
+    const gchar *name;
+    g_autoptr(GDir) dir = NULL;
+
+    dir = g_dir_open(dirname, 0, error);
+    if (dir == NULL)
+        return FALSE;
+    while ((name = g_dir_read_name(dir)) != NULL) {
+        GStatBuf st;
+        DnfPackageStoreEntry *entry;
+        g_autofree gchar *path = g_build_filename(dirname, name, NULL);
+
+        if (g_lstat(path, &st) != 0)
+            continue;
+        if (depth > 0) {
+            if (S_ISDIR(st.st_mode) &&
+                !dnf_package_store_scan(path, depth - 1, now, entries, total, error))
+                return FALSE;
+            continue;
+        }
+        if (!S_ISREG(st.st_mode))
+            continue;
+        if (name[0] == '.') {
+            if (now - st.st_mtime > DNF_PACKAGE_STORE_TMP_AGE)
+                g_unlink(path);
+            continue;
+        }
+        entry = g_slice_new(DnfPackageStoreEntry);
+        entry->path = static_cast< gchar * >(g_steal_pointer(&path));
+        entry->size = st.st_size;
+        entry->mtime = st.st_mtime;
+        g_ptr_array_add(entries, entry);
+        *total += entry->size;
+    }
+    return TRUE;
+}
+
+static gint
+dnf_package_store_entry_cmp(gconstpointer a, gconstpointer b)
+{
+    auto entry_a = *static_cast< DnfPackageStoreEntry * const * >(a);
+    auto entry_b = *static_cast< DnfPackageStoreEntry * const * >(b);
+    if (entry_a->mtime < entry_b->mtime)
+        return -1;
+    if (entry_a->mtime > entry_b->mtime)
+        return 1;
+    return 0;
+}
+
+/**
+ * dnf_package_store_evict:
+ * @store_dir: the package store directory
+ * @max_size: the maximum size of the store in bytes
+ * @error: a #GError or %NULL.
+ *
+ * Removes the least recently used packages until the store fits into
+ * @max_size. Nothing is done if another process is evicting already.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+dnf_package_store_evict(const gchar *store_dir, guint64 max_size, GError **error)
+{
+    guint lock_id;
+    guint64 total = 0;
+    gboolean ret;
+    g_autoptr(DnfLock) lock = dnf_lock_new();
+    g_autoptr(GError) error_local = NULL;
+    g_autoptr(GPtrArray) entries = NULL;
+
+    if (!g_file_test(store_dir, G_FILE_TEST_IS_DIR))
+        return TRUE;
+
+    dnf_lock_set_lock_dir(lock, store_dir);
+    lock_id = dnf_lock_take(lock,
+                            DNF_LOCK_TYPE_PACKAGE_STORE,
+                            DNF_LOCK_MODE_PROCESS,
+                            &error_local);
+    if (lock_id == 0) {
+        if (g_error_matches(error_local, DNF_ERROR, DNF_ERROR_CANNOT_GET_LOCK)) {
+            g_debug("skipping the package store eviction: %s", error_local->message);
+            return TRUE;
+        }
+        g_propagate_error(error, static_cast< GError * >(g_steal_pointer(&error_local)));
+        return FALSE;
+    }
+
+    entries = g_ptr_array_new_with_free_func((GDestroyNotify) dnf_package_store_entry_free);
+    ret = dnf_package_store_scan(store_dir, 2, g_get_real_time() / G_USEC_PER_SEC,
+                                 entries, &total, error);
+    if (ret && total > max_size) {
+        g_ptr_array_sort(entries, dnf_package_store_entry_cmp);
+        for (guint i = 0; i < entries->len && total > max_size; i++) {
+            auto entry = static_cast< DnfPackageStoreEntry * >(g_ptr_array_index(entries, i));
+            if (g_unlink(entry->path) != 0) {
+                g_debug("failed to evict %s: %s", entry->path, g_strerror(errno));
+                continue;
+            }
+            total -= entry->size;
+        }
+    }
+
+    if (!dnf_lock_release(lock, lock_id, ret ? error : NULL))
+        return FALSE;
+    return ret;
+}
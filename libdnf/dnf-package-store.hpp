@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef __DNF_PACKAGE_STORE_HPP
+#define __DNF_PACKAGE_STORE_HPP
+
+#include <glib.h>
+
+#include "dnf-package.h"
+
+gboolean dnf_package_store_checkout(const gchar *store_dir, DnfPackage *pkg);
+gboolean dnf_package_store_publish(const gchar *store_dir, DnfPackage *pkg, GError **error);
+gboolean dnf_package_store_evict(const gchar *store_dir, guint64 max_size, GError **error);
+
+#endif /* __DNF_PACKAGE_STORE_HPP */
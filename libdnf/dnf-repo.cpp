@@ -1309,6 +1309,8 @@ dnf_repo_check_internal(DnfRepo *repo,
      */
     if (dnf_context_get_enable_filelists (priv->context))
         g_ptr_array_add (download_list, (char*)"filelists");
+    if (dnf_context_get_enable_deltarpm (priv->context))
+        g_ptr_array_add (download_list, (char*)"prestodelta");
     g_ptr_array_add (download_list, NULL);
     const gchar *tmp;
     gboolean ret;
@@ -1429,6 +1431,13 @@ dnf_repo_check_internal(DnfRepo *repo,
                             g_strdup("filelists"),
                             g_strdup(tmp));
     }
+    tmp = lr_yum_repo_path(yum_repo, "prestodelta");
+    if (tmp != NULL) {
+        hy_repo_set_string(priv->repo, HY_REPO_PRESTO_FN, tmp);
+        g_hash_table_insert(priv->filenames_md,
+                            g_strdup("prestodelta"),
+                            g_strdup(tmp));
+    }
     tmp = lr_yum_repo_path(yum_repo, "updateinfo");
     if (tmp != NULL) {
         hy_repo_set_string(priv->repo, HY_REPO_UPDATEINFO_FN, tmp);
@@ -2002,6 +2011,8 @@ typedef struct
     gchar *last_mirror_failure_message;
     guint64 downloaded;
     guint64 download_size;
+    DnfRepoPackageDownloadedFunc downloaded_func;
+    gpointer downloaded_data;
 } GlobalDownloadData;
 
 typedef struct
@@ -2010,8 +2021,93 @@ typedef struct
     DnfState *state;
     guint64 downloaded;
     GlobalDownloadData *global_download_data;
+    gchar *filename;
+    guint64 size;
 } PackageDownloadData;
 
+/* sidecar of a partial download, recording what the data belong to */
+#define DNF_REPO_RESUME_SUFFIX      ".resume"
+#define DNF_REPO_RESUME_GROUP       "resume"
+
+/**
+ * dnf_repo_prepare_resume:
+ *
+ * Prepares the download of @filename, which librepo resumes from the
+ * data left by an interrupted download. A partial file is only kept if
+ * its sidecar records the same @checksum and @size, partial data of
+ * another package are removed so the download starts over. A file
+ * without a sidecar wasn't left by us and is left to librepo to check.
+ * A file with other hard links, such as one checked out of the package
+ * store, is unlinked as librepo would write through to the other links.
+ * Then the sidecar is written for the case this download doesn't
+ * finish either.
+ **/
+static void
+dnf_repo_prepare_resume(const gchar *filename, const gchar *checksum, guint64 size)
+{
+    GStatBuf st;
+    g_autofree gchar *resume_fn = g_strconcat(filename, DNF_REPO_RESUME_SUFFIX, NULL);
+    g_autoptr(GKeyFile) keyfile = g_key_file_new();
+    g_autoptr(GError) error_local = NULL;
+
+    if (g_lstat(filename, &st) == 0 && st.st_nlink > 1) {
+        g_debug("unlinking %s shared with other links", filename);
+        g_unlink(filename);
+    }
+
+    if (g_stat(filename, &st) == 0 &&
+        g_key_file_load_from_file(keyfile, resume_fn, G_KEY_FILE_NONE, NULL)) {
+        g_autofree gchar *resume_checksum = NULL;
+        guint64 resume_size;
+
+        resume_checksum = g_key_file_get_string(keyfile, DNF_REPO_RESUME_GROUP, "checksum", NULL);
+        resume_size = g_key_file_get_uint64(keyfile, DNF_REPO_RESUME_GROUP, "size", NULL);
+        if (g_strcmp0(resume_checksum, checksum) != 0 ||
+            resume_size != size ||
+            static_cast<guint64>(st.st_size) > size) {
+            g_debug("removing partial download %s of another package", filename);
+            g_unlink(filename);
+        } else {
+            g_debug("resuming download of %s at %" G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT,
+                    filename, static_cast<guint64>(st.st_size), size);
+        }
+    }
+
+    g_key_file_set_string(keyfile, DNF_REPO_RESUME_GROUP, "checksum", checksum);
+    g_key_file_set_uint64(keyfile, DNF_REPO_RESUME_GROUP, "size", size);
+    if (!g_key_file_save_to_file(keyfile, resume_fn, &error_local))
+        g_debug("failed to write %s: %s", resume_fn, error_local->message);
+}
+
+/**
+ * dnf_repo_finish_resume:
+ *
+ * Removes the sidecar of a complete download. A failed download keeps
+ * its partial data for the next attempt, unless the data are complete
+ * and so it was the verification which failed.
+ **/
+static void
+dnf_repo_finish_resume(const gchar *filename, guint64 size, gboolean complete)
+{
+    GStatBuf st;
+    g_autofree gchar *resume_fn = g_strconcat(filename, DNF_REPO_RESUME_SUFFIX, NULL);
+
+    if (!complete && g_stat(filename, &st) == 0 && static_cast<guint64>(st.st_size) >= size) {
+        g_debug("removing %s which failed verification", filename);
+        g_unlink(filename);
+        complete = TRUE;
+    }
+    if (complete)
+        g_unlink(resume_fn);
+}
+
+static void
+package_download_data_free(PackageDownloadData *data)
+{
+    g_free(data->filename);
+    g_slice_free(PackageDownloadData, data);
+}
+
 static int
 package_download_update_state_cb(void *user_data,
                                  gdouble total_to_download,
@@ -2058,8 +2154,16 @@ package_download_end_cb(void *user_data,
                         const char *msg)
 {
     auto data = static_cast<PackageDownloadData *>(user_data);
+    GlobalDownloadData *global_data = data->global_download_data;
+    gboolean complete = status == LR_TRANSFER_SUCCESSFUL || status == LR_TRANSFER_ALREADYEXISTS;
 
-    g_slice_free(PackageDownloadData, data);
+    dnf_repo_finish_resume(data->filename, data->size, complete);
+
+    /* the file is complete */
+    if (global_data->downloaded_func != NULL && complete)
+        global_data->downloaded_func(data->pkg, global_data->downloaded_data);
+
+    package_download_data_free(data);
 
     return LR_CB_OK;
 }
@@ -2130,38 +2234,30 @@ dnf_repo_download_package(DnfRepo *repo,
 }
 
 /**
- * dnf_repo_download_packages:
- * @repo: a #DnfRepo instance.
- * @packages: (element-type DnfPackage): an array of packages, must be from this repo
- * @directory: the destination directory.
- * @state: a #DnfState.
- * @error: a #GError or %NULL.
- *
- * Downloads multiple packages from a repo. The target filename will be
- * equivalent to `g_path_get_basename (dnf_package_get_location (pkg))`.
- *
- * Returns: %TRUE for success, %FALSE otherwise
+ * dnf_repo_add_package_targets:
  *
- * Since: 0.2.3
+ * Creates librepo download targets for packages of a single repo and
+ * prepends them to @package_targets. The progress of the targets is
+ * reported to @state through @global_data shared by all the targets.
+ * Packages found in @deltas are downloaded as their delta instead.
  **/
-gboolean
-dnf_repo_download_packages(DnfRepo *repo,
-                           GPtrArray *packages,
-                           const gchar *directory,
-                           DnfState *state,
-                           GError **error)
+static gboolean
+dnf_repo_add_package_targets(DnfRepo *repo,
+                             GPtrArray *packages,
+                             GHashTable *deltas,
+                             const gchar *directory,
+                             DnfState *state,
+                             GlobalDownloadData *global_data,
+                             GSList **package_targets,
+                             GError **error)
 {
     DnfRepoPrivate *priv = GET_PRIVATE(repo);
-    gboolean ret = FALSE;
     guint i;
-    GSList *package_targets = NULL;
-    GlobalDownloadData global_data = { 0, };
-    g_autoptr(GError) error_local = NULL;
     g_autofree gchar *directory_slash = NULL;
 
     /* ensure we reset the values from the keyfile */
     if (!dnf_repo_set_keyfile_data(repo, error))
-        goto out;
+        return FALSE;
 
     /* we should never be asked to download from a local repo.  if
        this happens, it's a bug somewhere else. */
@@ -2171,7 +2267,7 @@ dnf_repo_download_packages(DnfRepo *repo,
                     DNF_ERROR_INTERNAL_ERROR,
                     "Refusing to download from local repository \"%s\"",
                     priv->id);
-        goto out;
+        return FALSE;
     }
 
     /* if nothing specified then use cachedir */
@@ -2184,7 +2280,7 @@ dnf_repo_download_packages(DnfRepo *repo,
                             DNF_ERROR_INTERNAL_ERROR,
                             "Failed to create %s",
                             directory_slash);
-                goto out;
+                return FALSE;
             }
         }
     } else {
@@ -2194,68 +2290,285 @@ dnf_repo_download_packages(DnfRepo *repo,
         directory_slash = g_build_filename(directory, "/", NULL);
     }
 
-    global_data.download_size = dnf_package_array_get_download_size(packages);
     for (i = 0; i < packages->len; i++) {
         auto pkg = static_cast<DnfPackage *>(packages->pdata[i]);
         PackageDownloadData *data;
         LrPackageTarget *target;
+        DnfPackageDelta *delta = NULL;
         const unsigned char *checksum;
+        const gchar *location;
+        const gchar *baseurl;
+        guint64 size;
         int checksum_type;
         g_autofree char *checksum_str = NULL;
+        g_autofree gchar *basename = NULL;
+        g_autofree gchar *resume_checksum = NULL;
+
+        if (deltas != NULL)
+            delta = static_cast<DnfPackageDelta *>(g_hash_table_lookup(deltas, pkg));
+        if (delta != NULL) {
+            location = dnf_packagedelta_get_location(delta);
+            baseurl = dnf_packagedelta_get_baseurl(delta);
+            size = dnf_packagedelta_get_downloadsize(delta);
+            checksum = dnf_packagedelta_get_chksum(delta, &checksum_type);
+        } else {
+            location = dnf_package_get_location(pkg);
+            baseurl = dnf_package_get_baseurl(pkg);
+            size = dnf_package_get_downloadsize(pkg);
+            checksum = dnf_package_get_chksum(pkg, &checksum_type);
+        }
 
         g_debug("downloading %s to %s",
-                dnf_package_get_location(pkg),
+                location,
                 directory_slash);
 
+        checksum_str = hy_chksum_str(checksum, checksum_type);
+        basename = g_path_get_basename(location);
+        resume_checksum = g_strdup_printf("%s:%s", hy_chksum_name(checksum_type), checksum_str);
+
         data = g_slice_new0(PackageDownloadData);
         data->pkg = pkg;
         data->state = state;
-        data->global_download_data = &global_data;
+        data->global_download_data = global_data;
+        data->filename = g_build_filename(directory_slash, basename, NULL);
+        data->size = size;
 
-        checksum = dnf_package_get_chksum(pkg, &checksum_type);
-        checksum_str = hy_chksum_str(checksum, checksum_type);
+        /* librepo resumes partial files, make sure they are ours */
+        dnf_repo_prepare_resume(data->filename, resume_checksum, size);
 
         target = lr_packagetarget_new_v2(priv->repo_handle,
-                                         dnf_package_get_location(pkg),
+                                         location,
                                          directory_slash,
                                          dnf_repo_checksum_hy_to_lr(checksum_type),
                                          checksum_str,
-                                         dnf_package_get_downloadsize(pkg),
-                                         dnf_package_get_baseurl(pkg),
+                                         size,
+                                         baseurl,
                                          TRUE,
                                          package_download_update_state_cb,
                                          data,
                                          package_download_end_cb,
                                          mirrorlist_failure_cb,
                                          error);
-        if (target == NULL)
-            goto out;
+        if (target == NULL) {
+            package_download_data_free(data);
+            return FALSE;
+        }
 
-        package_targets = g_slist_prepend(package_targets, target);
+        *package_targets = g_slist_prepend(*package_targets, target);
     }
+    return TRUE;
+}
 
-    ret = lr_download_packages(package_targets, LR_PACKAGEDOWNLOAD_FAILFAST, &error_local);
-    if (!ret) {
-        if (g_error_matches(error_local,
-                            LR_PACKAGE_DOWNLOADER_ERROR,
-                            LRE_ALREADYDOWNLOADED)) {
-            /* ignore */
-            g_clear_error(&error_local);
-        } else {
-            if (global_data.last_mirror_failure_message) {
-                g_autofree gchar *orig_message = error_local->message;
-                error_local->message = g_strconcat(orig_message, "; Last error: ", global_data.last_mirror_failure_message, NULL);
-            }
-            g_propagate_error(error, error_local);
-            error_local = NULL;
-            goto out;
+/**
+ * dnf_repo_download_package_targets:
+ *
+ * Downloads all the targets in one go. librepo transfers them in parallel
+ * limited by the handle options (max parallel downloads and max downloads
+ * per mirror). Unless @failfast is set, failed targets don't fail the
+ * download, the caller finds out which were complete from the end
+ * callbacks.
+ **/
+static gboolean
+dnf_repo_download_package_targets(GSList *package_targets,
+                                  GlobalDownloadData *global_data,
+                                  gboolean failfast,
+                                  GError **error)
+{
+    g_autoptr(GError) error_local = NULL;
+
+    if (!failfast) {
+        if (!lr_download_packages(package_targets,
+                                  static_cast<LrPackageDownloadFlag>(0),
+                                  &error_local))
+            g_debug("some targets were not downloaded: %s", error_local->message);
+        return TRUE;
+    }
+
+    if (lr_download_packages(package_targets, LR_PACKAGEDOWNLOAD_FAILFAST, &error_local))
+        return TRUE;
+
+    if (g_error_matches(error_local,
+                        LR_PACKAGE_DOWNLOADER_ERROR,
+                        LRE_ALREADYDOWNLOADED)) {
+        /* ignore */
+        return TRUE;
+    }
+
+    if (global_data->last_mirror_failure_message) {
+        g_autofree gchar *orig_message = error_local->message;
+        error_local->message = g_strconcat(orig_message, "; Last error: ", global_data->last_mirror_failure_message, NULL);
+    }
+    g_propagate_error(error, error_local);
+    error_local = NULL;
+    return FALSE;
+}
+
+static void
+dnf_repo_reset_progress_cb(DnfRepo *repo)
+{
+    DnfRepoPrivate *priv = GET_PRIVATE(repo);
+    lr_handle_setopt(priv->repo_handle, NULL, LRO_PROGRESSCB, NULL);
+    lr_handle_setopt(priv->repo_handle, NULL, LRO_PROGRESSDATA, 0xdeadbeef);
+}
+
+/**
+ * dnf_repo_download_packages:
+ * @repo: a #DnfRepo instance.
+ * @packages: (element-type DnfPackage): an array of packages, must be from this repo
+ * @directory: the destination directory.
+ * @state: a #DnfState.
+ * @error: a #GError or %NULL.
+ *
+ * Downloads multiple packages from a repo. The target filename will be
+ * equivalent to `g_path_get_basename (dnf_package_get_location (pkg))`.
+ *
+ * Returns: %TRUE for success, %FALSE otherwise
+ *
+ * Since: 0.2.3
+ **/
+gboolean
+dnf_repo_download_packages(DnfRepo *repo,
+                           GPtrArray *packages,
+                           const gchar *directory,
+                           DnfState *state,
+                           GError **error)
+{
+    gboolean ret = FALSE;
+    GSList *package_targets = NULL;
+    GlobalDownloadData global_data = { 0, };
+
+    global_data.download_size = dnf_package_array_get_download_size(packages);
+    if (!dnf_repo_add_package_targets(repo, packages, NULL, directory, state,
+                                      &global_data, &package_targets, error))
+        goto out;
+
+    if (!dnf_repo_download_package_targets(package_targets, &global_data, TRUE, error))
+        goto out;
+
+    ret = TRUE;
+out:
+    dnf_repo_reset_progress_cb(repo);
+    g_free(global_data.last_mirror_failure_message);
+    g_free(global_data.last_mirror_url);
+    g_slist_free_full(package_targets, (GDestroyNotify)lr_packagetarget_free);
+    return ret;
+}
+
+/**
+ * dnf_repo_download_packages_multi:
+ * @packages: (element-type DnfPackage): an array of packages from any repos
+ * @directory: the destination directory, or %NULL for the cachedir of each repo.
+ * @state: a #DnfState.
+ * @error: a #GError or %NULL.
+ *
+ * Downloads packages from multiple repos at once. Unlike calling
+ * dnf_repo_download_packages() for each repo in turn, transfers from
+ * all the repos run in a single librepo download, so they are in flight
+ * at the same time. The number of parallel transfers is limited by the
+ * max parallel downloads option and transfers to a single mirror by the
+ * max downloads per mirror option of the handle of the first package repo.
+ * The progress reported to @state is the share of downloaded bytes of
+ * all the packages.
+ *
+ * Returns: %TRUE for success, %FALSE otherwise
+ *
+ * Since: 0.19.1
+ **/
+gboolean
+dnf_repo_download_packages_multi(GPtrArray *packages,
+                                 const gchar *directory,
+                                 DnfState *state,
+                                 GError **error)
+{
+    return dnf_repo_download_packages_full(packages, directory, NULL, NULL, NULL, state, error);
+}
+
+/**
+ * dnf_repo_download_packages_full:
+ * @packages: (element-type DnfPackage): an array of packages from any repos
+ * @directory: the destination directory, or %NULL for the cachedir of each repo.
+ * @deltas: (nullable): map of the packages to download as a #DnfPackageDelta
+ * @downloaded_func: function called for each complete package file, or %NULL
+ * @downloaded_data: user data for @downloaded_func
+ * @state: a #DnfState.
+ * @error: a #GError or %NULL.
+ *
+ * Same as dnf_repo_download_packages_multi(), but lets the caller process
+ * each package as soon as its file is complete, while the others are
+ * still being downloaded.
+ *
+ * With @deltas, the packages are downloaded as their deltas, all the
+ * packages must be in @deltas. A failed delta doesn't fail the download,
+ * @downloaded_func is only called for the complete ones.
+ *
+ * Returns: %TRUE for success, %FALSE otherwise
+ **/
+gboolean
+dnf_repo_download_packages_full(GPtrArray *packages,
+                                const gchar *directory,
+                                GHashTable *deltas,
+                                DnfRepoPackageDownloadedFunc downloaded_func,
+                                gpointer downloaded_data,
+                                DnfState *state,
+                                GError **error)
+{
+    gboolean ret = FALSE;
+    guint i;
+    GSList *package_targets = NULL;
+    GlobalDownloadData global_data = { 0, };
+    g_autoptr(GPtrArray) repos = g_ptr_array_new();
+    g_autoptr(GHashTable) repo_to_packages = NULL;
+
+    /* map packages to repos, keeping the order of repos */
+    repo_to_packages = g_hash_table_new_full(NULL, NULL, NULL, (GDestroyNotify)g_ptr_array_unref);
+    for (i = 0; i < packages->len; i++) {
+        auto pkg = static_cast<DnfPackage *>(g_ptr_array_index(packages, i));
+        DnfRepo *repo;
+        GPtrArray *repo_packages;
+
+        repo = dnf_package_get_repo(pkg);
+        if (repo == NULL) {
+            g_set_error_literal(error,
+                                DNF_ERROR,
+                                DNF_ERROR_INTERNAL_ERROR,
+                                "package repo is unset");
+            return FALSE;
+        }
+        repo_packages = static_cast<GPtrArray *>(g_hash_table_lookup(repo_to_packages, repo));
+        if (repo_packages == NULL) {
+            repo_packages = g_ptr_array_new();
+            g_hash_table_insert(repo_to_packages, repo, repo_packages);
+            g_ptr_array_add(repos, repo);
         }
+        g_ptr_array_add(repo_packages, pkg);
     }
 
+    if (deltas != NULL) {
+        for (i = 0; i < packages->len; i++) {
+            auto delta = static_cast<DnfPackageDelta *>(
+                g_hash_table_lookup(deltas, g_ptr_array_index(packages, i)));
+            global_data.download_size += dnf_packagedelta_get_downloadsize(delta);
+        }
+    } else {
+        global_data.download_size = dnf_package_array_get_download_size(packages);
+    }
+    global_data.downloaded_func = downloaded_func;
+    global_data.downloaded_data = downloaded_data;
+    for (i = 0; i < repos->len; i++) {
+        auto repo = static_cast<DnfRepo *>(g_ptr_array_index(repos, i));
+        auto repo_packages = static_cast<GPtrArray *>(g_hash_table_lookup(repo_to_packages, repo));
+        if (!dnf_repo_add_package_targets(repo, repo_packages, deltas, directory, state,
+                                          &global_data, &package_targets, error))
+            goto out;
+    }
+
+    if (!dnf_repo_download_package_targets(package_targets, &global_data, deltas == NULL, error))
+        goto out;
+
     ret = TRUE;
 out:
-    lr_handle_setopt(priv->repo_handle, NULL, LRO_PROGRESSCB, NULL);
-    lr_handle_setopt(priv->repo_handle, NULL, LRO_PROGRESSDATA, 0xdeadbeef);
+    for (i = 0; i < repos->len; i++)
+        dnf_repo_reset_progress_cb(static_cast<DnfRepo *>(g_ptr_array_index(repos, i)));
     g_free(global_data.last_mirror_failure_message);
     g_free(global_data.last_mirror_url);
     g_slist_free_full(package_targets, (GDestroyNotify)lr_packagetarget_free);
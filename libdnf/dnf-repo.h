@@ -199,6 +199,10 @@ gboolean         dnf_repo_download_packages     (DnfRepo              *repo,
                                                  const gchar          *directory,
                                                  DnfState             *state,
                                                  GError              **error);
+gboolean         dnf_repo_download_packages_multi (GPtrArray          *pkgs,
+                                                 const gchar          *directory,
+                                                 DnfState             *state,
+                                                 GError              **error);
 
 HyRepo dnf_repo_get_hy_repo(DnfRepo *repo);
 #endif
@@ -33,5 +33,16 @@ inline DnfRepoEnabled & operator|=(DnfRepoEnabled & a, DnfRepoEnabled b)
     return a = a | b;
 }
 
+/* called from the downloading thread once a package file is complete */
+typedef void (*DnfRepoPackageDownloadedFunc) (DnfPackage *pkg, gpointer user_data);
+
+gboolean dnf_repo_download_packages_full(GPtrArray *packages,
+                                         const gchar *directory,
+                                         GHashTable *deltas,
+                                         DnfRepoPackageDownloadedFunc downloaded_func,
+                                         gpointer downloaded_data,
+                                         DnfState *state,
+                                         GError **error);
+
 
 #endif /* __DNF_REPO_HPP */
@@ -63,15 +63,51 @@ dnf_rpmts_add_install_filename(rpmts ts,
                                gboolean is_update,
                                GError **error)
 {
-    gboolean ret = TRUE;
-    gint res;
-    Header hdr;
+    gboolean ret;
+    rpmRC res;
+    Header hdr = NULL;
     FD_t fd;
 
     /* open this */
     fd = Fopen(filename, "r.ufdio");
     res = rpmReadPackageFile(ts, fd, filename, &hdr);
 
+    ret = dnf_rpmts_add_install_header(ts, hdr, res, filename, allow_untrusted, is_update, error);
+
+    Fclose(fd);
+    headerFree(hdr);
+    return ret;
+}
+
+/**
+ * dnf_rpmts_add_install_header:
+ * @ts: a #rpmts instance.
+ * @hdr: the package header, read by rpmReadPackageFile().
+ * @res: the result of rpmReadPackageFile().
+ * @filename: the package.
+ * @allow_untrusted: is we can add untrusted packages.
+ * @is_update: if the package is an update.
+ * @error: a #GError or %NULL..
+ *
+ * Add to the transaction a package to be installed, whose header was
+ * already read, e.g. while the other packages were being downloaded.
+ * The header has to be read with the keyring and verify flags of @ts.
+ *
+ * Returns: %TRUE for success, %FALSE otherwise
+ *
+ * Since: 0.19.1
+ **/
+gboolean
+dnf_rpmts_add_install_header(rpmts ts,
+                             Header hdr,
+                             rpmRC res,
+                             const gchar *filename,
+                             gboolean allow_untrusted,
+                             gboolean is_update,
+                             GError **error)
+{
+    gint rc;
+
     /* be less strict when we're allowing untrusted transactions */
     if (allow_untrusted) {
         switch(res) {
@@ -81,84 +117,73 @@ dnf_rpmts_add_install_filename(rpmts ts,
         case RPMRC_OK:
             break;
         case RPMRC_FAIL:
-            ret = FALSE;
             g_set_error(error,
                         DNF_ERROR,
                         DNF_ERROR_INTERNAL_ERROR,
                         _("signature does not verify for %s"),
                         filename);
-            goto out;
+            return FALSE;
         default:
-            ret = FALSE;
             g_set_error(error,
                         DNF_ERROR,
                         DNF_ERROR_INTERNAL_ERROR,
                         _("failed to open(generic error): %s"),
                         filename);
-            goto out;
+            return FALSE;
         }
     } else {
         switch(res) {
         case RPMRC_OK:
             break;
         case RPMRC_NOTTRUSTED:
-            ret = FALSE;
             g_set_error(error,
                         DNF_ERROR,
                         DNF_ERROR_INTERNAL_ERROR,
                         _("failed to verify key for %s"),
                         filename);
-            goto out;
+            return FALSE;
         case RPMRC_NOKEY:
-            ret = FALSE;
             g_set_error(error,
                         DNF_ERROR,
                         DNF_ERROR_INTERNAL_ERROR,
                         _("public key unavailable for %s"),
                         filename);
-            goto out;
+            return FALSE;
         case RPMRC_NOTFOUND:
-            ret = FALSE;
             g_set_error(error,
                         DNF_ERROR,
                         DNF_ERROR_INTERNAL_ERROR,
                         _("signature not found for %s"),
                         filename);
-            goto out;
+            return FALSE;
         case RPMRC_FAIL:
-            ret = FALSE;
             g_set_error(error,
                         DNF_ERROR,
                         DNF_ERROR_INTERNAL_ERROR,
                         _("signature does not verify for %s"),
                         filename);
-            goto out;
+            return FALSE;
         default:
-            ret = FALSE;
             g_set_error(error,
                         DNF_ERROR,
                         DNF_ERROR_INTERNAL_ERROR,
                         _("failed to open(generic error): %s"),
                         filename);
-            goto out;
+            return FALSE;
         }
     }
 
     /* add to the transaction */
-    res = rpmtsAddInstallElement(ts, hdr, (fnpyKey) filename, is_update, NULL);
-    if (res != 0) {
-        ret = FALSE;
+    rc = rpmtsAddInstallElement(ts, hdr, (fnpyKey) filename, is_update, NULL);
+    if (rc != 0) {
         g_set_error(error,
                     DNF_ERROR,
                     DNF_ERROR_INTERNAL_ERROR,
                     _("failed to add install element: %1$s [%2$i]"),
-                    filename, res);
-        goto out;
+                    filename, rc);
+        return FALSE;
     }
-out:
-    Fclose(fd);
-    headerFree(hdr);
-    return ret;
+    return TRUE;
 }
 
 /**
@@ -33,6 +33,13 @@ gboolean         dnf_rpmts_add_install_filename (rpmts           ts,
                                                  gboolean        allow_untrusted,
                                                  gboolean        is_update,
                                                  GError         **error);
+gboolean         dnf_rpmts_add_install_header   (rpmts           ts,
+                                                 Header          hdr,
+                                                 rpmRC           res,
+                                                 const gchar    *filename,
+                                                 gboolean        allow_untrusted,
+                                                 gboolean        is_update,
+                                                 GError         **error);
 gboolean         dnf_rpmts_add_remove_pkg       (rpmts           ts,
                                                  DnfPackage *      pkg,
                                                  GError         **error);
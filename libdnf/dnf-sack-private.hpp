@@ -58,6 +58,26 @@ int dnf_sack_get_pool_nsolvables(DnfSack *sack);
  */
 libdnf::PackageSet *dnf_sack_get_pkg_solvables(DnfSack *sack);
 
+/**
+ * @brief Checksum of the state of the rpmdb in the install root
+ *
+ * @param sack p_sack:...
+ * @param csout the checksum, CHKSUM_BYTES long
+ * @return int 0 on success, 1 if the rpmdb wasn't found
+ */
+int dnf_sack_get_rpmdb_checksum(DnfSack *sack, unsigned char *csout);
+
+/**
+ * @brief NEVRA of the package, formatted once and valid as long as the sack
+ *
+ * Equal NEVRAs are the same string, they can be compared by pointer.
+ *
+ * @param sack p_sack:...
+ * @param id Id of the package solvable
+ * @return const char*
+ */
+const char *dnf_sack_get_nevra(DnfSack *sack, Id id);
+
 ModulePackageContainer * dnf_sack_get_module_container(DnfSack *sack);
 void         dnf_sack_make_provides_ready   (DnfSack    *sack);
 Id           dnf_sack_running_kernel        (DnfSack    *sack);
@@ -76,6 +76,7 @@ extern "C" {
 #include "module/modulemd/ModuleMetadata.hpp"
 #include "repo/solvable/DependencyContainer.hpp"
 #include "utils/File.hpp"
+#include "utils/metrics.hpp"
 #include "utils/utils.hpp"
 #include "log.hpp"
 
@@ -106,6 +107,9 @@ typedef struct
     dnf_sack_running_kernel_fn_t  running_kernel_fn;
     guint                installonly_limit;
     ModulePackageContainer * moduleContainer;
+    GStringChunk        *nevra_strings;     /* NEVRAs of the packages, never freed before the sack */
+    GHashTable          *nevra_set;         /* NEVRA → the same string in nevra_strings */
+    GPtrArray           *nevras;            /* Id → NEVRA, filled on first use */
 } DnfSackPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE(DnfSack, dnf_sack, G_TYPE_OBJECT)
@@ -146,6 +150,9 @@ dnf_sack_finalize(GObject *object)
     if (priv->moduleContainer) {
         delete priv->moduleContainer;
     }
+    g_ptr_array_unref(priv->nevras);
+    g_hash_table_unref(priv->nevra_set);
+    g_string_chunk_free(priv->nevra_strings);
 
     G_OBJECT_CLASS(dnf_sack_parent_class)->finalize(object);
 }
@@ -184,6 +191,9 @@ dnf_sack_init(DnfSack *sack)
     priv->considered_uptodate = TRUE;
     priv->cmdline_repo = NULL;
     queue_init(&priv->installonly);
+    priv->nevra_strings = g_string_chunk_new(4096);
+    priv->nevra_set = g_hash_table_new(g_str_hash, g_str_equal);
+    priv->nevras = g_ptr_array_new();
 
     /* logging up after this*/
     pool_setdebugcallback(priv->pool, log_cb, sack);
@@ -294,6 +304,51 @@ dnf_sack_get_pool_nsolvables(DnfSack *sack)
     return priv->pool_nsolvables;
 }
 
+/**
+ * dnf_sack_get_nevra: (skip)
+ * @sack: a #DnfSack instance.
+ * @id: a solvable Id
+ *
+ * Gets the NEVRA of a package. It is formatted on the first call only and
+ * the string stays valid as long as the sack. Equal NEVRAs are the same
+ * string, so they can be compared by pointer.
+ *
+ * Returns: the NEVRA
+ */
+const char *
+dnf_sack_get_nevra(DnfSack *sack, Id id)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+
+    if ((guint)id >= priv->nevras->len)
+        g_ptr_array_set_size(priv->nevras, MAX(priv->pool->nsolvables, id + 1));
+    auto nevra = static_cast<const char *>(g_ptr_array_index(priv->nevras, id));
+    if (nevra == NULL) {
+        const char *str = pool_solvable2str(priv->pool, pool_id2solvable(priv->pool, id));
+        nevra = static_cast<const char *>(g_hash_table_lookup(priv->nevra_set, str));
+        if (nevra == NULL) {
+            nevra = g_string_chunk_insert(priv->nevra_strings, str);
+            g_hash_table_add(priv->nevra_set, (gpointer)nevra);
+        }
+        g_ptr_array_index(priv->nevras, id) = (gpointer)nevra;
+    }
+    return nevra;
+}
+
+/* the Ids of freed solvables can be reused, the strings stay valid */
+static void
+dnf_sack_forget_nevras(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    g_ptr_array_set_size(priv->nevras, 0);
+}
+
+int
+dnf_sack_get_rpmdb_checksum(DnfSack *sack, unsigned char csout[CHKSUM_BYTES])
+{
+    return current_rpmdb_checksum(dnf_sack_get_pool(sack), csout);
+}
+
 libdnf::PackageSet *
 dnf_sack_get_pkg_solvables(DnfSack *sack)
 {
@@ -386,6 +441,7 @@ load_ext(DnfSack *sack, HyRepo hrepo, _hy_repo_repodata which_repodata,
     const char *fn = hy_repo_get_string(hrepo, which_filename);
     FILE *fp;
     gboolean done = FALSE;
+    libdnf::Metrics::ScopedTimer timer(libdnf::Metrics::Timer::SACK_LOAD_REPO);
 
     /* nothing set */
     if (fn == NULL) {
@@ -410,7 +466,11 @@ load_ext(DnfSack *sack, HyRepo hrepo, _hy_repo_repodata which_repodata,
             flags |= REPO_LOCALPOOL;
         done = TRUE;
         g_debug("%s: using cache file: %s", __func__, fn_cache);
-        ret = repo_add_solv(repo, fp, flags);
+        libdnf::Metrics::add(libdnf::Metrics::Counter::SOLV_CACHE_HIT);
+        {
+            libdnf::Metrics::ScopedTimer cacheTimer(libdnf::Metrics::Timer::SACK_LOAD_SOLV_CACHE);
+            ret = repo_add_solv(repo, fp, flags);
+        }
         if (ret) {
             g_set_error_literal (error,
                                  DNF_ERROR,
@@ -428,6 +488,7 @@ load_ext(DnfSack *sack, HyRepo hrepo, _hy_repo_repodata which_repodata,
     if (done)
         return TRUE;
 
+    libdnf::Metrics::add(libdnf::Metrics::Counter::SOLV_CACHE_MISS);
     fp = solv_xfopen(fn, "r");
     if (fp == NULL) {
         g_set_error (error,
@@ -542,6 +603,7 @@ write_main(DnfSack *sack, HyRepo hrepo, int switchtosolv, GError **error)
         FILE *fp = fopen(tmp_fn_templ, "r");
         if (fp) {
             repo_empty(repo, 1);
+            dnf_sack_forget_nevras(sack);
             rc = repo_add_solv(repo, fp, 0);
             fclose(fp);
             if (rc) {
@@ -680,6 +742,7 @@ load_yum_repo(DnfSack *sack, HyRepo hrepo, GError **error)
 
     FILE *fp_primary = NULL;
     FILE *fp_repomd = NULL;
+    libdnf::Metrics::ScopedTimer timer(libdnf::Metrics::Timer::SACK_LOAD_REPO);
     FILE *fp_cache = fopen(fn_cache, "r");
     if (!fn_repomd) {
         g_set_error (error,
@@ -704,6 +767,8 @@ load_yum_repo(DnfSack *sack, HyRepo hrepo, GError **error)
     if (can_use_repomd_cache(fp_cache, hrepo->checksum)) {
         const char *chksum = pool_checksum_str(pool, hrepo->checksum);
         g_debug("using cached %s (0x%s)", name, chksum);
+        libdnf::Metrics::add(libdnf::Metrics::Counter::SOLV_CACHE_HIT);
+        libdnf::Metrics::ScopedTimer cacheTimer(libdnf::Metrics::Timer::SACK_LOAD_SOLV_CACHE);
         if (repo_add_solv(repo, fp_cache, 0)) {
             g_set_error (error,
                          DNF_ERROR,
@@ -714,6 +779,7 @@ load_yum_repo(DnfSack *sack, HyRepo hrepo, GError **error)
         }
         hrepo->state_main = _HY_LOADED_CACHE;
     } else {
+        libdnf::Metrics::add(libdnf::Metrics::Counter::SOLV_CACHE_MISS);
         fp_primary = solv_xfopen(hy_repo_get_string(hrepo, HY_REPO_PRIMARY_FN),
                                  "r");
         assert(fp_primary);
@@ -742,8 +808,10 @@ out:
     if (retval) {
         repo_finalize_init(hrepo, repo);
         priv->provides_ready = 0;
-    } else
+    } else {
         repo_free(repo, 1);
+        dnf_sack_forget_nevras(sack);
+    }
     return retval;
 }
 
@@ -1671,6 +1739,7 @@ dnf_sack_load_system_repo(DnfSack *sack, HyRepo a_hrepo, int flags, GError **err
     HyRepo hrepo = a_hrepo;
     Repo *repo;
     const int build_cache = flags & DNF_SACK_LOAD_FLAG_BUILD_CACHE;
+    libdnf::Metrics::ScopedTimer timer(libdnf::Metrics::Timer::SACK_LOAD_REPO);
 
     g_free(cache_fn);
     if (hrepo)
@@ -1693,11 +1762,14 @@ dnf_sack_load_system_repo(DnfSack *sack, HyRepo a_hrepo, int flags, GError **err
     if (can_use_rpmdb_cache(cache_fp, hrepo->checksum)) {
         const char *chksum = pool_checksum_str(pool, hrepo->checksum);
         g_debug("using cached rpmdb (0x%s)", chksum);
+        libdnf::Metrics::add(libdnf::Metrics::Counter::SOLV_CACHE_HIT);
+        libdnf::Metrics::ScopedTimer cacheTimer(libdnf::Metrics::Timer::SACK_LOAD_SOLV_CACHE);
         rc = repo_add_solv(repo, cache_fp, 0);
         if (!rc)
             hrepo->state_main = _HY_LOADED_CACHE;
     } else {
         g_debug("fetching rpmdb");
+        libdnf::Metrics::add(libdnf::Metrics::Counter::SOLV_CACHE_MISS);
         int flagsrpm = REPO_REUSE_REPODATA | RPM_ADD_WITH_HDRID | REPO_USE_ROOTDIR;
         rc = repo_add_rpmdb_reffp(repo, cache_fp, flagsrpm);
         if (!rc)
@@ -1705,6 +1777,7 @@ dnf_sack_load_system_repo(DnfSack *sack, HyRepo a_hrepo, int flags, GError **err
     }
     if (rc) {
         repo_free(repo, 1);
+        dnf_sack_forget_nevras(sack);
         ret = FALSE;
         g_set_error (error,
                      DNF_ERROR,
@@ -1948,6 +2021,7 @@ dnf_sack_make_provides_ready(DnfSack *sack)
 
     if (priv->provides_ready)
         return;
+    libdnf::Metrics::ScopedTimer timer(libdnf::Metrics::Timer::SACK_MAKE_PROVIDES_READY);
     repo_internalize_all_trigger(priv->pool);
     Queue addedfileprovides;
     Queue addedfileprovides_inst;
@@ -2121,6 +2195,8 @@ dnf_sack_add_repo(DnfSack *sack,
         flags_hy |= DNF_SACK_LOAD_FLAG_USE_OTHER;
     if ((flags & DNF_SACK_ADD_FLAG_UPDATEINFO) > 0)
         flags_hy |= DNF_SACK_LOAD_FLAG_USE_UPDATEINFO;
+    if ((flags & DNF_SACK_ADD_FLAG_PRESTO) > 0)
+        flags_hy |= DNF_SACK_LOAD_FLAG_USE_PRESTO;
 
     /* load solv */
     g_debug("Loading repo %s", dnf_repo_get_id(repo));
@@ -180,6 +180,7 @@ void dnf_sack_filter_modules(DnfSack *sack, GPtrArray *repos, const char *instal
  * @DNF_SACK_ADD_FLAG_REMOTE:                   Use remote repos
  * @DNF_SACK_ADD_FLAG_UNAVAILABLE:              Add repos that are unavailable
  * @DNF_SACK_ADD_FLAG_OTHER:                    Add the other
+ * @DNF_SACK_ADD_FLAG_PRESTO:                   Add the presto deltas
  *
  * Flags to control repo loading into the sack.
  **/
@@ -190,6 +191,7 @@ typedef enum {
         DNF_SACK_ADD_FLAG_REMOTE                = 1 << 2,
         DNF_SACK_ADD_FLAG_UNAVAILABLE           = 1 << 3,
         DNF_SACK_ADD_FLAG_OTHER                 = 1 << 4,
+        DNF_SACK_ADD_FLAG_PRESTO                = 1 << 5,
         /*< private >*/
         DNF_SACK_ADD_FLAG_LAST
 } DnfSackAddFlags;
@@ -81,11 +81,32 @@
  */
 
 
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
 #include "dnf-state.h"
 #include "dnf-utils.h"
 
 #include "utils/bgettext/bgettext-lib.h"
 
+/* shared by a state and all its children */
+typedef struct
+{
+    gint             ref;
+    DnfStateTraceFunc func;
+    gpointer         user_data;
+    GDestroyNotify   destroy_func;
+} DnfStateTracer;
+
+typedef struct
+{
+    FILE                *file;
+    DnfStateTraceFormat  format;
+    gboolean             first;
+    gint                 pid;
+} DnfStateTraceFile;
+
 typedef struct
 {
     gboolean         allow_cancel;
@@ -116,6 +137,12 @@ typedef struct
     DnfState         *parent;
     GPtrArray        *lock_ids;
     DnfLock          *lock;
+    DnfStateTracer   *tracer;
+    gint64            trace_step_start;
+    guint64           trace_step_speed;
+    DnfStateAction    trace_action;
+    gint64            trace_action_start;
+    guint64           trace_action_speed;
 } DnfStatePrivate;
 
 enum {
@@ -140,6 +167,30 @@ G_DEFINE_TYPE_WITH_PRIVATE(DnfState, dnf_state, G_TYPE_OBJECT)
 
 #define DNF_STATE_SPEED_SMOOTHING_ITEMS        5
 
+/**
+ * dnf_state_tracer_unref:
+ **/
+static void
+dnf_state_tracer_unref(DnfStateTracer *tracer)
+{
+    if (tracer == NULL || !g_atomic_int_dec_and_test(&tracer->ref))
+        return;
+    if (tracer->destroy_func != NULL)
+        tracer->destroy_func(tracer->user_data);
+    g_free(tracer);
+}
+
+/**
+ * dnf_state_tracer_ref:
+ **/
+static DnfStateTracer *
+dnf_state_tracer_ref(DnfStateTracer *tracer)
+{
+    if (tracer != NULL)
+        g_atomic_int_inc(&tracer->ref);
+    return tracer;
+}
+
 /**
  * dnf_state_finalize:
  **/
@@ -163,6 +214,7 @@ dnf_state_finalize(GObject *object)
     g_free(priv->speed_data);
     g_ptr_array_unref(priv->lock_ids);
     g_object_unref(priv->lock);
+    dnf_state_tracer_unref(priv->tracer);
 
     G_OBJECT_CLASS(dnf_state_parent_class)->finalize(object);
 }
@@ -178,6 +230,7 @@ dnf_state_init(DnfState *state)
     priv->allow_cancel_child = TRUE;
     priv->action = DNF_STATE_ACTION_UNKNOWN;
     priv->last_action = DNF_STATE_ACTION_UNKNOWN;
+    priv->trace_action = DNF_STATE_ACTION_UNKNOWN;
     priv->timer = g_timer_new();
     priv->lock_ids = g_ptr_array_new();
     priv->report_progress = TRUE;
@@ -316,6 +369,307 @@ dnf_state_set_enable_profile(DnfState *state, gboolean enable_profile)
     priv->enable_profile = enable_profile;
 }
 
+/**
+ * dnf_state_set_tracer:
+ **/
+static void
+dnf_state_set_tracer(DnfState *state, DnfStateTracer *tracer)
+{
+    DnfStatePrivate *priv = GET_PRIVATE(state);
+    if (priv->tracer == tracer)
+        return;
+    dnf_state_tracer_unref(priv->tracer);
+    priv->tracer = dnf_state_tracer_ref(tracer);
+    priv->trace_step_start = g_get_monotonic_time();
+    priv->trace_step_speed = 0;
+    priv->trace_action = DNF_STATE_ACTION_UNKNOWN;
+
+    /* the current child gets it too, later ones in dnf_state_get_child() */
+    if (priv->child != NULL)
+        dnf_state_set_tracer(priv->child, tracer);
+}
+
+/**
+ * dnf_state_set_trace_func:
+ * @state: A #DnfState
+ * @func: (scope notified) (nullable): function called for every finished span, or %NULL
+ * @user_data: data passed to @func
+ * @destroy_func: (nullable): function to free @user_data, or %NULL
+ *
+ * Traces the steps and actions of @state and of all its children. Every
+ * step finished with dnf_state_done() and every action ended with
+ * dnf_state_action_stop(), or replaced by another action, is given to
+ * @func as a #DnfStateSpan. The spans of the children are nested in time
+ * within the step of the parent they belong to.
+ *
+ * Unlike dnf_state_set_enable_profile() this is cheap enough to be used in
+ * production. Setting %NULL stops tracing.
+ *
+ * Since: 0.19.1
+ **/
+void
+dnf_state_set_trace_func(DnfState *state,
+                         DnfStateTraceFunc func,
+                         gpointer user_data,
+                         GDestroyNotify destroy_func)
+{
+    DnfStateTracer *tracer = NULL;
+
+    g_return_if_fail(DNF_IS_STATE(state));
+
+    if (func != NULL) {
+        tracer = g_new0(DnfStateTracer, 1);
+        tracer->ref = 1;
+        tracer->func = func;
+        tracer->user_data = user_data;
+        tracer->destroy_func = destroy_func;
+    } else if (destroy_func != NULL) {
+        destroy_func(user_data);
+    }
+    dnf_state_set_tracer(state, tracer);
+    dnf_state_tracer_unref(tracer);
+}
+
+/**
+ * dnf_state_action_to_string:
+ * @action: A #DnfStateAction
+ *
+ * Converts the action to a string.
+ *
+ * Returns: the action as a string, e.g. "download-packages"
+ *
+ * Since: 0.19.1
+ **/
+const gchar *
+dnf_state_action_to_string(DnfStateAction action)
+{
+    switch (action) {
+    case DNF_STATE_ACTION_DOWNLOAD_PACKAGES:
+        return "download-packages";
+    case DNF_STATE_ACTION_DOWNLOAD_METADATA:
+        return "download-metadata";
+    case DNF_STATE_ACTION_LOADING_CACHE:
+        return "loading-cache";
+    case DNF_STATE_ACTION_TEST_COMMIT:
+        return "test-commit";
+    case DNF_STATE_ACTION_REQUEST:
+        return "request";
+    case DNF_STATE_ACTION_REMOVE:
+        return "remove";
+    case DNF_STATE_ACTION_INSTALL:
+        return "install";
+    case DNF_STATE_ACTION_UPDATE:
+        return "update";
+    case DNF_STATE_ACTION_CLEANUP:
+        return "cleanup";
+    case DNF_STATE_ACTION_OBSOLETE:
+        return "obsolete";
+    case DNF_STATE_ACTION_REINSTALL:
+        return "reinstall";
+    case DNF_STATE_ACTION_DOWNGRADE:
+        return "downgrade";
+    case DNF_STATE_ACTION_QUERY:
+        return "query";
+    default:
+        return "unknown";
+    }
+}
+
+/**
+ * dnf_state_trace_append_string:
+ **/
+static void
+dnf_state_trace_append_string(GString *str, const gchar *value)
+{
+    if (value == NULL) {
+        g_string_append(str, "null");
+        return;
+    }
+    g_string_append_c(str, '"');
+    for (const gchar *p = value; *p != '\0'; p++) {
+        switch (*p) {
+        case '"':
+            g_string_append(str, "\\\"");
+            break;
+        case '\\':
+            g_string_append(str, "\\\\");
+            break;
+        default:
+            if ((guchar) *p < 0x20)
+                g_string_append_printf(str, "\\u%04x", (guint) *p);
+            else
+                g_string_append_c(str, *p);
+        }
+    }
+    g_string_append_c(str, '"');
+}
+
+/**
+ * dnf_state_trace_file_cb:
+ **/
+static void
+dnf_state_trace_file_cb(const DnfStateSpan *span, gpointer user_data)
+{
+    auto trace = static_cast<DnfStateTraceFile *>(user_data);
+    const gchar *kind = span->kind == DNF_STATE_SPAN_KIND_STEP ? "step" : "action";
+    g_autoptr(GString) str = g_string_new(NULL);
+
+    if (trace->format == DNF_STATE_TRACE_FORMAT_CHROME) {
+        g_string_append(str, trace->first ? "\n" : ",\n");
+        trace->first = FALSE;
+        g_string_append(str, "{\"name\":");
+        if (span->kind == DNF_STATE_SPAN_KIND_STEP) {
+            g_autofree gchar *name = g_strdup_printf("%s [%u/%u]",
+                                                     span->id != NULL ? span->id : "",
+                                                     span->step + 1, span->steps);
+            dnf_state_trace_append_string(str, name);
+        } else {
+            dnf_state_trace_append_string(str, dnf_state_action_to_string(span->action));
+        }
+        g_string_append_printf(str, ",\"cat\":\"%s\",\"ph\":\"X\","
+                               "\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT ","
+                               "\"pid\":%i,\"tid\":%i,\"args\":{",
+                               kind, span->start, span->duration, trace->pid, trace->pid);
+    } else {
+        g_string_append_printf(str, "{\"kind\":\"%s\",\"start\":%" G_GINT64_FORMAT ","
+                               "\"duration\":%" G_GINT64_FORMAT ",",
+                               kind, span->start, span->duration);
+    }
+    g_string_append(str, "\"id\":");
+    dnf_state_trace_append_string(str, span->id);
+    g_string_append_printf(str, ",\"depth\":%u,\"step\":%u,\"steps\":%u,\"action\":\"%s\","
+                           "\"action_hint\":",
+                           span->depth, span->step, span->steps,
+                           dnf_state_action_to_string(span->action));
+    dnf_state_trace_append_string(str, span->action_hint);
+    g_string_append_printf(str, ",\"speed\":%" G_GUINT64_FORMAT "}", span->speed);
+    if (trace->format == DNF_STATE_TRACE_FORMAT_CHROME)
+        g_string_append_c(str, '}');
+    else
+        g_string_append_c(str, '\n');
+    fwrite(str->str, 1, str->len, trace->file);
+}
+
+/**
+ * dnf_state_trace_file_free:
+ **/
+static void
+dnf_state_trace_file_free(gpointer user_data)
+{
+    auto trace = static_cast<DnfStateTraceFile *>(user_data);
+    if (trace->format == DNF_STATE_TRACE_FORMAT_CHROME)
+        fputs("\n]\n", trace->file);
+    fclose(trace->file);
+    g_free(trace);
+}
+
+/**
+ * dnf_state_set_trace_file:
+ * @state: A #DnfState
+ * @filename: the file to write the trace to, it is truncated
+ * @format: A #DnfStateTraceFormat
+ * @error: A #GError or %NULL
+ *
+ * Traces @state and its children like dnf_state_set_trace_func(), writing
+ * the spans to @filename. With %DNF_STATE_TRACE_FORMAT_CHROME the file can
+ * be loaded in chrome://tracing or similar viewers. The file is closed when
+ * tracing is stopped or @state and its children are destroyed.
+ *
+ * Returns: %TRUE for success, %FALSE otherwise
+ *
+ * Since: 0.19.1
+ **/
+gboolean
+dnf_state_set_trace_file(DnfState *state,
+                         const gchar *filename,
+                         DnfStateTraceFormat format,
+                         GError **error)
+{
+    DnfStateTraceFile *trace;
+    FILE *file;
+
+    g_return_val_if_fail(DNF_IS_STATE(state), FALSE);
+    g_return_val_if_fail(filename != NULL, FALSE);
+    g_return_val_if_fail(format < DNF_STATE_TRACE_FORMAT_LAST, FALSE);
+
+    file = fopen(filename, "w");
+    if (file == NULL) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    _("failed to open %1$s: %2$s"),
+                    filename, g_strerror(errno));
+        return FALSE;
+    }
+    if (format == DNF_STATE_TRACE_FORMAT_CHROME)
+        fputs("[", file);
+
+    trace = g_new0(DnfStateTraceFile, 1);
+    trace->file = file;
+    trace->format = format;
+    trace->first = TRUE;
+    trace->pid = getpid();
+    dnf_state_set_trace_func(state, dnf_state_trace_file_cb, trace, dnf_state_trace_file_free);
+    return TRUE;
+}
+
+/**
+ * dnf_state_trace_emit:
+ **/
+static void
+dnf_state_trace_emit(DnfState *state,
+                     DnfStateSpanKind kind,
+                     DnfStateAction action,
+                     gint64 start,
+                     guint64 speed)
+{
+    DnfStatePrivate *priv = GET_PRIVATE(state);
+    DnfStateSpan span;
+
+    span.kind = kind;
+    span.id = priv->id;
+    span.depth = 0;
+    for (DnfState *parent = priv->parent; parent != NULL; parent = GET_PRIVATE(parent)->parent)
+        span.depth++;
+    span.step = priv->current;
+    span.steps = priv->steps;
+    span.action = action;
+    span.action_hint = priv->action_hint;
+    span.start = start;
+    span.duration = g_get_monotonic_time() - start;
+    span.speed = speed;
+    priv->tracer->func(&span, priv->tracer->user_data);
+}
+
+/**
+ * dnf_state_trace_action_end:
+ **/
+static void
+dnf_state_trace_action_end(DnfState *state)
+{
+    DnfStatePrivate *priv = GET_PRIVATE(state);
+    if (priv->tracer == NULL || priv->trace_action == DNF_STATE_ACTION_UNKNOWN)
+        return;
+    dnf_state_trace_emit(state, DNF_STATE_SPAN_KIND_ACTION, priv->trace_action,
+                         priv->trace_action_start, priv->trace_action_speed);
+    priv->trace_action = DNF_STATE_ACTION_UNKNOWN;
+}
+
+/**
+ * dnf_state_trace_step_end:
+ **/
+static void
+dnf_state_trace_step_end(DnfState *state)
+{
+    DnfStatePrivate *priv = GET_PRIVATE(state);
+    if (priv->tracer == NULL)
+        return;
+    dnf_state_trace_emit(state, DNF_STATE_SPAN_KIND_STEP, priv->action,
+                         priv->trace_step_start, priv->trace_step_speed);
+    priv->trace_step_start = g_get_monotonic_time();
+    priv->trace_step_speed = 0;
+}
+
 /**
  * dnf_state_take_lock:
  * @state: A #DnfState
@@ -493,6 +847,10 @@ dnf_state_set_speed_internal(DnfState *state, guint64 speed)
     if (priv->speed == speed)
         return;
     priv->speed = speed;
+    if (priv->tracer != NULL) {
+        priv->trace_step_speed = MAX(priv->trace_step_speed, speed);
+        priv->trace_action_speed = MAX(priv->trace_action_speed, speed);
+    }
     g_object_notify(G_OBJECT(state), "speed");
 }
 
@@ -691,6 +1049,14 @@ dnf_state_action_start(DnfState *state, DnfStateAction action, const gchar *acti
     /* remember for stop */
     priv->last_action = priv->action;
 
+    /* the previous action ends here */
+    if (priv->tracer != NULL) {
+        dnf_state_trace_action_end(state);
+        priv->trace_action = action;
+        priv->trace_action_start = g_get_monotonic_time();
+        priv->trace_action_speed = 0;
+    }
+
     /* save hint */
     g_free(priv->action_hint);
     priv->action_hint = g_strdup(action_hint);
@@ -751,6 +1117,9 @@ dnf_state_action_stop(DnfState *state)
         return FALSE;
     }
 
+    /* while the hint is still set */
+    dnf_state_trace_action_end(state);
+
     /* pop and reset */
     priv->action = priv->last_action;
     priv->last_action = DNF_STATE_ACTION_UNKNOWN;
@@ -939,6 +1308,10 @@ dnf_state_reset(DnfState *state)
     /* only use the timer if profiling; it's expensive */
     if (priv->enable_profile)
         g_timer_start(priv->timer);
+    if (priv->tracer != NULL) {
+        priv->trace_step_start = g_get_monotonic_time();
+        priv->trace_step_speed = 0;
+    }
 
     /* disconnect client */
     if (priv->percentage_child_id != 0) {
@@ -1071,6 +1444,7 @@ dnf_state_get_child(DnfState *state)
 
     /* set the profile state */
     dnf_state_set_enable_profile(child, priv->enable_profile);
+    dnf_state_set_tracer(child, priv->tracer);
     return child;
 }
 
@@ -1120,6 +1494,10 @@ dnf_state_set_number_steps_real(DnfState *state, guint steps, const gchar *strlo
     /* only use the timer if profiling; it's expensive */
     if (priv->enable_profile)
         g_timer_start(priv->timer);
+    if (priv->tracer != NULL) {
+        priv->trace_step_start = g_get_monotonic_time();
+        priv->trace_step_speed = 0;
+    }
 
     /* set steps */
     priv->steps = steps;
@@ -1372,6 +1750,8 @@ dnf_state_done_real(DnfState *state, GError **error, const gchar *strloc)
     /* we just checked for cancel, so it's not true to say we're blocking */
     dnf_state_set_allow_cancel(state, TRUE);
 
+    dnf_state_trace_step_end(state);
+
     /* another */
     priv->current++;
 
@@ -1426,6 +1806,10 @@ dnf_state_finished_real(DnfState *state, GError **error, const gchar *strloc)
     if (priv->current == priv->steps)
         return TRUE;
 
+    /* the remaining steps as one span */
+    if (priv->current < priv->steps)
+        dnf_state_trace_step_end(state);
+
     /* all done */
     priv->current = priv->steps;
 
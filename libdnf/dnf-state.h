@@ -71,6 +71,68 @@ typedef enum {
         DNF_STATE_ACTION_LAST
 } DnfStateAction;
 
+/**
+ * DnfStateSpanKind:
+ * @DNF_STATE_SPAN_KIND_STEP:                   A step, ended by dnf_state_done()
+ * @DNF_STATE_SPAN_KIND_ACTION:                 An action, from dnf_state_action_start() until it is stopped
+ *
+ * The kind of a traced span.
+ **/
+typedef enum {
+        DNF_STATE_SPAN_KIND_STEP,                       /* Since: 0.19.1 */
+        DNF_STATE_SPAN_KIND_ACTION,                     /* Since: 0.19.1 */
+        /*< private >*/
+        DNF_STATE_SPAN_KIND_LAST
+} DnfStateSpanKind;
+
+/**
+ * DnfStateTraceFormat:
+ * @DNF_STATE_TRACE_FORMAT_JSON_LINES:          One JSON object per span and line
+ * @DNF_STATE_TRACE_FORMAT_CHROME:              Chrome trace event format, for chrome://tracing
+ *
+ * The format of a trace file.
+ **/
+typedef enum {
+        DNF_STATE_TRACE_FORMAT_JSON_LINES,              /* Since: 0.19.1 */
+        DNF_STATE_TRACE_FORMAT_CHROME,                  /* Since: 0.19.1 */
+        /*< private >*/
+        DNF_STATE_TRACE_FORMAT_LAST
+} DnfStateTraceFormat;
+
+/**
+ * DnfStateSpan:
+ * @kind:               the #DnfStateSpanKind
+ * @id:                 the code location which set the steps of the state, or %NULL
+ * @depth:              0 for a state without a parent, 1 for its child and so on
+ * @step:               the index of the finished step
+ * @steps:              the number of steps of the state
+ * @action:             the action of the state
+ * @action_hint:        the action hint, or %NULL
+ * @start:              the monotonic time of the start in microseconds
+ * @duration:           the duration in microseconds
+ * @speed:              the highest speed in bytes per second set during the span
+ *
+ * A finished span of a #DnfState, given to the #DnfStateTraceFunc.
+ *
+ * The span and its @id and @action_hint strings are only valid during the
+ * call of the #DnfStateTraceFunc, copy them to keep them.
+ **/
+typedef struct {
+        DnfStateSpanKind         kind;
+        const gchar             *id;
+        guint                    depth;
+        guint                    step;
+        guint                    steps;
+        DnfStateAction           action;
+        const gchar             *action_hint;
+        gint64                   start;
+        gint64                   duration;
+        guint64                  speed;
+} DnfStateSpan;
+
+typedef void     (*DnfStateTraceFunc)                   (const DnfStateSpan     *span,
+                                                         gpointer                user_data);
+
 struct _DnfStateClass
 {
         GObjectClass    parent_class;
@@ -157,6 +219,15 @@ gboolean         dnf_state_finished_real                (DnfState
 gboolean         dnf_state_reset                        (DnfState               *state);
 void             dnf_state_set_enable_profile           (DnfState               *state,
                                                          gboolean                enable_profile);
+void             dnf_state_set_trace_func               (DnfState               *state,
+                                                         DnfStateTraceFunc       func,
+                                                         gpointer                user_data,
+                                                         GDestroyNotify          destroy_func);
+gboolean         dnf_state_set_trace_file               (DnfState               *state,
+                                                         const gchar            *filename,
+                                                         DnfStateTraceFormat     format,
+                                                         GError                 **error);
+const gchar     *dnf_state_action_to_string             (DnfStateAction          action);
 #ifndef __GI_SCANNER__
 gboolean         dnf_state_take_lock                    (DnfState               *state,
                                                          DnfLockType             lock_type,
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef __DNF_TRANSACTION_PRIVATE_HPP
+#define __DNF_TRANSACTION_PRIVATE_HPP
+
+#include <sys/types.h>
+
+#include "dnf-packagedelta.h"
+#include "dnf-transaction.h"
+#include "transaction/Types.hpp"
+
+/* an installed package replaced by a package of the transaction */
+typedef struct {
+    DnfPackage *obsoleter; /* borrowed from the install array */
+    DnfPackage *pkg;
+    libdnf::TransactionItemAction action;
+    gboolean obsoleted;    /* in hy_goal_list_obsoleted() */
+} DnfTransactionObsolete;
+
+/* space needed by the transaction on one filesystem */
+typedef struct {
+    gchar *path;    /* a directory on the filesystem */
+    dev_t dev;
+    gint64 needed;  /* negative if the transaction frees space */
+} DnfTransactionSpace;
+
+GArray          *dnf_transaction_list_obsoletes         (HyGoal          goal,
+                                                         GPtrArray      *install);
+DnfPackageDelta *dnf_transaction_find_delta             (DnfSack        *sack,
+                                                         DnfPackage     *pkg,
+                                                         guint           percentage);
+
+GPtrArray       *dnf_transaction_space_new              (void);
+void             dnf_transaction_space_add_package      (GPtrArray      *space,
+                                                         GHashTable     *prefixes,
+                                                         const gchar    *root,
+                                                         DnfPackage     *pkg,
+                                                         gint            sign,
+                                                         gboolean        use_files);
+gboolean         dnf_transaction_space_check            (GPtrArray      *space,
+                                                         GError        **error);
+
+gchar           *dnf_transaction_get_test_key           (DnfContext     *context,
+                                                         guint64         transaction_flags,
+                                                         GPtrArray      *install,
+                                                         GPtrArray      *remove,
+                                                         GPtrArray      *remove_helper);
+gboolean         dnf_transaction_was_tested             (DnfContext     *context,
+                                                         const gchar    *test_key);
+void             dnf_transaction_set_tested             (DnfContext     *context,
+                                                         const gchar    *test_key);
+
+#endif /* __DNF_TRANSACTION_PRIVATE_HPP */
@@ -28,6 +28,11 @@
  * This object represents an RPM transaction.
  */
 
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <glib/gstdio.h>
 #include <rpm/rpmlib.h>
 #include <rpm/rpmlog.h>
 #include <rpm/rpmts.h>
@@ -36,13 +41,20 @@
 #include "dnf-goal.h"
 #include "dnf-keyring.h"
 #include "dnf-package.h"
+#include "dnf-package-store.hpp"
+#include "dnf-repo.hpp"
 #include "dnf-rpmts.h"
 #include "dnf-sack.h"
+#include "dnf-sack-private.hpp"
 #include "dnf-transaction.h"
+#include "dnf-transaction-private.hpp"
 #include "dnf-types.h"
 #include "dnf-utils.h"
+#include "goal/Goal.hpp"
+#include "hy-iutil.h"
 #include "hy-query.h"
 #include "hy-util-private.hpp"
+#include "sack/packageset.hpp"
 
 #include "transaction/Swdb.hpp"
 #include "transaction/Transformer.hpp"
@@ -55,6 +67,13 @@ typedef enum {
     DNF_TRANSACTION_STEP_IGNORE
 } DnfTransactionStep;
 
+/* lookups of the packages reported by the rpm callbacks */
+typedef struct {
+    GHashTable *by_nevra;    /* NEVRA → DnfPackage */
+    GHashTable *by_basename; /* basename of the filename → DnfPackage */
+    GHashTable *by_name;     /* name → DnfPackage */
+} DnfTransactionPkgIndex;
+
 typedef struct {
     rpmKeyring keyring;
     rpmts ts;
@@ -76,12 +95,47 @@ typedef struct {
     GHashTable *erased_by_package_hash;
     guint64 flags;
     libdnf::Swdb *swdb;
+    GHashTable *verified;
+    GMutex verified_mutex;
+    DnfTransactionPkgIndex *install_index;
+    DnfTransactionPkgIndex *remove_index;
+    DnfTransactionPkgIndex *remove_helper_index;
+    GPtrArray *space;
 } DnfTransactionPrivate;
 
+/* package file verified ahead of dnf_transaction_commit() */
+typedef struct {
+    gchar *filename;
+    GError *error;  /* the GPG check failed */
+    Header hdr;     /* header for the rpm transaction, or NULL */
+    rpmRC rc;       /* result of reading the header */
+} DnfTransactionVerified;
+
+typedef struct {
+    DnfRepo *repo;
+    Id id;
+    gchar *filename;
+    gchar *nevra;
+} DnfTransactionVerifyJob;
+
 G_DEFINE_TYPE_WITH_PRIVATE(DnfTransaction, dnf_transaction, G_TYPE_OBJECT)
 #define GET_PRIVATE(o)                                                                             \
     (static_cast< DnfTransactionPrivate * >(dnf_transaction_get_instance_private(o)))
 
+/**
+ * dnf_transaction_pkg_index_free:
+ **/
+static void
+dnf_transaction_pkg_index_free(DnfTransactionPkgIndex *index)
+{
+    if (index == NULL)
+        return;
+    g_hash_table_unref(index->by_nevra);
+    g_hash_table_unref(index->by_basename);
+    g_hash_table_unref(index->by_name);
+    g_slice_free(DnfTransactionPkgIndex, index);
+}
+
 /**
  * dnf_transaction_finalize:
  **/
@@ -108,12 +162,47 @@ dnf_transaction_finalize(GObject *object)
         g_ptr_array_unref(priv->remove_helper);
     if (priv->erased_by_package_hash != NULL)
         g_hash_table_unref(priv->erased_by_package_hash);
+    g_hash_table_unref(priv->verified);
+    g_mutex_clear(&priv->verified_mutex);
+    dnf_transaction_pkg_index_free(priv->install_index);
+    dnf_transaction_pkg_index_free(priv->remove_index);
+    dnf_transaction_pkg_index_free(priv->remove_helper_index);
+    g_ptr_array_unref(priv->space);
     if (priv->context != NULL)
         g_object_remove_weak_pointer(G_OBJECT(priv->context), (void **)&priv->context);
 
     G_OBJECT_CLASS(dnf_transaction_parent_class)->finalize(object);
 }
 
+static void
+dnf_transaction_space_free(DnfTransactionSpace *space)
+{
+    g_free(space->path);
+    g_slice_free(DnfTransactionSpace, space);
+}
+
+/**
+ * dnf_transaction_space_new:
+ *
+ * Returns: (transfer container): an empty array of #DnfTransactionSpace
+ **/
+GPtrArray *
+dnf_transaction_space_new(void)
+{
+    return g_ptr_array_new_with_free_func((GDestroyNotify)dnf_transaction_space_free);
+}
+
+static void
+dnf_transaction_verified_free(DnfTransactionVerified *verified)
+{
+    g_free(verified->filename);
+    if (verified->error != NULL)
+        g_error_free(verified->error);
+    if (verified->hdr != NULL)
+        headerFree(verified->hdr);
+    g_slice_free(DnfTransactionVerified, verified);
+}
+
 /**
  * dnf_transaction_init:
  **/
@@ -123,6 +212,10 @@ dnf_transaction_init(DnfTransaction *transaction)
     DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
     priv->timer = g_timer_new();
     priv->pkgs_to_download = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+    priv->verified = g_hash_table_new_full(
+        g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)dnf_transaction_verified_free);
+    g_mutex_init(&priv->verified_mutex);
+    priv->space = dnf_transaction_space_new();
 }
 
 /**
@@ -172,13 +265,27 @@ dnf_transaction_get_remote_pkgs(DnfTransaction *transaction)
     return priv->pkgs_to_download;
 }
 
-DnfDb *
-dnf_transaction_get_db(DnfTransaction *transaction)
+/**
+ * dnf_transaction_ensure_swdb:
+ *
+ * Opens the history database on the first use, so a transaction which
+ * is only depsolved, downloaded and verified doesn't need it.
+ **/
+static libdnf::Swdb *
+dnf_transaction_ensure_swdb(DnfTransaction *transaction)
 {
     DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    if (priv->swdb == NULL)
+        priv->swdb = new libdnf::Swdb(libdnf::Swdb::defaultPath);
     return priv->swdb;
 }
 
+DnfDb *
+dnf_transaction_get_db(DnfTransaction *transaction)
+{
+    return dnf_transaction_ensure_swdb(transaction);
+}
+
 /**
  * dnf_transaction_set_repos:
  * @transaction: a #DnfTransaction instance.
@@ -309,18 +416,109 @@ dnf_transaction_ensure_repo_list(DnfTransaction *transaction, GPtrArray *pkglist
     return TRUE;
 }
 
-gboolean
-dnf_transaction_gpgcheck_package(DnfTransaction *transaction, DnfPackage *pkg, GError **error)
+/**
+ * dnf_transaction_get_verified:
+ *
+ * Returns the result of verifying the package file while it was
+ * downloaded, or %NULL if it wasn't verified yet.
+ **/
+static DnfTransactionVerified *
+dnf_transaction_get_verified(DnfTransaction *transaction, DnfPackage *pkg, const gchar *filename)
+{
+    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    DnfTransactionVerified *verified;
+
+    g_mutex_lock(&priv->verified_mutex);
+    verified = static_cast< DnfTransactionVerified * >(
+        g_hash_table_lookup(priv->verified, GINT_TO_POINTER(dnf_package_get_id(pkg))));
+    g_mutex_unlock(&priv->verified_mutex);
+    if (verified == NULL || g_strcmp0(verified->filename, filename) != 0)
+        return NULL;
+    return verified;
+}
+
+/**
+ * dnf_transaction_gpgcheck_result:
+ *
+ * Decides whether the result of dnf_keyring_check_untrusted_file() is
+ * acceptable for a package from @repo. Takes ownership of @error_local.
+ **/
+static gboolean
+dnf_transaction_gpgcheck_result(DnfTransaction *transaction,
+                                DnfRepo *repo,
+                                const gchar *nevra,
+                                GError *error_local,
+                                GError **error)
+{
+    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+
+    /* trusted */
+    if (error_local == NULL)
+        return TRUE;
+
+    /* probably an i/o error */
+    if (!g_error_matches(error_local, DNF_ERROR, DNF_ERROR_GPG_SIGNATURE_INVALID)) {
+        g_propagate_error(error, error_local);
+        return FALSE;
+    }
+
+    /* if the repo is signed this is ALWAYS an error */
+    if (repo != NULL && dnf_repo_get_gpgcheck(repo)) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    _("package %1$s cannot be verified "
+                      "and repo %2$s is GPG enabled: %3$s"),
+                    nevra,
+                    dnf_repo_get_id(repo),
+                    error_local->message);
+        g_error_free(error_local);
+        return FALSE;
+    }
+
+    /* we can only install signed packages in this mode */
+    if ((priv->flags & DNF_TRANSACTION_FLAG_ONLY_TRUSTED) > 0) {
+        g_propagate_error(error, error_local);
+        return FALSE;
+    }
+    g_error_free(error_local);
+    return TRUE;
+}
+
+/**
+ * dnf_transaction_gpgcheck_file:
+ *
+ * Checks the signature of a package file. Doesn't touch the package
+ * itself, so it can be called from a worker thread.
+ **/
+static gboolean
+dnf_transaction_gpgcheck_file(DnfTransaction *transaction,
+                              DnfRepo *repo,
+                              const gchar *fn,
+                              const gchar *nevra,
+                              GError **error)
 {
     DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
     GError *error_local = NULL;
-    DnfRepo *repo;
+
+    dnf_keyring_check_untrusted_file(priv->keyring, fn, &error_local);
+    return dnf_transaction_gpgcheck_result(transaction, repo, nevra, error_local, error);
+}
+
+/**
+ * dnf_transaction_gpgcheck_filename:
+ *
+ * Returns the local file of the package to check, or %NULL.
+ **/
+static const gchar *
+dnf_transaction_gpgcheck_filename(DnfTransaction *transaction, DnfPackage *pkg, GError **error)
+{
     const gchar *fn;
 
     /* ensure the filename is set */
     if (!dnf_transaction_ensure_repo(transaction, pkg, error)) {
         g_prefix_error(error, _("Failed to check untrusted: "));
-        return FALSE;
+        return NULL;
     }
 
     /* find the location of the local file */
@@ -331,43 +529,33 @@ dnf_transaction_gpgcheck_package(DnfTransaction *transaction, DnfPackage *pkg, G
                     DNF_ERROR_FILE_NOT_FOUND,
                     _("Downloaded file for %s not found"),
                     dnf_package_get_name(pkg));
-        return FALSE;
+        return NULL;
     }
+    return fn;
+}
 
-    /* check file */
-    if (!dnf_keyring_check_untrusted_file(priv->keyring, fn, &error_local)) {
-
-        /* probably an i/o error */
-        if (!g_error_matches(error_local, DNF_ERROR, DNF_ERROR_GPG_SIGNATURE_INVALID)) {
-            g_propagate_error(error, error_local);
-            return FALSE;
-        }
+gboolean
+dnf_transaction_gpgcheck_package(DnfTransaction *transaction, DnfPackage *pkg, GError **error)
+{
+    DnfTransactionVerified *verified;
+    const gchar *fn;
 
-        /* if the repo is signed this is ALWAYS an error */
-        repo = dnf_package_get_repo(pkg);
-        if (repo != NULL && dnf_repo_get_gpgcheck(repo)) {
-            g_set_error(error,
-                        DNF_ERROR,
-                        DNF_ERROR_FILE_INVALID,
-                        _("package %1$s cannot be verified "
-                          "and repo %2$s is GPG enabled: %3$s"),
-                        dnf_package_get_nevra(pkg),
-                        dnf_repo_get_id(repo),
-                        error_local->message);
-            g_error_free(error_local);
-            return FALSE;
-        }
+    fn = dnf_transaction_gpgcheck_filename(transaction, pkg, error);
+    if (fn == NULL)
+        return FALSE;
 
-        /* we can only install signed packages in this mode */
-        if ((priv->flags & DNF_TRANSACTION_FLAG_ONLY_TRUSTED) > 0) {
-            g_propagate_error(error, error_local);
+    /* already checked while it was downloaded */
+    verified = dnf_transaction_get_verified(transaction, pkg, fn);
+    if (verified != NULL) {
+        if (verified->error != NULL) {
+            g_propagate_error(error, g_error_copy(verified->error));
             return FALSE;
-        } else {
-            g_clear_error(&error_local);
         }
+        return TRUE;
     }
 
-    return TRUE;
+    return dnf_transaction_gpgcheck_file(
+        transaction, dnf_package_get_repo(pkg), fn, dnf_package_get_nevra(pkg), error);
 }
 
 /**
@@ -377,12 +565,20 @@ dnf_transaction_gpgcheck_package(DnfTransaction *transaction, DnfPackage *pkg, G
  * @error: Error
  *
  * Verify GPG signatures for all pending packages to be changed as part
- * of @goal.
+ * of @goal. The files are checked in parallel, the reported error is the
+ * one of the first failing package in the order of the goal.
  */
 gboolean
 dnf_transaction_check_untrusted(DnfTransaction *transaction, HyGoal goal, GError **error)
 {
+    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    DnfTransactionVerified *verified;
+    gboolean ret = TRUE;
     guint i;
+    g_autofree GError **errors = NULL;
+    g_autofree GError **checked = NULL;
+    g_autoptr(GArray) indexes = NULL;
+    g_autoptr(GPtrArray) filenames = NULL;
     g_autoptr(GPtrArray) install = NULL;
 
     /* find a list of all the packages we might have to download */
@@ -395,28 +591,112 @@ dnf_transaction_check_untrusted(DnfTransaction *transaction, HyGoal goal, GError
     if (install->len == 0)
         return TRUE;
 
-    /* find any packages in untrusted repos */
+    /* find the files which were not checked yet */
+    errors = g_new0(GError *, install->len);
+    filenames = g_ptr_array_sized_new(install->len);
+    indexes = g_array_sized_new(FALSE, FALSE, sizeof(guint), install->len);
     for (i = 0; i < install->len; i++) {
         auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(install, i));
+        const gchar *fn = dnf_transaction_gpgcheck_filename(transaction, pkg, &errors[i]);
+        if (fn == NULL)
+            continue;
+        verified = dnf_transaction_get_verified(transaction, pkg, fn);
+        if (verified != NULL) {
+            if (verified->error != NULL)
+                errors[i] = g_error_copy(verified->error);
+            continue;
+        }
+        g_ptr_array_add(filenames, (gpointer)fn);
+        g_array_append_val(indexes, i);
+    }
 
-        if (!dnf_transaction_gpgcheck_package(transaction, pkg, error))
-            return FALSE;
+    /* check them in parallel */
+    checked = g_new0(GError *, filenames->len);
+    if (!dnf_keyring_check_untrusted_files(priv->keyring, filenames, checked, error)) {
+        ret = FALSE;
+        goto out;
     }
-    return TRUE;
+    for (i = 0; i < indexes->len; i++) {
+        guint idx = g_array_index(indexes, guint, i);
+        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(install, idx));
+        dnf_transaction_gpgcheck_result(transaction,
+                                        dnf_package_get_repo(pkg),
+                                        dnf_package_get_nevra(pkg),
+                                        checked[i],
+                                        &errors[idx]);
+        checked[i] = NULL;
+    }
+
+    /* report the first failure in the package order */
+    for (i = 0; i < install->len; i++) {
+        if (errors[i] != NULL) {
+            g_propagate_error(error, errors[i]);
+            errors[i] = NULL;
+            ret = FALSE;
+            break;
+        }
+    }
+out:
+    for (i = 0; i < install->len; i++) {
+        if (errors[i] != NULL)
+            g_error_free(errors[i]);
+    }
+    for (i = 0; i < filenames->len; i++) {
+        if (checked[i] != NULL)
+            g_error_free(checked[i]);
+    }
+    return ret;
+}
+
+/**
+ * dnf_transaction_pkg_index_new:
+ *
+ * Indexes the packages of @array, the NEVRA keys are owned by the sack.
+ **/
+static DnfTransactionPkgIndex *
+dnf_transaction_pkg_index_new(GPtrArray *array)
+{
+    auto index = g_slice_new0(DnfTransactionPkgIndex);
+
+    index->by_nevra = g_hash_table_new(g_str_hash, g_str_equal);
+    index->by_basename = g_hash_table_new(g_str_hash, g_str_equal);
+    index->by_name = g_hash_table_new(g_str_hash, g_str_equal);
+    for (guint i = 0; i < array->len; i++) {
+        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(array, i));
+        const gchar *nevra = dnf_package_get_nevra(pkg);
+        const gchar *filename;
+
+        /* the first package wins, as it did when scanning the array */
+        if (!g_hash_table_contains(index->by_nevra, nevra))
+            g_hash_table_insert(index->by_nevra, (gpointer)nevra, pkg);
+        if (!g_hash_table_contains(index->by_name, dnf_package_get_name(pkg)))
+            g_hash_table_insert(index->by_name, (gpointer)dnf_package_get_name(pkg), pkg);
+        filename = dnf_package_get_filename(pkg);
+        if (filename != NULL) {
+            const gchar *basename = strrchr(filename, '/');
+            basename = basename != NULL ? basename + 1 : filename;
+            if (!g_hash_table_contains(index->by_basename, basename))
+                g_hash_table_insert(index->by_basename, (gpointer)basename, pkg);
+        }
+    }
+    return index;
 }
 
 /**
  * dnf_find_pkg_from_header:
  **/
 static DnfPackage *
-dnf_find_pkg_from_header(GPtrArray *array, Header hdr)
+dnf_find_pkg_from_header(DnfTransactionPkgIndex *index, Header hdr)
 {
     const gchar *arch;
     const gchar *name;
     const gchar *release;
     const gchar *version;
     guint epoch;
-    guint i;
+    g_autofree gchar *nevra = NULL;
+
+    if (index == NULL || hdr == NULL)
+        return NULL;
 
     /* get details */
     name = headerGetString(hdr, RPMTAG_NAME);
@@ -424,58 +704,45 @@ dnf_find_pkg_from_header(GPtrArray *array, Header hdr)
     version = headerGetString(hdr, RPMTAG_VERSION);
     release = headerGetString(hdr, RPMTAG_RELEASE);
     arch = headerGetString(hdr, RPMTAG_ARCH);
-
-    /* find in array */
-    for (i = 0; i < array->len; i++) {
-        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(array, i));
-        if (g_strcmp0(name, dnf_package_get_name(pkg)) != 0)
-            continue;
-        if (g_strcmp0(version, dnf_package_get_version(pkg)) != 0)
-            continue;
-        if (g_strcmp0(release, dnf_package_get_release(pkg)) != 0)
-            continue;
-        if (g_strcmp0(arch, dnf_package_get_arch(pkg)) != 0)
-            continue;
-        if (epoch != dnf_package_get_epoch(pkg))
-            continue;
-        return pkg;
-    }
-    return NULL;
+    if (name == NULL || version == NULL || release == NULL || arch == NULL)
+        return NULL;
+
+    /* same format as dnf_package_get_nevra() */
+    if (epoch > 0)
+        nevra = g_strdup_printf("%s-%u:%s-%s.%s", name, epoch, version, release, arch);
+    else
+        nevra = g_strdup_printf("%s-%s-%s.%s", name, version, release, arch);
+    return static_cast< DnfPackage * >(g_hash_table_lookup(index->by_nevra, nevra));
 }
 
 /**
  * dnf_find_pkg_from_filename_suffix:
  **/
 static DnfPackage *
-dnf_find_pkg_from_filename_suffix(GPtrArray *array, const gchar *filename_suffix)
+dnf_find_pkg_from_filename_suffix(DnfTransactionPkgIndex *index, const gchar *filename_suffix)
 {
-    /* find in array */
-    for (guint i = 0; i < array->len; i++) {
-        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(array, i));
-        auto filename = dnf_package_get_filename(pkg);
-        if (filename == NULL)
-            continue;
-        if (g_str_has_suffix(filename, filename_suffix))
-            return pkg;
-    }
-    return NULL;
+    const gchar *basename;
+    DnfPackage *pkg;
+
+    if (index == NULL || filename_suffix == NULL)
+        return NULL;
+    basename = strrchr(filename_suffix, '/');
+    basename = basename != NULL ? basename + 1 : filename_suffix;
+    pkg = static_cast< DnfPackage * >(g_hash_table_lookup(index->by_basename, basename));
+    if (pkg == NULL || !g_str_has_suffix(dnf_package_get_filename(pkg), filename_suffix))
+        return NULL;
+    return pkg;
 }
 
 /**
  * dnf_find_pkg_from_name:
  **/
 static DnfPackage *
-dnf_find_pkg_from_name(GPtrArray *array, const gchar *pkgname)
+dnf_find_pkg_from_name(DnfTransactionPkgIndex *index, const gchar *pkgname)
 {
-    guint i;
-
-    /* find in array */
-    for (i = 0; i < array->len; i++) {
-        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(array, i));
-        if (g_strcmp0(dnf_package_get_name(pkg), pkgname) == 0)
-            return pkg;
-    }
-    return NULL;
+    if (index == NULL || pkgname == NULL)
+        return NULL;
+    return static_cast< DnfPackage * >(g_hash_table_lookup(index->by_name, pkgname));
 }
 
 static void
@@ -484,11 +751,7 @@ _swdb_transaction_item_progress(libdnf::Swdb *swdb, DnfPackage *pkg)
     if (pkg == NULL) {
         return;
     }
-    const char *nevra = dnf_package_get_nevra(pkg);
-    if (nevra == NULL) {
-        return;
-    }
-    swdb->setItemDone(nevra);
+    swdb->setItemDone(dnf_package_get_nevra(pkg));
 }
 
 /**
@@ -549,7 +812,7 @@ dnf_transaction_ts_progress_cb(const void *arg,
         case RPMCALLBACK_INST_START:
 
             /* find pkg */
-            pkg = dnf_find_pkg_from_filename_suffix(priv->install, filename);
+            pkg = dnf_find_pkg_from_filename_suffix(priv->install_index, filename);
             if (pkg == NULL)
                 g_assert_not_reached();
 
@@ -578,14 +841,14 @@ dnf_transaction_ts_progress_cb(const void *arg,
         case RPMCALLBACK_UNINST_START:
 
             /* find pkg */
-            pkg = dnf_find_pkg_from_header(priv->remove, hdr);
+            pkg = dnf_find_pkg_from_header(priv->remove_index, hdr);
             if (pkg == NULL && filename != NULL) {
-                pkg = dnf_find_pkg_from_filename_suffix(priv->remove, filename);
+                pkg = dnf_find_pkg_from_filename_suffix(priv->remove_index, filename);
             }
             if (pkg == NULL && name != NULL)
-                pkg = dnf_find_pkg_from_name(priv->remove, name);
+                pkg = dnf_find_pkg_from_name(priv->remove_index, name);
             if (pkg == NULL && name != NULL)
-                pkg = dnf_find_pkg_from_name(priv->remove_helper, name);
+                pkg = dnf_find_pkg_from_name(priv->remove_helper_index, name);
             if (pkg == NULL) {
                 g_warning("cannot find %s in uninst-start", name);
                 priv->step = DNF_TRANSACTION_STEP_WRITING;
@@ -626,9 +889,9 @@ dnf_transaction_ts_progress_cb(const void *arg,
                 dnf_state_set_percentage(priv->child, percentage);
 
             /* update UI */
-            pkg = dnf_find_pkg_from_header(priv->install, hdr);
+            pkg = dnf_find_pkg_from_header(priv->install_index, hdr);
             if (pkg == NULL) {
-                pkg = dnf_find_pkg_from_filename_suffix(priv->install, filename);
+                pkg = dnf_find_pkg_from_filename_suffix(priv->install_index, filename);
             }
             if (pkg == NULL) {
                 g_debug("cannot find %s(%s)", filename, name);
@@ -654,14 +917,14 @@ dnf_transaction_ts_progress_cb(const void *arg,
                 dnf_state_set_percentage(priv->child, percentage);
 
             /* update UI */
-            pkg = dnf_find_pkg_from_header(priv->remove, hdr);
+            pkg = dnf_find_pkg_from_header(priv->remove_index, hdr);
             if (pkg == NULL && filename != NULL) {
-                pkg = dnf_find_pkg_from_filename_suffix(priv->remove, filename);
+                pkg = dnf_find_pkg_from_filename_suffix(priv->remove_index, filename);
             }
             if (pkg == NULL && name != NULL)
-                pkg = dnf_find_pkg_from_name(priv->remove, name);
+                pkg = dnf_find_pkg_from_name(priv->remove_index, name);
             if (pkg == NULL && name != NULL)
-                pkg = dnf_find_pkg_from_name(priv->remove_helper, name);
+                pkg = dnf_find_pkg_from_name(priv->remove_helper_index, name);
             if (pkg == NULL) {
                 g_warning("cannot find %s in uninst-progress", name);
                 break;
@@ -693,9 +956,9 @@ dnf_transaction_ts_progress_cb(const void *arg,
             break;
 
         case RPMCALLBACK_INST_STOP:
-            pkg = dnf_find_pkg_from_header(priv->install, hdr);
+            pkg = dnf_find_pkg_from_header(priv->install_index, hdr);
             if (pkg == NULL && filename != NULL) {
-                pkg = dnf_find_pkg_from_filename_suffix(priv->install, filename);
+                pkg = dnf_find_pkg_from_filename_suffix(priv->install_index, filename);
             }
 
             // transaction item install complete
@@ -710,15 +973,15 @@ dnf_transaction_ts_progress_cb(const void *arg,
 
         case RPMCALLBACK_UNINST_STOP:
 
-            pkg = dnf_find_pkg_from_header(priv->remove, hdr);
+            pkg = dnf_find_pkg_from_header(priv->remove_index, hdr);
             if (pkg == NULL && filename != NULL) {
-                pkg = dnf_find_pkg_from_filename_suffix(priv->remove, filename);
+                pkg = dnf_find_pkg_from_filename_suffix(priv->remove_index, filename);
             }
             if (pkg == NULL && name != NULL) {
-                pkg = dnf_find_pkg_from_name(priv->remove, name);
+                pkg = dnf_find_pkg_from_name(priv->remove_index, name);
             }
             if (pkg == NULL && name != NULL) {
-                pkg = dnf_find_pkg_from_name(priv->remove_helper, name);
+                pkg = dnf_find_pkg_from_name(priv->remove_helper_index, name);
             }
 
             // transaction item remove complete
@@ -835,15 +1098,162 @@ _history_write_item(DnfPackage *pkg, libdnf::Swdb *swdb, libdnf::TransactionItem
         std::dynamic_pointer_cast< libdnf::Item >(rpm), dnf_package_get_reponame(pkg), action, reason);
 }
 
+/**
+ * dnf_transaction_space_lookup:
+ *
+ * Finds the filesystem holding @dirname below @root, or its closest
+ * parent which exists. Mount points are looked for in the first two
+ * path components only, e.g. /usr/share, and the results are cached
+ * in @prefixes.
+ *
+ * Returns: the entry of the filesystem in @space, or %NULL
+ **/
+static DnfTransactionSpace *
+dnf_transaction_space_lookup(GPtrArray *space,
+                             GHashTable *prefixes,
+                             const gchar *root,
+                             const gchar *dirname)
+{
+    const gchar *end = dirname;
+    DnfTransactionSpace *entry = NULL;
+    GStatBuf st;
+    g_autofree gchar *prefix = NULL;
+    g_autofree gchar *path = NULL;
+
+    for (guint i = 0; i < 2 && end != NULL; i++)
+        end = strchr(end + 1, '/');
+    prefix = end != NULL ? g_strndup(dirname, end - dirname) : g_strdup(dirname);
+    entry = static_cast< DnfTransactionSpace * >(g_hash_table_lookup(prefixes, prefix));
+    if (entry != NULL)
+        return entry;
+
+    path = g_build_filename(root, prefix, NULL);
+    while (g_stat(path, &st) != 0) {
+        gchar *parent = g_path_get_dirname(path);
+        if (g_strcmp0(parent, path) == 0) {
+            g_free(parent);
+            return NULL;
+        }
+        g_free(path);
+        path = parent;
+    }
+    for (guint i = 0; i < space->len && entry == NULL; i++) {
+        auto tmp = static_cast< DnfTransactionSpace * >(g_ptr_array_index(space, i));
+        if (tmp->dev == st.st_dev)
+            entry = tmp;
+    }
+    if (entry == NULL) {
+        entry = g_slice_new0(DnfTransactionSpace);
+        entry->path = static_cast< gchar * >(g_steal_pointer(&path));
+        entry->dev = st.st_dev;
+        g_ptr_array_add(space, entry);
+    }
+    g_hash_table_insert(prefixes, g_steal_pointer(&prefix), entry);
+    return entry;
+}
+
+/**
+ * dnf_transaction_space_add_package:
+ *
+ * Accounts the installed size of @pkg, or frees it if @sign is -1, on
+ * the filesystems holding its files. The file lists don't carry file
+ * sizes, so the size is split by the number of files on each of them.
+ * Without a file list the whole size goes to the filesystem of /usr,
+ * where most of the packaged files live.
+ **/
+void
+dnf_transaction_space_add_package(GPtrArray *space,
+                                  GHashTable *prefixes,
+                                  const gchar *root,
+                                  DnfPackage *pkg,
+                                  gint sign,
+                                  gboolean use_files)
+{
+    auto size = static_cast< gint64 >(dnf_package_get_installsize(pkg)) * sign;
+    guint nfiles = 0;
+    gpointer key;
+    gpointer value;
+    GHashTableIter iter;
+    g_auto(GStrv) files = NULL;
+    g_autoptr(GHashTable) counts = NULL;
+
+    if (use_files) {
+        files = dnf_package_get_files(pkg);
+        nfiles = g_strv_length(files);
+    }
+    if (nfiles == 0) {
+        auto entry = dnf_transaction_space_lookup(space, prefixes, root, "/usr");
+        if (entry != NULL)
+            entry->needed += size;
+        return;
+    }
+
+    counts = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for (guint i = 0; i < nfiles; i++) {
+        g_autofree gchar *dirname = g_path_get_dirname(files[i]);
+        auto entry = dnf_transaction_space_lookup(space, prefixes, root, dirname);
+        if (entry == NULL)
+            continue;
+        auto count = GPOINTER_TO_UINT(g_hash_table_lookup(counts, entry));
+        g_hash_table_insert(counts, entry, GUINT_TO_POINTER(count + 1));
+    }
+    g_hash_table_iter_init(&iter, counts);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        auto entry = static_cast< DnfTransactionSpace * >(key);
+        entry->needed += size * GPOINTER_TO_UINT(value) / nfiles;
+    }
+}
+
+/**
+ * dnf_transaction_plan_space:
+ *
+ * Computes the space the packages installed and removed by @goal need
+ * on each filesystem of the install root, so all of them are checked
+ * before anything is downloaded rather than rpm running out of space in
+ * the middle of the transaction. Installed packages always have their
+ * file lists, the others only when filelists are enabled.
+ **/
+static void
+dnf_transaction_plan_space(DnfTransaction *transaction, HyGoal goal, GPtrArray *install)
+{
+    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    const gchar *root = dnf_context_get_install_root(priv->context);
+    gboolean filelists = dnf_context_get_enable_filelists(priv->context);
+    g_autoptr(GHashTable) prefixes = NULL;
+
+    g_ptr_array_set_size(priv->space, 0);
+    if (!dnf_context_get_check_disk_space(priv->context))
+        return;
+
+    prefixes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    auto removed = goal->listErasures();
+    for (guint i = 0; i < install->len; i++) {
+        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(install, i));
+        dnf_transaction_space_add_package(priv->space, prefixes, root, pkg, 1, filelists);
+        removed += goal->listObsoletedByPackage(pkg);
+    }
+    Id id = -1;
+    while ((id = removed.next(id)) != -1) {
+        g_autoptr(DnfPackage) pkg = dnf_package_new(removed.getSack(), id);
+        dnf_transaction_space_add_package(priv->space, prefixes, root, pkg, -1, TRUE);
+    }
+}
+
+/**
+ * dnf_transaction_check_free_space:
+ *
+ * Checks the filesystems of the package cache and of the install root
+ * have enough free space for the downloads and the planned transaction.
+ **/
 static gboolean
 dnf_transaction_check_free_space(DnfTransaction *transaction, GError **error)
 {
     DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
     const gchar *cachedir;
     guint64 download_size;
-    guint64 free_space;
-    g_autoptr(GFile) file = NULL;
-    g_autoptr(GFileInfo) filesystem_info = NULL;
+    DnfTransactionSpace *entry;
+    g_autoptr(GHashTable) prefixes = NULL;
+    g_autoptr(GPtrArray) space = NULL;
 
     download_size = dnf_package_array_get_download_size(priv->pkgs_to_download);
 
@@ -856,15 +1266,17 @@ dnf_transaction_check_free_space(DnfTransaction *transaction, GError **error)
         return FALSE;
     }
 
-    file = g_file_new_for_path(cachedir);
-    filesystem_info =
-        g_file_query_filesystem_info(file, G_FILE_ATTRIBUTE_FILESYSTEM_FREE, NULL, error);
-    if (filesystem_info == NULL) {
-        g_prefix_error(error, _("Failed to get filesystem free size for %s: "), cachedir);
-        return FALSE;
+    /* the downloads are kept until the transaction is done */
+    space = dnf_transaction_space_new();
+    for (guint i = 0; i < priv->space->len; i++) {
+        auto planned = static_cast< DnfTransactionSpace * >(g_ptr_array_index(priv->space, i));
+        entry = g_slice_dup(DnfTransactionSpace, planned);
+        entry->path = g_strdup(planned->path);
+        g_ptr_array_add(space, entry);
     }
-
-    if (!g_file_info_has_attribute(filesystem_info, G_FILE_ATTRIBUTE_FILESYSTEM_FREE)) {
+    prefixes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    entry = dnf_transaction_space_lookup(space, prefixes, "/", cachedir);
+    if (entry == NULL) {
         g_set_error(error,
                     DNF_ERROR,
                     DNF_ERROR_FAILED,
@@ -872,28 +1284,434 @@ dnf_transaction_check_free_space(DnfTransaction *transaction, GError **error)
                     cachedir);
         return FALSE;
     }
+    entry->needed += download_size;
 
-    free_space =
-        g_file_info_get_attribute_uint64(filesystem_info, G_FILE_ATTRIBUTE_FILESYSTEM_FREE);
-    if (free_space < download_size) {
-        g_autofree gchar *formatted_download_size = NULL;
+    return dnf_transaction_space_check(space, error);
+}
+
+/**
+ * dnf_transaction_space_check:
+ *
+ * Checks each filesystem in @space has the free space it needs. All the
+ * filesystems short of space are reported in one error.
+ **/
+gboolean
+dnf_transaction_space_check(GPtrArray *space, GError **error)
+{
+    DnfTransactionSpace *entry;
+    g_autoptr(GString) problems = NULL;
+
+    /* report all the filesystems at once */
+    problems = g_string_new(NULL);
+    for (guint i = 0; i < space->len; i++) {
+        guint64 free_space;
+        g_autoptr(GFile) file = NULL;
+        g_autoptr(GFileInfo) filesystem_info = NULL;
+        g_autofree gchar *formatted_needed_size = NULL;
         g_autofree gchar *formatted_free_size = NULL;
 
-        formatted_download_size = g_format_size(download_size);
+        entry = static_cast< DnfTransactionSpace * >(g_ptr_array_index(space, i));
+        if (entry->needed <= 0)
+            continue;
+
+        file = g_file_new_for_path(entry->path);
+        filesystem_info =
+            g_file_query_filesystem_info(file, G_FILE_ATTRIBUTE_FILESYSTEM_FREE, NULL, error);
+        if (filesystem_info == NULL) {
+            g_prefix_error(error, _("Failed to get filesystem free size for %s: "), entry->path);
+            return FALSE;
+        }
+
+        if (!g_file_info_has_attribute(filesystem_info, G_FILE_ATTRIBUTE_FILESYSTEM_FREE)) {
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_FAILED,
+                        _("Failed to get filesystem free size for %s"),
+                        entry->path);
+            return FALSE;
+        }
+
+        free_space =
+            g_file_info_get_attribute_uint64(filesystem_info, G_FILE_ATTRIBUTE_FILESYSTEM_FREE);
+        if (free_space >= static_cast< guint64 >(entry->needed))
+            continue;
+
+        formatted_needed_size = g_format_size(entry->needed);
         formatted_free_size = g_format_size(free_space);
-        g_set_error(error,
-                    DNF_ERROR,
-                    DNF_ERROR_NO_SPACE,
-                    _("Not enough free space in %1$s: needed %2$s, available %3$s"),
-                    cachedir,
-                    formatted_download_size,
-                    formatted_free_size);
+        if (problems->len > 0)
+            g_string_append(problems, "; ");
+        g_string_append_printf(problems,
+                               _("Not enough free space in %1$s: needed %2$s, available %3$s"),
+                               entry->path,
+                               formatted_needed_size,
+                               formatted_free_size);
+    }
+    if (problems->len > 0) {
+        g_set_error_literal(error, DNF_ERROR, DNF_ERROR_NO_SPACE, problems->str);
         return FALSE;
     }
 
     return TRUE;
 }
 
+/**
+ * dnf_transaction_verify_func:
+ *
+ * Worker verifying a downloaded package: checks its signature and reads
+ * the header for the rpm transaction, so dnf_transaction_commit() doesn't
+ * need to read the file again.
+ **/
+static void
+dnf_transaction_verify_func(gpointer data, gpointer user_data)
+{
+    auto job = static_cast< DnfTransactionVerifyJob * >(data);
+    auto transaction = static_cast< DnfTransaction * >(user_data);
+    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    auto verified = g_slice_new0(DnfTransactionVerified);
+
+    verified->filename = job->filename;
+    if (dnf_transaction_gpgcheck_file(
+            transaction, job->repo, job->filename, job->nevra, &verified->error)) {
+        /* same keyring and verify flags as the transaction uses */
+        rpmts ts = rpmtsCreate();
+        rpmtsSetKeyring(ts, priv->keyring);
+        rpmtsSetVSFlags(ts, rpmtsVSFlags(priv->ts));
+        FD_t fd = Fopen(job->filename, "r.ufdio");
+        verified->rc = rpmReadPackageFile(ts, fd, job->filename, &verified->hdr);
+        Fclose(fd);
+        rpmtsFree(ts);
+    }
+
+    g_mutex_lock(&priv->verified_mutex);
+    g_hash_table_insert(priv->verified, GINT_TO_POINTER(job->id), verified);
+    g_mutex_unlock(&priv->verified_mutex);
+
+    g_free(job->nevra);
+    g_slice_free(DnfTransactionVerifyJob, job);
+}
+
+/**
+ * dnf_transaction_package_downloaded_cb:
+ *
+ * Hands a package over to the verification workers as soon as its
+ * download is complete.
+ **/
+static void
+dnf_transaction_package_downloaded_cb(DnfPackage *pkg, gpointer user_data)
+{
+    auto pool = static_cast< GThreadPool * >(user_data);
+    auto job = g_slice_new0(DnfTransactionVerifyJob);
+
+    /* the package is only accessed from this thread */
+    job->repo = dnf_package_get_repo(pkg);
+    job->id = dnf_package_get_id(pkg);
+    job->filename = g_strdup(dnf_package_get_filename(pkg));
+    job->nevra = g_strdup(dnf_package_get_nevra(pkg));
+    g_thread_pool_push(pool, job, NULL);
+}
+
+#define DNF_TRANSACTION_APPLYDELTARPM "/usr/bin/applydeltarpm"
+
+typedef struct {
+    GHashTable *deltas;  /* DnfPackage → DnfPackageDelta */
+    GThreadPool *pool;
+    GHashTable *rebuilt; /* DnfPackage set */
+    GMutex mutex;
+} DnfTransactionRebuild;
+
+typedef struct {
+    DnfPackage *pkg;
+    gchar *delta_filename;
+    gchar *filename;
+} DnfTransactionRebuildJob;
+
+/**
+ * dnf_transaction_use_deltas:
+ **/
+static gboolean
+dnf_transaction_use_deltas(DnfTransaction *transaction)
+{
+    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+
+    if (!dnf_context_get_enable_deltarpm(priv->context))
+        return FALSE;
+
+    /* applydeltarpm rebuilds the package from the installed files */
+    if (g_strcmp0(dnf_context_get_install_root(priv->context), "/") != 0)
+        return FALSE;
+    if (!g_file_test(DNF_TRANSACTION_APPLYDELTARPM, G_FILE_TEST_IS_EXECUTABLE)) {
+        g_debug("%s not found, not using deltas", DNF_TRANSACTION_APPLYDELTARPM);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* a delta is only used if it's smaller than the package */
+#define DNF_TRANSACTION_DELTA_PERCENTAGE 100
+
+/**
+ * dnf_transaction_find_delta:
+ *
+ * Returns a delta from an installed version of the package if its size
+ * is below @percentage % of the size of the package, or %NULL.
+ **/
+DnfPackageDelta *
+dnf_transaction_find_delta(DnfSack *sack, DnfPackage *pkg, guint percentage)
+{
+    hy_autoquery HyQuery query = NULL;
+    g_autoptr(GPtrArray) installed = NULL;
+
+    query = hy_query_create(sack);
+    hy_query_filter(query, HY_PKG_REPONAME, HY_EQ, HY_SYSTEM_REPO_NAME);
+    hy_query_filter(query, HY_PKG_NAME, HY_EQ, dnf_package_get_name(pkg));
+    hy_query_filter(query, HY_PKG_ARCH, HY_EQ, dnf_package_get_arch(pkg));
+    installed = hy_query_run(query);
+    for (guint i = 0; i < installed->len; i++) {
+        auto pkg_installed = static_cast< DnfPackage * >(g_ptr_array_index(installed, i));
+        DnfPackageDelta *delta;
+
+        delta = dnf_package_get_delta_from_evr(pkg, dnf_package_get_evr(pkg_installed));
+        if (delta == NULL)
+            continue;
+        if (dnf_packagedelta_get_downloadsize(delta) * 100 <
+            dnf_package_get_downloadsize(pkg) * percentage)
+            return delta;
+        g_object_unref(delta);
+    }
+    return NULL;
+}
+
+/**
+ * dnf_transaction_rebuild_func:
+ *
+ * Worker rebuilding a package from its downloaded delta.
+ **/
+static void
+dnf_transaction_rebuild_func(gpointer data, gpointer user_data)
+{
+    auto job = static_cast< DnfTransactionRebuildJob * >(data);
+    auto rebuild = static_cast< DnfTransactionRebuild * >(user_data);
+    gint exit_status = 0;
+    g_autofree gchar *filename_tmp = g_strconcat(job->filename, ".tmp", NULL);
+    g_autofree gchar *standard_error = NULL;
+    g_autoptr(GError) error_local = NULL;
+    const gchar *argv[] = { DNF_TRANSACTION_APPLYDELTARPM,
+                            job->delta_filename,
+                            filename_tmp,
+                            NULL };
+
+    if (!g_spawn_sync(NULL,
+                      (gchar **)argv,
+                      NULL,
+                      G_SPAWN_STDOUT_TO_DEV_NULL,
+                      NULL,
+                      NULL,
+                      NULL,
+                      &standard_error,
+                      &exit_status,
+                      &error_local) ||
+        !g_spawn_check_exit_status(exit_status, &error_local)) {
+        g_warning("failed to rebuild %s from %s: %s %s",
+                  job->filename, job->delta_filename, error_local->message,
+                  standard_error != NULL ? standard_error : "");
+        g_unlink(filename_tmp);
+    } else if (g_rename(filename_tmp, job->filename) != 0) {
+        g_warning("failed to rename %s: %s", filename_tmp, g_strerror(errno));
+        g_unlink(filename_tmp);
+    } else {
+        g_mutex_lock(&rebuild->mutex);
+        g_hash_table_add(rebuild->rebuilt, job->pkg);
+        g_mutex_unlock(&rebuild->mutex);
+    }
+
+    g_unlink(job->delta_filename);
+    g_free(job->delta_filename);
+    g_free(job->filename);
+    g_slice_free(DnfTransactionRebuildJob, job);
+}
+
+/**
+ * dnf_transaction_delta_downloaded_cb:
+ **/
+static void
+dnf_transaction_delta_downloaded_cb(DnfPackage *pkg, gpointer user_data)
+{
+    auto rebuild = static_cast< DnfTransactionRebuild * >(user_data);
+    auto delta = static_cast< DnfPackageDelta * >(g_hash_table_lookup(rebuild->deltas, pkg));
+    auto job = g_slice_new0(DnfTransactionRebuildJob);
+    g_autofree gchar *basename = g_path_get_basename(dnf_packagedelta_get_location(delta));
+
+    job->pkg = pkg;
+    job->delta_filename =
+        g_build_filename(dnf_repo_get_packages(dnf_package_get_repo(pkg)), basename, NULL);
+    job->filename = g_strdup(dnf_package_get_filename(pkg));
+    g_thread_pool_push(rebuild->pool, job, NULL);
+}
+
+/**
+ * dnf_transaction_download_deltas:
+ *
+ * Downloads the deltas smaller than their packages and rebuilds the
+ * packages from them in a thread per processor, while the other deltas
+ * are still being downloaded.
+ *
+ * Returns: (transfer container): the packages to download in full,
+ * including the ones which could not be rebuilt, or %NULL for error
+ **/
+static GPtrArray *
+dnf_transaction_download_deltas(DnfTransaction *transaction, DnfState *state, GError **error)
+{
+    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    DnfState *state_local;
+    DnfTransactionRebuild rebuild = { NULL, };
+    gboolean ret;
+    g_autoptr(GPtrArray) delta_packages = g_ptr_array_new();
+    g_autoptr(GPtrArray) packages = NULL;
+    g_autoptr(GHashTable) deltas = NULL;
+
+    packages = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+    deltas = g_hash_table_new_full(NULL, NULL, NULL, (GDestroyNotify)g_object_unref);
+    for (guint i = 0; i < priv->pkgs_to_download->len; i++) {
+        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(priv->pkgs_to_download, i));
+        DnfPackageDelta *delta = dnf_transaction_find_delta(dnf_context_get_sack(priv->context),
+                                                            pkg,
+                                                            DNF_TRANSACTION_DELTA_PERCENTAGE);
+        if (delta == NULL) {
+            g_ptr_array_add(packages, g_object_ref(pkg));
+            continue;
+        }
+        g_hash_table_insert(deltas, pkg, delta);
+        g_ptr_array_add(delta_packages, pkg);
+    }
+    if (delta_packages->len == 0) {
+        if (!dnf_state_finished(state, error))
+            return NULL;
+        return static_cast< GPtrArray * >(g_steal_pointer(&packages));
+    }
+
+    rebuild.pool = g_thread_pool_new(dnf_transaction_rebuild_func,
+                                     &rebuild,
+                                     g_get_num_processors(),
+                                     FALSE,
+                                     error);
+    if (rebuild.pool == NULL)
+        return NULL;
+    rebuild.deltas = deltas;
+    rebuild.rebuilt = g_hash_table_new(g_direct_hash, g_direct_equal);
+    g_mutex_init(&rebuild.mutex);
+
+    dnf_state_set_number_steps(state, 1);
+    state_local = dnf_state_get_child(state);
+    ret = dnf_repo_download_packages_full(delta_packages,
+                                          NULL,
+                                          deltas,
+                                          dnf_transaction_delta_downloaded_cb,
+                                          &rebuild,
+                                          state_local,
+                                          error);
+
+    /* wait for the packages which are still being rebuilt */
+    g_thread_pool_free(rebuild.pool, FALSE, TRUE);
+
+    /* fall back to the full package */
+    for (guint i = 0; i < delta_packages->len; i++) {
+        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(delta_packages, i));
+        if (g_hash_table_contains(rebuild.rebuilt, pkg))
+            continue;
+        g_debug("downloading %s in full", dnf_package_get_nevra(pkg));
+        g_ptr_array_add(packages, g_object_ref(pkg));
+    }
+    g_hash_table_unref(rebuild.rebuilt);
+    g_mutex_clear(&rebuild.mutex);
+    if (!ret)
+        return NULL;
+
+    if (!dnf_state_done(state, error))
+        return NULL;
+    return static_cast< GPtrArray * >(g_steal_pointer(&packages));
+}
+
+/**
+ * dnf_transaction_download_packages:
+ **/
+static gboolean
+dnf_transaction_download_packages(DnfTransaction *transaction,
+                                  GPtrArray *packages,
+                                  DnfState *state,
+                                  GError **error)
+{
+    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    DnfState *state_local;
+    GThreadPool *pool;
+    gboolean ret;
+
+    if (packages->len == 0)
+        return dnf_state_finished(state, error);
+
+    /* just download the list */
+    if ((priv->flags & DNF_TRANSACTION_FLAG_PIPELINE) == 0)
+        return dnf_package_array_download(packages, NULL, state, error);
+
+    /* the keys are needed to verify the packages as they arrive */
+    if (!dnf_transaction_import_keys(transaction, error))
+        return FALSE;
+
+    pool = g_thread_pool_new(dnf_transaction_verify_func,
+                             transaction,
+                             g_get_num_processors(),
+                             FALSE,
+                             error);
+    if (pool == NULL)
+        return FALSE;
+
+    dnf_state_set_number_steps(state, 1);
+    state_local = dnf_state_get_child(state);
+    ret = dnf_repo_download_packages_full(packages,
+                                          NULL,
+                                          NULL,
+                                          dnf_transaction_package_downloaded_cb,
+                                          pool,
+                                          state_local,
+                                          error);
+
+    /* wait for the packages which are still being verified */
+    g_thread_pool_free(pool, FALSE, TRUE);
+    if (!ret)
+        return FALSE;
+
+    return dnf_state_done(state, error);
+}
+
+/**
+ * dnf_transaction_publish_packages:
+ *
+ * Adds the downloaded packages to the package store, if any, and keeps
+ * the store within its size limit. The store is only a cache, so any
+ * failure here doesn't fail the transaction.
+ **/
+static void
+dnf_transaction_publish_packages(DnfTransaction *transaction)
+{
+    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    const gchar *store_dir = dnf_context_get_package_store_dir(priv->context);
+    guint64 store_size = dnf_context_get_package_store_size(priv->context);
+
+    if (store_dir == NULL)
+        return;
+    for (guint i = 0; i < priv->pkgs_to_download->len; i++) {
+        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(priv->pkgs_to_download, i));
+        g_autoptr(GError) error_local = NULL;
+        if (!dnf_package_store_publish(store_dir, pkg, &error_local))
+            g_warning("failed to add %s to the package store: %s",
+                      dnf_package_get_nevra(pkg), error_local->message);
+    }
+    if (store_size > 0) {
+        g_autoptr(GError) error_local = NULL;
+        if (!dnf_package_store_evict(store_dir, store_size, &error_local))
+            g_warning("failed to evict from the package store: %s", error_local->message);
+    }
+}
+
 /**
  * dnf_transaction_download:
  * @transaction: a #DnfTransaction instance.
@@ -910,13 +1728,39 @@ gboolean
 dnf_transaction_download(DnfTransaction *transaction, DnfState *state, GError **error)
 {
     DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    DnfState *state_local;
+    g_autoptr(GPtrArray) packages = NULL;
 
     /* check that we have enough free space */
     if (!dnf_transaction_check_free_space(transaction, error))
         return FALSE;
 
     /* just download the list */
-    return dnf_package_array_download(priv->pkgs_to_download, NULL, state, error);
+    if (!dnf_transaction_use_deltas(transaction)) {
+        if (!dnf_transaction_download_packages(transaction, priv->pkgs_to_download, state, error))
+            return FALSE;
+        dnf_transaction_publish_packages(transaction);
+        return TRUE;
+    }
+
+    dnf_state_set_number_steps(state, 2);
+
+    /* rebuild what we can from deltas */
+    state_local = dnf_state_get_child(state);
+    packages = dnf_transaction_download_deltas(transaction, state_local, error);
+    if (packages == NULL)
+        return FALSE;
+    if (!dnf_state_done(state, error))
+        return FALSE;
+
+    /* download the rest in full */
+    state_local = dnf_state_get_child(state);
+    if (!dnf_transaction_download_packages(transaction, packages, state_local, error))
+        return FALSE;
+    if (!dnf_state_done(state, error))
+        return FALSE;
+    dnf_transaction_publish_packages(transaction);
+    return TRUE;
 }
 
 /**
@@ -936,6 +1780,7 @@ gboolean
 dnf_transaction_depsolve(DnfTransaction *transaction, HyGoal goal, DnfState *state, GError **error)
 {
     DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    const gchar *store_dir = dnf_context_get_package_store_dir(priv->context);
     gboolean valid;
     g_autoptr(GPtrArray) packages = NULL;
 
@@ -945,6 +1790,7 @@ dnf_transaction_depsolve(DnfTransaction *transaction, HyGoal goal, DnfState *sta
 
     /* find a list of all the packages we have to download */
     g_ptr_array_set_size(priv->pkgs_to_download, 0);
+    g_hash_table_remove_all(priv->verified);
     packages = dnf_goal_get_packages(goal,
                                      DNF_PACKAGE_INFO_INSTALL,
                                      DNF_PACKAGE_INFO_REINSTALL,
@@ -968,11 +1814,18 @@ dnf_transaction_depsolve(DnfTransaction *transaction, HyGoal goal, DnfState *sta
         if (!dnf_package_check_filename(pkg, &valid, error))
             return FALSE;
 
+        /* another repo cache may have downloaded it already */
+        if (!valid && store_dir != NULL)
+            valid = dnf_package_store_checkout(store_dir, pkg);
+
         /* package needs to be downloaded */
         if (!valid) {
             g_ptr_array_add(priv->pkgs_to_download, g_object_ref(pkg));
         }
     }
+
+    /* how much space the transaction needs where */
+    dnf_transaction_plan_space(transaction, goal, packages);
     return TRUE;
 }
 
@@ -987,10 +1840,18 @@ dnf_transaction_reset(DnfTransaction *transaction)
     /* reset */
     priv->child = NULL;
     g_ptr_array_set_size(priv->pkgs_to_download, 0);
+    g_hash_table_remove_all(priv->verified);
+    g_ptr_array_set_size(priv->space, 0);
     rpmtsEmpty(priv->ts);
     rpmtsSetNotifyCallback(priv->ts, NULL, NULL);
 
     /* clear */
+    dnf_transaction_pkg_index_free(priv->install_index);
+    priv->install_index = NULL;
+    dnf_transaction_pkg_index_free(priv->remove_index);
+    priv->remove_index = NULL;
+    dnf_transaction_pkg_index_free(priv->remove_helper_index);
+    priv->remove_helper_index = NULL;
     if (priv->install != NULL) {
         g_ptr_array_unref(priv->install);
         priv->install = NULL;
@@ -1047,6 +1908,190 @@ dnf_transaction_import_keys(DnfTransaction *transaction, GError **error)
     return TRUE;
 }
 
+static void
+dnf_transaction_obsolete_clear(DnfTransactionObsolete *obsolete)
+{
+    g_object_unref(obsolete->pkg);
+}
+
+/**
+ * dnf_transaction_list_obsoletes:
+ *
+ * Lists the installed packages replaced by the updated, downgraded and
+ * reinstalled packages of @install, in the order of @install. The goal
+ * is asked once for each package, the result is shared by all the
+ * passes of dnf_transaction_commit().
+ **/
+GArray *
+dnf_transaction_list_obsoletes(HyGoal goal, GPtrArray *install)
+{
+    auto obsoletes = g_array_new(FALSE, FALSE, sizeof(DnfTransactionObsolete));
+    g_array_set_clear_func(obsoletes, (GDestroyNotify)dnf_transaction_obsolete_clear);
+    if (install->len == 0)
+        return obsoletes;
+
+    auto all_obsoleted = goal->listObsoleted();
+    for (guint i = 0; i < install->len; i++) {
+        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(install, i));
+        auto action = dnf_package_get_action(pkg);
+        if (action != DNF_STATE_ACTION_UPDATE &&
+            action != DNF_STATE_ACTION_DOWNGRADE &&
+            action != DNF_STATE_ACTION_REINSTALL)
+            continue;
+
+        auto pset = goal->listObsoletedByPackage(pkg);
+        Id id = -1;
+        while ((id = pset.next(id)) != -1) {
+            DnfTransactionObsolete obsolete;
+            obsolete.obsoleter = pkg;
+            obsolete.pkg = dnf_package_new(pset.getSack(), id);
+            obsolete.obsoleted = all_obsoleted.has(id);
+            obsolete.action = libdnf::TransactionItemAction::OBSOLETED;
+            if (g_strcmp0(dnf_package_get_name(pkg), dnf_package_get_name(obsolete.pkg)) == 0) {
+                // names are identical - package is upgraded/downgraded
+                if (dnf_package_evr_cmp(pkg, obsolete.pkg)) {
+                    obsolete.action = libdnf::TransactionItemAction::UPGRADED;
+                } else {
+                    obsolete.action = libdnf::TransactionItemAction::DOWNGRADED;
+                }
+            }
+            g_array_append_val(obsoletes, obsolete);
+        }
+    }
+    return obsoletes;
+}
+
+static gint
+dnf_transaction_strcmp(gconstpointer a, gconstpointer b)
+{
+    return g_strcmp0(*static_cast< const gchar * const * >(a),
+                     *static_cast< const gchar * const * >(b));
+}
+
+/**
+ * dnf_transaction_get_test_key:
+ *
+ * Identifies the transaction for the test commit cache by the checksums
+ * of the package files to install, the packages to remove, the options
+ * changing the problems rpm reports or whether rpmtsCheck() runs, and
+ * the state of the rpmdb.
+ *
+ * Returns: the key, or %NULL if the transaction can't be identified
+ **/
+gchar *
+dnf_transaction_get_test_key(DnfContext *context,
+                             guint64 transaction_flags,
+                             GPtrArray *install,
+                             GPtrArray *remove,
+                             GPtrArray *remove_helper)
+{
+    DnfSack *sack = dnf_context_get_sack(context);
+    unsigned char rpmdb_checksum[CHKSUM_BYTES];
+    guint64 flags;
+    GPtrArray *removed[] = { remove, remove_helper };
+    g_autofree gchar *options = NULL;
+    g_autoptr(GChecksum) checksum = NULL;
+    g_autoptr(GPtrArray) items = NULL;
+
+    if (sack == NULL || dnf_sack_get_rpmdb_checksum(sack, rpmdb_checksum) != 0)
+        return NULL;
+
+    items = g_ptr_array_new_with_free_func(g_free);
+    for (guint i = 0; i < install->len; i++) {
+        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(install, i));
+        const unsigned char *chksum;
+        int chksum_type;
+        g_autofree gchar *chksum_str = NULL;
+
+        chksum = dnf_package_get_chksum(pkg, &chksum_type);
+        if (chksum == NULL)
+            return NULL;
+        chksum_str = hy_chksum_str(chksum, chksum_type);
+        g_ptr_array_add(items,
+                        g_strdup_printf("install %s:%s", hy_chksum_name(chksum_type), chksum_str));
+    }
+    for (guint j = 0; j < G_N_ELEMENTS(removed); j++) {
+        for (guint i = 0; removed[j] != NULL && i < removed[j]->len; i++) {
+            auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(removed[j], i));
+            g_ptr_array_add(items, g_strdup_printf("remove %s", dnf_package_get_package_id(pkg)));
+        }
+    }
+    g_ptr_array_sort(items, dnf_transaction_strcmp);
+
+    flags = transaction_flags & (DNF_TRANSACTION_FLAG_ALLOW_REINSTALL |
+                                 DNF_TRANSACTION_FLAG_ALLOW_DOWNGRADE |
+                                 DNF_TRANSACTION_FLAG_NODOCS);
+    options = g_strdup_printf("%s %" G_GUINT64_FORMAT " %i %i\n",
+                              dnf_context_get_install_root(context),
+                              flags,
+                              dnf_context_get_check_disk_space(context),
+                              dnf_context_get_check_transaction(context));
+    checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    g_checksum_update(checksum, rpmdb_checksum, CHKSUM_BYTES);
+    g_checksum_update(checksum, reinterpret_cast< const guchar * >(options), -1);
+    for (guint i = 0; i < items->len; i++) {
+        g_checksum_update(
+            checksum, static_cast< const guchar * >(g_ptr_array_index(items, i)), -1);
+        g_checksum_update(checksum, reinterpret_cast< const guchar * >("\n"), 1);
+    }
+    return g_strdup(g_checksum_get_string(checksum));
+}
+
+/**
+ * dnf_transaction_get_test_filename:
+ *
+ * Returns: the file holding the key of the last transaction tested
+ **/
+static gchar *
+dnf_transaction_get_test_filename(DnfContext *context)
+{
+    const gchar *cachedir = dnf_context_get_cache_dir(context);
+    if (cachedir == NULL)
+        return NULL;
+    return g_build_filename(cachedir, "transaction-test", NULL);
+}
+
+/**
+ * dnf_transaction_was_tested:
+ *
+ * Returns: %TRUE if the last successful transaction test was of a
+ * transaction with the key @test_key
+ **/
+gboolean
+dnf_transaction_was_tested(DnfContext *context, const gchar *test_key)
+{
+    g_autofree gchar *filename = dnf_transaction_get_test_filename(context);
+    g_autofree gchar *tested_key = NULL;
+
+    if (test_key == NULL || filename == NULL)
+        return FALSE;
+    if (!g_file_get_contents(filename, &tested_key, NULL, NULL))
+        return FALSE;
+    return g_strcmp0(g_strstrip(tested_key), test_key) == 0;
+}
+
+/**
+ * dnf_transaction_set_tested:
+ *
+ * Records a successful test of the transaction with the key @test_key,
+ * or forgets the last one if @test_key is %NULL.
+ **/
+void
+dnf_transaction_set_tested(DnfContext *context, const gchar *test_key)
+{
+    g_autofree gchar *filename = dnf_transaction_get_test_filename(context);
+    g_autoptr(GError) error_local = NULL;
+
+    if (filename == NULL)
+        return;
+    if (test_key == NULL) {
+        g_unlink(filename);
+        return;
+    }
+    if (!g_file_set_contents(filename, test_key, -1, &error_local))
+        g_debug("failed to save the transaction test: %s", error_local->message);
+}
+
 /**
  * dnf_transaction_commit:
  * @transaction: a #DnfTransaction instance.
@@ -1074,16 +2119,17 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
     gint verbosity;
     gint vs_flags;
     guint i;
-    guint j;
     DnfState *state_local;
-    GPtrArray *all_obsoleted;
-    GPtrArray *pkglist;
     DnfPackage *pkg;
     DnfPackage *pkg_tmp;
+    DnfTransactionVerified *verified;
+    gboolean tested = FALSE;
+    g_autoptr(GArray) obsoletes = NULL;
+    g_autofree gchar *test_key = NULL;
     rpmprobFilterFlags problems_filter = 0;
     rpmtransFlags rpmts_flags = RPMTRANS_FLAG_NONE;
     DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
-    libdnf::Swdb *swdb = priv->swdb;
+    libdnf::Swdb *swdb = dnf_transaction_ensure_swdb(transaction);
 
     /* take lock */
     ret = dnf_state_take_lock(state, DNF_LOCK_TYPE_RPMDB, DNF_LOCK_MODE_PROCESS, error);
@@ -1165,7 +2211,15 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
         filename = dnf_package_get_filename(pkg);
         allow_untrusted = (priv->flags & DNF_TRANSACTION_FLAG_ONLY_TRUSTED) == 0;
         is_update = action == DNF_STATE_ACTION_UPDATE || action == DNF_STATE_ACTION_DOWNGRADE;
-        ret = dnf_rpmts_add_install_filename(priv->ts, filename, allow_untrusted, is_update, error);
+        verified = dnf_transaction_get_verified(transaction, pkg, filename);
+        if (verified != NULL && verified->hdr != NULL) {
+            /* the header was read while downloading */
+            ret = dnf_rpmts_add_install_header(
+                priv->ts, verified->hdr, verified->rc, filename, allow_untrusted, is_update, error);
+        } else {
+            ret = dnf_rpmts_add_install_filename(
+                priv->ts, filename, allow_untrusted, is_update, error);
+        }
         if (!ret)
             goto out;
 
@@ -1194,8 +2248,10 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
         goto out;
 
     /* add things to remove */
+    priv->install_index = dnf_transaction_pkg_index_new(priv->install);
     priv->remove =
         dnf_goal_get_packages(goal, DNF_PACKAGE_INFO_OBSOLETE, DNF_PACKAGE_INFO_REMOVE, -1);
+    priv->remove_index = dnf_transaction_pkg_index_new(priv->remove);
     for (i = 0; i < priv->remove->len; i++) {
         pkg = static_cast< DnfPackage * >(g_ptr_array_index(priv->remove, i));
         ret = dnf_rpmts_add_remove_pkg(priv->ts, pkg, error);
@@ -1211,7 +2267,7 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
         libdnf::TransactionItemAction swdbAction = libdnf::TransactionItemAction::REMOVE;
 
         /* are the things being removed actually being upgraded */
-        pkg_tmp = dnf_find_pkg_from_name(priv->install, dnf_package_get_name(pkg));
+        pkg_tmp = dnf_find_pkg_from_name(priv->install_index, dnf_package_get_name(pkg));
         if (pkg_tmp != NULL) {
             dnf_package_set_action(pkg, DNF_STATE_ACTION_CLEANUP);
             if (dnf_package_evr_cmp(pkg, pkg_tmp)) {
@@ -1225,57 +2281,39 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
 
     /* add anything that gets obsoleted to a helper array which is used to
      * map removed packages auto-added by rpm to actual DnfPackage's */
+    obsoletes = dnf_transaction_list_obsoletes(goal, priv->install);
     priv->remove_helper = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-    for (i = 0; i < priv->install->len; i++) {
-        pkg = static_cast< DnfPackage * >(g_ptr_array_index(priv->install, i));
-        is_update = dnf_package_get_action(pkg) == DNF_STATE_ACTION_UPDATE ||
-                    dnf_package_get_action(pkg) == DNF_STATE_ACTION_DOWNGRADE;
-        if (!is_update)
+    for (i = 0; i < obsoletes->len; i++) {
+        auto obsolete = &g_array_index(obsoletes, DnfTransactionObsolete, i);
+        if (dnf_package_get_action(obsolete->obsoleter) == DNF_STATE_ACTION_REINSTALL)
             continue;
-        pkglist = hy_goal_list_obsoleted_by_package(goal, pkg);
+        pkg_tmp = obsolete->pkg;
+        g_ptr_array_add(priv->remove_helper, g_object_ref(pkg_tmp));
+        dnf_package_set_action(pkg_tmp, DNF_STATE_ACTION_CLEANUP);
 
-        const char *pkg_name = dnf_package_get_name(pkg);
+        const char *pkg_tmp_name = dnf_package_get_name(pkg_tmp);
 
-        for (j = 0; j < pkglist->len; j++) {
-            pkg_tmp = static_cast< DnfPackage * >(g_ptr_array_index(pkglist, j));
-            g_ptr_array_add(priv->remove_helper, g_object_ref(pkg_tmp));
-            dnf_package_set_action(pkg_tmp, DNF_STATE_ACTION_CLEANUP);
-
-            const char *pkg_tmp_name = dnf_package_get_name(pkg_tmp);
+        if (dnf_find_pkg_from_name(priv->remove_index, pkg_tmp_name) != NULL) {
+            // package is already in remove set - skip resolution
+            continue;
+        }
 
-            if (dnf_find_pkg_from_name(priv->remove, pkg_tmp_name) != NULL) {
-                // package is already in remove set - skip resolution
+        if (obsolete->action == libdnf::TransactionItemAction::OBSOLETED
+            && dnf_find_pkg_from_name(priv->install_index, pkg_tmp_name) != NULL) {
+                // If a package is obsoleted and there's a package with the same name
+                // in the install set, skip recording the obsolete in the history db
+                // because the package upgrade prevails over the obsolete.
+                //
+                // Example:
+                // grub2-tools-efi obsoletes grub2-tools  # skip as grub2-tools is also upgraded
+                // grub2-tools upgrades grub2-tools
                 continue;
-            }
-
-            libdnf::TransactionItemAction swdbAction = libdnf::TransactionItemAction::OBSOLETED;
-            if (g_strcmp0(pkg_name, pkg_tmp_name) == 0) {
-                // names are identical - package is upgraded/downgraded
-                if (dnf_package_evr_cmp(pkg, pkg_tmp)) {
-                    swdbAction = libdnf::TransactionItemAction::UPGRADED;
-                } else {
-                    swdbAction = libdnf::TransactionItemAction::DOWNGRADED;
-                }
-            }
-
-            if (swdbAction == libdnf::TransactionItemAction::OBSOLETED
-                && dnf_find_pkg_from_name(priv->install, pkg_tmp_name) != NULL
-                && g_strcmp0(pkg_name, pkg_tmp_name) != 0) {
-                    // If a package is obsoleted and there's a package with the same name
-                    // in the install set, skip recording the obsolete in the history db
-                    // because the package upgrade prevails over the obsolete.
-                    //
-                    // Example:
-                    // grub2-tools-efi obsoletes grub2-tools  # skip as grub2-tools is also upgraded
-                    // grub2-tools upgrades grub2-tools
-                    continue;
-            }
-
-            // TODO SWDB add pkg_tmp replaced_by pkg
-            _history_write_item(pkg_tmp, priv->swdb, swdbAction);
         }
-        g_ptr_array_unref(pkglist);
+
+        // TODO SWDB add pkg_tmp replaced_by pkg
+        _history_write_item(pkg_tmp, priv->swdb, obsolete->action);
     }
+    priv->remove_helper_index = dnf_transaction_pkg_index_new(priv->remove_helper);
 
     /* this section done */
     ret = dnf_state_done(state, error);
@@ -1285,32 +2323,33 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
     /* map updated packages to their previous versions */
     priv->erased_by_package_hash =
         g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_object_unref);
-    all_obsoleted = hy_goal_list_obsoleted(goal, NULL);
-    for (i = 0; i < priv->install->len; i++) {
-        pkg = static_cast< DnfPackage * >(g_ptr_array_index(priv->install, i));
-        if (dnf_package_get_action(pkg) != DNF_STATE_ACTION_UPDATE &&
-            dnf_package_get_action(pkg) != DNF_STATE_ACTION_DOWNGRADE &&
-            dnf_package_get_action(pkg) != DNF_STATE_ACTION_REINSTALL)
+    for (i = 0; i < obsoletes->len; i++) {
+        auto obsolete = &g_array_index(obsoletes, DnfTransactionObsolete, i);
+        if (obsolete->obsoleted)
             continue;
-
-        pkglist = hy_goal_list_obsoleted_by_package(goal, pkg);
-        for (j = 0; j < pkglist->len; j++) {
-            pkg_tmp = static_cast< DnfPackage * >(g_ptr_array_index(pkglist, j));
-            if (!hy_packagelist_has(all_obsoleted, pkg_tmp)) {
-                g_hash_table_insert(priv->erased_by_package_hash,
-                                    g_strdup(dnf_package_get_package_id(pkg)),
-                                    g_object_ref(pkg_tmp));
-            }
-        }
-        g_ptr_array_unref(pkglist);
+        g_hash_table_insert(priv->erased_by_package_hash,
+                            g_strdup(dnf_package_get_package_id(obsolete->obsoleter)),
+                            g_object_ref(obsolete->pkg));
     }
-    g_ptr_array_unref(all_obsoleted);
 
     /* generate ordering for the transaction */
     rpmtsOrder(priv->ts);
 
+    /* an identical transaction passed the test already */
+    if (priv->flags & DNF_TRANSACTION_FLAG_CACHE_TEST) {
+        test_key = dnf_transaction_get_test_key(priv->context,
+                                                priv->flags,
+                                                priv->install,
+                                                priv->remove,
+                                                priv->remove_helper);
+        if ((priv->flags & DNF_TRANSACTION_FLAG_TEST) == 0)
+            tested = dnf_transaction_was_tested(priv->context, test_key);
+        if (tested)
+            g_debug("skipping the test transaction, it was tested as %s", test_key);
+    }
+
     /* run the test transaction */
-    if (dnf_context_get_check_transaction(priv->context)) {
+    if (dnf_context_get_check_transaction(priv->context) && !tested) {
         g_debug("running test transaction");
         dnf_state_action_start(state, DNF_STATE_ACTION_TEST_COMMIT, NULL);
         priv->state = dnf_state_get_child(state);
@@ -1369,10 +2408,16 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
         }
 
         /* transaction test done; return */
+        if (test_key != NULL)
+            dnf_transaction_set_tested(priv->context, test_key);
         ret = dnf_state_done(state, error);
         goto out;
     }
 
+    /* the rpmdb is going to change */
+    if (priv->flags & DNF_TRANSACTION_FLAG_CACHE_TEST)
+        dnf_transaction_set_tested(priv->context, NULL);
+
     // FIXME get commandline and rpmdb version
     swdb->beginTransaction(_get_current_time(), "", "", priv->uid);
 
@@ -1460,7 +2505,6 @@ dnf_transaction_new(DnfContext *context)
 {
     auto transaction = DNF_TRANSACTION(g_object_new(DNF_TYPE_TRANSACTION, NULL));
     auto priv = GET_PRIVATE(transaction);
-    priv->swdb = new libdnf::Swdb(libdnf::Swdb::defaultPath);
     priv->context = context;
     g_object_add_weak_pointer(G_OBJECT(priv->context), (void **)&priv->context);
     priv->ts = rpmtsCreate();
@@ -57,6 +57,8 @@ struct _DnfTransactionClass
  * @DNF_TRANSACTION_FLAG_ALLOW_DOWNGRADE:       Allow package downrades
  * @DNF_TRANSACTION_FLAG_NODOCS:                Don't install documentation
  * @DNF_TRANSACTION_FLAG_TEST:                  Only do a transaction test
+ * @DNF_TRANSACTION_FLAG_PIPELINE:              Verify packages while others are downloaded
+ * @DNF_TRANSACTION_FLAG_CACHE_TEST:            Skip the checks an identical transaction test passed
  *
  * The transaction flags.
  **/
@@ -67,6 +69,8 @@ typedef enum {
         DNF_TRANSACTION_FLAG_ALLOW_DOWNGRADE    = 1 << 2,
         DNF_TRANSACTION_FLAG_NODOCS             = 1 << 3,
         DNF_TRANSACTION_FLAG_TEST               = 1 << 4,
+        DNF_TRANSACTION_FLAG_PIPELINE           = 1 << 5,
+        DNF_TRANSACTION_FLAG_CACHE_TEST         = 1 << 6,
         /*< private >*/
         DNF_TRANSACTION_FLAG_LAST
 } DnfTransactionFlag;
@@ -46,6 +46,7 @@ extern "C" {
 #include "../utils/tinyformat/tinyformat.hpp"
 #include "IdQueue.hpp"
 #include "../utils/filesystem.hpp"
+#include "../utils/metrics.hpp"
 
 enum {NO_MATCH=1, MULTIPLE_MATCH_OBJECTS, INCORECT_COMPARISON_TYPE};
 
@@ -1238,6 +1239,8 @@ Goal::Impl::limitInstallonlyPackages(Solver *solv, Queue *job)
 bool
 Goal::Impl::solve(Queue *job, DnfGoalActions flags)
 {
+    Metrics::ScopedTimer timer(Metrics::Timer::GOAL_SOLVE);
+
     /* apply the excludes */
     dnf_sack_recompute_considered(sack);
 
@@ -1262,6 +1265,7 @@ Goal::Impl::solve(Queue *job, DnfGoalActions flags)
     if (DNF_ALLOW_DOWNGRADE & actions)
         solver_set_flag(solv, SOLVER_FLAG_ALLOW_DOWNGRADE, 1);
 
+    Metrics::add(Metrics::Counter::GOAL_SOLVE);
     if (solver_solve(solv, job))
         return true;
     // either allow solutions callback or installonlies, both at the same time
@@ -1270,6 +1274,8 @@ Goal::Impl::solve(Queue *job, DnfGoalActions flags)
         // allow erasing non-installonly packages that depend on a kernel about
         // to be erased
         allowUninstallAllButProtected(job, DNF_ALLOW_UNINSTALL);
+        Metrics::add(Metrics::Counter::GOAL_SOLVE);
+        Metrics::add(Metrics::Counter::GOAL_RERUN);
         if (solver_solve(solv, job))
             return true;
     }
@@ -583,8 +583,7 @@ packageSet2GPtrArray(libdnf::PackageSet * pset)
 
     DnfSack * sack = pset->getSack();
 
-    Id id = -1;
-    while ((id = pset->next(id)) != -1) {
+    for (Id id : pset->getIds()) {
         g_ptr_array_add(plist, dnf_package_new(sack, id));
     }
     return plist;
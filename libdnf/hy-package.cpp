@@ -45,6 +45,7 @@
 #include "hy-package-private.hpp"
 #include "hy-repo-private.hpp"
 #include "repo/solvable/DependencyContainer.hpp"
+#include "sack/packagehandle.hpp"
 
 #define BLOCK_SIZE 31
 
@@ -131,14 +132,6 @@ dnf_package_get_pool(DnfPackage *pkg)
     return dnf_sack_get_pool(priv->sack);
 }
 
-static guint64
-lookup_num(DnfPackage *pkg, unsigned type)
-{
-    Solvable *s = get_solvable(pkg);
-    repo_internalize_trigger(s->repo);
-    return solvable_lookup_num(s, type, 0);
-}
-
 static DnfReldepList *
 reldeps_for(DnfPackage *pkg, Id type)
 {
@@ -239,8 +232,7 @@ dnf_package_get_identical(DnfPackage *pkg1, DnfPackage *pkg2)
 gboolean
 dnf_package_installed(DnfPackage *pkg)
 {
-    Solvable *s = get_solvable(pkg);
-    return (dnf_package_get_pool(pkg)->installed == s->repo);
+    return libdnf::PackageHandle(pkg).isInstalled();
 }
 
 /**
@@ -257,23 +249,7 @@ dnf_package_installed(DnfPackage *pkg)
 int
 dnf_package_cmp(DnfPackage *pkg1, DnfPackage *pkg2)
 {
-    Pool *pool1 = dnf_package_get_pool(pkg1);
-    Pool *pool2 = dnf_package_get_pool(pkg2);
-    Solvable *s1 = pool_id2solvable(pool1, dnf_package_get_id(pkg1));
-    Solvable *s2 = pool_id2solvable(pool2, dnf_package_get_id(pkg2));
-    const char *str1 = pool_id2str(pool1, s1->name);
-    const char *str2 = pool_id2str(pool2, s2->name);
-    int ret = strcmp(str1, str2);
-    if (ret)
-        return ret;
-
-    ret = dnf_package_evr_cmp(pkg1, pkg2);
-    if (ret)
-        return ret;
-
-    str1 = pool_id2str(pool1, s1->arch);
-    str2 = pool_id2str(pool2, s2->arch);
-    return strcmp(str1, str2);
+    return libdnf::PackageHandle(pkg1).cmp(libdnf::PackageHandle(pkg2));
 }
 
 /**
@@ -290,14 +266,7 @@ dnf_package_cmp(DnfPackage *pkg1, DnfPackage *pkg2)
 int
 dnf_package_evr_cmp(DnfPackage *pkg1, DnfPackage *pkg2)
 {
-    Pool *pool1 = dnf_package_get_pool(pkg1);
-    Pool *pool2 = dnf_package_get_pool(pkg2);
-    Solvable *s1 = get_solvable(pkg1);
-    Solvable *s2 = get_solvable(pkg2);
-    const char *str1 = pool_id2str(pool1, s1->evr);
-    const char *str2 = pool_id2str(pool2, s2->evr);
-
-    return pool_evrcmp_str(dnf_package_get_pool(pkg1), str1, str2, EVRCMP_COMPARE);
+    return libdnf::PackageHandle(pkg1).evrCmp(libdnf::PackageHandle(pkg2));
 }
 
 /**
@@ -315,11 +284,7 @@ dnf_package_evr_cmp(DnfPackage *pkg1, DnfPackage *pkg2)
 const char *
 dnf_package_get_location(DnfPackage *pkg)
 {
-    Solvable *s = get_solvable(pkg);
-    if (s->repo) {
-        repo_internalize_trigger(s->repo);
-    }
-    return solvable_get_location(s, NULL);
+    return libdnf::PackageHandle(pkg).getLocation();
 }
 
 /**
@@ -335,17 +300,15 @@ dnf_package_get_location(DnfPackage *pkg)
 const char *
 dnf_package_get_baseurl(DnfPackage *pkg)
 {
-    Solvable *s = get_solvable(pkg);
-    return solvable_lookup_str(s, SOLVABLE_MEDIABASE);
+    return libdnf::PackageHandle(pkg).getBaseurl();
 }
 
 /**
  * dnf_package_get_nevra:
  * @pkg: a #DnfPackage instance.
  *
- * Gets the package NEVRA. Note that the returned string has an undefined
- * lifetime and may become invalid at a later time. You should copy the string
- * if storing it into a long-lived data structure.
+ * Gets the package NEVRA. The string is cached by the sack and stays valid as
+ * long as the sack, packages with the same NEVRA return the same string.
  *
  * Returns: (transfer none): a string, or %NULL
  *
@@ -354,8 +317,7 @@ dnf_package_get_baseurl(DnfPackage *pkg)
 const char *
 dnf_package_get_nevra(DnfPackage *pkg)
 {
-    Solvable *s = get_solvable(pkg);
-    return pool_solvable2str(dnf_package_get_pool(pkg), s);
+    return libdnf::PackageHandle(pkg).getNevra();
 }
 
 /**
@@ -371,9 +333,7 @@ dnf_package_get_nevra(DnfPackage *pkg)
 const char *
 dnf_package_get_sourcerpm(DnfPackage *pkg)
 {
-    Solvable *s = get_solvable(pkg);
-    repo_internalize_trigger(s->repo);
-    return solvable_lookup_sourcepkg(s);
+    return libdnf::PackageHandle(pkg).getSourcerpm();
 }
 
 /**
@@ -389,9 +349,7 @@ dnf_package_get_sourcerpm(DnfPackage *pkg)
 const char *
 dnf_package_get_version(DnfPackage *pkg)
 {
-    char *e, *v, *r;
-    pool_split_evr(dnf_package_get_pool(pkg), dnf_package_get_evr(pkg), &e, &v, &r);
-    return v;
+    return libdnf::PackageHandle(pkg).getVersion();
 }
 
 /**
@@ -407,9 +365,7 @@ dnf_package_get_version(DnfPackage *pkg)
 const char *
 dnf_package_get_release(DnfPackage *pkg)
 {
-    char *e, *v, *r;
-    pool_split_evr(dnf_package_get_pool(pkg), dnf_package_get_evr(pkg), &e, &v, &r);
-    return r;
+    return libdnf::PackageHandle(pkg).getRelease();
 }
 
 /**
@@ -425,8 +381,7 @@ dnf_package_get_release(DnfPackage *pkg)
 const char *
 dnf_package_get_name(DnfPackage *pkg)
 {
-    Pool *pool = dnf_package_get_pool(pkg);
-    return pool_id2str(pool, get_solvable(pkg)->name);
+    return libdnf::PackageHandle(pkg).getName();
 }
 
 /**
@@ -442,7 +397,7 @@ dnf_package_get_name(DnfPackage *pkg)
 const char *
 dnf_package_get_packager(DnfPackage *pkg)
 {
-    return solvable_lookup_str(get_solvable(pkg), SOLVABLE_PACKAGER);
+    return libdnf::PackageHandle(pkg).getPackager();
 }
 
 /**
@@ -458,8 +413,7 @@ dnf_package_get_packager(DnfPackage *pkg)
 const char *
 dnf_package_get_arch(DnfPackage *pkg)
 {
-    Pool *pool = dnf_package_get_pool(pkg);
-    return pool_id2str(pool, get_solvable(pkg)->arch);
+    return libdnf::PackageHandle(pkg).getArch();
 }
 
 /**
@@ -475,14 +429,7 @@ dnf_package_get_arch(DnfPackage *pkg)
 const unsigned char *
 dnf_package_get_chksum(DnfPackage *pkg, int *type)
 {
-    Solvable *s = get_solvable(pkg);
-    const unsigned char* ret;
-
-    repo_internalize_trigger(s->repo);
-    ret = solvable_lookup_bin_checksum(s, SOLVABLE_CHECKSUM, type);
-    if (ret)
-        *type = checksumt_l2h(*type);
-    return ret;
+    return libdnf::PackageHandle(pkg).getChksum(type);
 }
 
 /**
@@ -499,14 +446,7 @@ dnf_package_get_chksum(DnfPackage *pkg, int *type)
 const unsigned char *
 dnf_package_get_hdr_chksum(DnfPackage *pkg, int *type)
 {
-    Solvable *s = get_solvable(pkg);
-    const unsigned char *ret;
-
-    repo_internalize_trigger(s->repo);
-    ret = solvable_lookup_bin_checksum(s, SOLVABLE_HDRID, type);
-    if (ret)
-        *type = checksumt_l2h(*type);
-    return ret;
+    return libdnf::PackageHandle(pkg).getHdrChksum(type);
 }
 
 /**
@@ -522,7 +462,7 @@ dnf_package_get_hdr_chksum(DnfPackage *pkg, int *type)
 const char *
 dnf_package_get_description(DnfPackage *pkg)
 {
-    return solvable_lookup_str(get_solvable(pkg), SOLVABLE_DESCRIPTION);
+    return libdnf::PackageHandle(pkg).getDescription();
 }
 
 /**
@@ -538,8 +478,7 @@ dnf_package_get_description(DnfPackage *pkg)
 const char *
 dnf_package_get_evr(DnfPackage *pkg)
 {
-    Pool *pool = dnf_package_get_pool(pkg);
-    return pool_id2str(pool, get_solvable(pkg)->evr);
+    return libdnf::PackageHandle(pkg).getEvr();
 }
 
 /**
@@ -555,7 +494,7 @@ dnf_package_get_evr(DnfPackage *pkg)
 const char *
 dnf_package_get_group(DnfPackage *pkg)
 {
-  return solvable_lookup_str(get_solvable(pkg), SOLVABLE_GROUP);
+    return libdnf::PackageHandle(pkg).getGroup();
 }
 
 /**
@@ -571,7 +510,7 @@ dnf_package_get_group(DnfPackage *pkg)
 const char *
 dnf_package_get_license(DnfPackage *pkg)
 {
-    return solvable_lookup_str(get_solvable(pkg), SOLVABLE_LICENSE);
+    return libdnf::PackageHandle(pkg).getLicense();
 }
 
 /**
@@ -587,8 +526,7 @@ dnf_package_get_license(DnfPackage *pkg)
 const char *
 dnf_package_get_reponame(DnfPackage *pkg)
 {
-    Solvable *s = get_solvable(pkg);
-    return s->repo->name;
+    return libdnf::PackageHandle(pkg).getReponame();
 }
 
 /**
@@ -604,8 +542,7 @@ dnf_package_get_reponame(DnfPackage *pkg)
 const char *
 dnf_package_get_summary(DnfPackage *pkg)
 {
-    Solvable *s = get_solvable(pkg);
-    return solvable_lookup_str(s, SOLVABLE_SUMMARY);
+    return libdnf::PackageHandle(pkg).getSummary();
 }
 
 /**
@@ -621,7 +558,7 @@ dnf_package_get_summary(DnfPackage *pkg)
 const char *
 dnf_package_get_url(DnfPackage *pkg)
 {
-    return solvable_lookup_str(get_solvable(pkg), SOLVABLE_URL);
+    return libdnf::PackageHandle(pkg).getUrl();
 }
 
 /**
@@ -637,7 +574,7 @@ dnf_package_get_url(DnfPackage *pkg)
 guint64
 dnf_package_get_downloadsize(DnfPackage *pkg)
 {
-    return lookup_num(pkg, SOLVABLE_DOWNLOADSIZE);
+    return libdnf::PackageHandle(pkg).getDownloadsize();
 }
 
 /**
@@ -653,7 +590,7 @@ dnf_package_get_downloadsize(DnfPackage *pkg)
 guint64
 dnf_package_get_epoch(DnfPackage *pkg)
 {
-    return pool_get_epoch(dnf_package_get_pool(pkg), dnf_package_get_evr(pkg));
+    return libdnf::PackageHandle(pkg).getEpoch();
 }
 
 /**
@@ -669,7 +606,7 @@ dnf_package_get_epoch(DnfPackage *pkg)
 guint64
 dnf_package_get_hdr_end(DnfPackage *pkg)
 {
-    return lookup_num(pkg, SOLVABLE_HEADEREND);
+    return libdnf::PackageHandle(pkg).getHdrEnd();
 }
 
 /**
@@ -685,7 +622,7 @@ dnf_package_get_hdr_end(DnfPackage *pkg)
 guint64
 dnf_package_get_installsize(DnfPackage *pkg)
 {
-    return lookup_num(pkg, SOLVABLE_INSTALLSIZE);
+    return libdnf::PackageHandle(pkg).getInstallsize();
 }
 
 /**
@@ -701,7 +638,7 @@ dnf_package_get_installsize(DnfPackage *pkg)
 guint64
 dnf_package_get_buildtime(DnfPackage *pkg)
 {
-    return lookup_num(pkg, SOLVABLE_BUILDTIME);
+    return libdnf::PackageHandle(pkg).getBuildtime();
 }
 
 /**
@@ -717,7 +654,7 @@ dnf_package_get_buildtime(DnfPackage *pkg)
 guint64
 dnf_package_get_installtime(DnfPackage *pkg)
 {
-    return lookup_num(pkg, SOLVABLE_INSTALLTIME);
+    return libdnf::PackageHandle(pkg).getInstalltime();
 }
 
 /**
@@ -733,7 +670,7 @@ dnf_package_get_installtime(DnfPackage *pkg)
 guint64
 dnf_package_get_medianr(DnfPackage *pkg)
 {
-    return lookup_num(pkg, SOLVABLE_MEDIANR);
+    return libdnf::PackageHandle(pkg).getMedianr();
 }
 
 /**
@@ -749,8 +686,7 @@ dnf_package_get_medianr(DnfPackage *pkg)
 guint64
 dnf_package_get_rpmdbid(DnfPackage *pkg)
 {
-    guint64 ret = lookup_num(pkg, RPM_RPMDBID);
-    return ret;
+    return libdnf::PackageHandle(pkg).getRpmdbid();
 }
 
 /**
@@ -766,9 +702,7 @@ dnf_package_get_rpmdbid(DnfPackage *pkg)
 guint64
 dnf_package_get_size(DnfPackage *pkg)
 {
-    unsigned type = dnf_package_installed(pkg) ? SOLVABLE_INSTALLSIZE :
-                                                 SOLVABLE_DOWNLOADSIZE;
-    return lookup_num(pkg, type);
+    return libdnf::PackageHandle(pkg).getSize();
 }
 
 /**
@@ -915,6 +849,13 @@ dnf_package_get_supplements(DnfPackage *pkg)
     return reldeps_for(pkg, SOLVABLE_SUPPLEMENTS);
 }
 
+static gboolean
+add_file_cb(const char *filename, const char *basename, gpointer user_data)
+{
+    g_ptr_array_add(static_cast<GPtrArray *>(user_data), g_strdup(filename));
+    return TRUE;
+}
+
 /**
  * dnf_package_get_files:
  * @pkg: a #DnfPackage instance.
@@ -927,22 +868,48 @@ dnf_package_get_supplements(DnfPackage *pkg)
  */
 gchar **
 dnf_package_get_files(DnfPackage *pkg)
+{
+    GPtrArray *ret = g_ptr_array_new();
+
+    dnf_package_foreach_file(pkg, add_file_cb, ret);
+    g_ptr_array_add(ret, NULL);
+    return (gchar**)g_ptr_array_free (ret, FALSE);
+}
+
+/**
+ * dnf_package_foreach_file:
+ * @pkg: a #DnfPackage instance.
+ * @func: (scope call): the function to call for every file
+ * @user_data: data passed to @func
+ *
+ * Calls @func for the files contained in the package, without copying the
+ * file names. Use it instead of dnf_package_get_files() for large packages.
+ *
+ * Returns: %FALSE if @func stopped the iteration
+ *
+ * Since: 0.19.1
+ */
+gboolean
+dnf_package_foreach_file(DnfPackage *pkg, DnfPackageFileFunc func, gpointer user_data)
 {
     DnfPackagePrivate *priv = GET_PRIVATE(pkg);
     Pool *pool = dnf_package_get_pool(pkg);
     Solvable *s = get_solvable(pkg);
     Dataiterator di;
-    GPtrArray *ret = g_ptr_array_new();
+    gboolean ret = TRUE;
 
     repo_internalize_trigger(s->repo);
     dataiterator_init(&di, pool, s->repo, priv->id, SOLVABLE_FILELIST, NULL,
                       SEARCH_FILES | SEARCH_COMPLETE_FILELIST);
     while (dataiterator_step(&di)) {
-        g_ptr_array_add(ret, g_strdup(di.kv.str));
+        const char *basename = strrchr(di.kv.str, '/');
+        if (!func(di.kv.str, basename != NULL ? basename + 1 : di.kv.str, user_data)) {
+            ret = FALSE;
+            break;
+        }
     }
     dataiterator_free(&di);
-    g_ptr_array_add(ret, NULL);
-    return (gchar**)g_ptr_array_free (ret, FALSE);
+    return ret;
 }
 
 /**
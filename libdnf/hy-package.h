@@ -46,6 +46,20 @@ struct _DnfPackageClass
         void (*_dnf_reserved8)  (void);
 };
 
+/**
+ * DnfPackageFileFunc:
+ * @filename: the full path of the file
+ * @basename: the file name, a pointer into @filename after the directory
+ * @user_data: data passed to the iterating function
+ *
+ * Called for every file of a package. The strings are only valid during the
+ * call.
+ *
+ * Returns: %FALSE to stop the iteration
+ */
+typedef gboolean (*DnfPackageFileFunc) (const char *filename, const char *basename,
+                                        gpointer user_data);
+
 DnfPackage  *dnf_package_new            (DnfSack    *sack, Id id);
 
 gboolean     dnf_package_get_identical  (DnfPackage *pkg1, DnfPackage *pkg2);
@@ -93,6 +107,9 @@ DnfReldepList *dnf_package_get_requires_pre (DnfPackage *pkg);
 DnfReldepList *dnf_package_get_suggests     (DnfPackage *pkg);
 DnfReldepList *dnf_package_get_supplements  (DnfPackage *pkg);
 char       **dnf_package_get_files      (DnfPackage *pkg);
+gboolean     dnf_package_foreach_file   (DnfPackage *pkg,
+                                         DnfPackageFileFunc func,
+                                         gpointer user_data);
 GPtrArray   *dnf_package_get_advisories (DnfPackage *pkg, int cmp_type);
 
 DnfPackageDelta *dnf_package_get_delta_from_evr(DnfPackage *pkg, const char *from_evr);
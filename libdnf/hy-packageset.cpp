@@ -32,6 +32,10 @@
  */
 
 
+#include <string.h>
+#include <solv/dataiterator.h>
+#include <solv/repo.h>
+
 #include "dnf-sack-private.hpp"
 #include "sack/packageset.hpp"
 
@@ -149,6 +153,54 @@ dnf_packageset_has(DnfPackageSet *pset, DnfPackage *pkg)
     return pset->has(pkg);
 }
 
+/**
+ * dnf_packageset_foreach_file:
+ * @pset: a #DnfPackageSet instance.
+ * @func: (scope call): the function to call for every file
+ * @user_data: data passed to @func
+ *
+ * Calls @func for the files of all the packages in the set, in the order of
+ * the package Ids. The file lists of all the repos are walked in one pass and
+ * the file names are not copied.
+ *
+ * Returns: %FALSE if @func stopped the iteration
+ *
+ * Since: 0.19.1
+ */
+gboolean
+dnf_packageset_foreach_file(DnfPackageSet *pset, DnfPackageSetFileFunc func, gpointer user_data)
+{
+    Pool *pool = dnf_sack_get_pool(pset->getSack());
+    Map *map = pset->getMap();
+    Repo *internalized = NULL;
+    Dataiterator di;
+    gboolean ret = TRUE;
+
+    for (Id id = pset->next(-1); id != -1; id = pset->next(id)) {
+        Repo *repo = pool_id2solvable(pool, id)->repo;
+        if (repo != internalized) {
+            repo_internalize_trigger(repo);
+            internalized = repo;
+        }
+    }
+
+    dataiterator_init(&di, pool, 0, 0, SOLVABLE_FILELIST, NULL,
+                      SEARCH_FILES | SEARCH_COMPLETE_FILELIST);
+    while (dataiterator_step(&di)) {
+        if (di.solvid <= 0 || di.solvid >= map->size << 3 || !MAPTST(map, di.solvid)) {
+            dataiterator_skip_solvable(&di);
+            continue;
+        }
+        const char *basename = strrchr(di.kv.str, '/');
+        if (!func(di.solvid, di.kv.str, basename != NULL ? basename + 1 : di.kv.str, user_data)) {
+            ret = FALSE;
+            break;
+        }
+    }
+    dataiterator_free(&di);
+    return ret;
+}
+
 void
 dnf_packageset_free(DnfPackageSet *pset)
 {
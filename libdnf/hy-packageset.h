@@ -30,12 +30,30 @@
 extern "C" {
 #endif
 
+/**
+ * DnfPackageSetFileFunc:
+ * @id: the Id of the package
+ * @filename: the full path of the file
+ * @basename: the file name, a pointer into @filename after the directory
+ * @user_data: data passed to the iterating function
+ *
+ * Called for every file of the packages of a set. The strings are only valid
+ * during the call.
+ *
+ * Returns: %FALSE to stop the iteration
+ */
+typedef gboolean (*DnfPackageSetFileFunc) (Id id, const char *filename, const char *basename,
+                                           gpointer user_data);
+
 DnfPackageSet       *dnf_packageset_new         (DnfSack *sack);
 void                 dnf_packageset_free        (DnfPackageSet *pset);
 DnfPackageSet       *dnf_packageset_clone       (DnfPackageSet *pset);
 void                 dnf_packageset_add         (DnfPackageSet *pset, DnfPackage *pkg);
 size_t               dnf_packageset_count       (DnfPackageSet *pset);
 int                  dnf_packageset_has         (DnfPackageSet *pset, DnfPackage *pkg);
+gboolean             dnf_packageset_foreach_file(DnfPackageSet *pset,
+                                                 DnfPackageSetFileFunc func,
+                                                 gpointer user_data);
 
 DnfPackageSet       *dnf_packageset_from_bitmap (DnfSack *sack, Map *m);
 Map             *dnf_packageset_get_map        (DnfPackageSet *pset);
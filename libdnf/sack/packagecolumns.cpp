@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <unordered_map>
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/solvable.h>
+
+#include "packagecolumns.hpp"
+#include "../dnf-sack-private.hpp"
+#include "../hy-iutil-private.hpp"
+
+namespace libdnf {
+
+namespace {
+
+struct KeyName {
+    const char *name;
+    PackageColumns::Key key;
+};
+
+const KeyName keyNames[] = {
+    {"name", PackageColumns::Key::NAME},
+    {"epoch", PackageColumns::Key::EPOCH},
+    {"version", PackageColumns::Key::VERSION},
+    {"release", PackageColumns::Key::RELEASE},
+    {"evr", PackageColumns::Key::EVR},
+    {"arch", PackageColumns::Key::ARCH},
+    {"nevra", PackageColumns::Key::NEVRA},
+    {"reponame", PackageColumns::Key::REPONAME},
+    {"sourcerpm", PackageColumns::Key::SOURCERPM},
+    {"summary", PackageColumns::Key::SUMMARY},
+    {"license", PackageColumns::Key::LICENSE},
+    {"url", PackageColumns::Key::URL},
+    {"location", PackageColumns::Key::LOCATION},
+    {"packager", PackageColumns::Key::PACKAGER},
+    {"group", PackageColumns::Key::GROUP},
+    {"downloadsize", PackageColumns::Key::DOWNLOADSIZE},
+    {"installsize", PackageColumns::Key::INSTALLSIZE},
+    {"size", PackageColumns::Key::SIZE},
+    {"buildtime", PackageColumns::Key::BUILDTIME},
+    {"installtime", PackageColumns::Key::INSTALLTIME},
+    {"rpmdbid", PackageColumns::Key::RPMDBID},
+};
+
+/* Stores every distinct string once. Strings of the pool are remembered by
+ * their Id, so the common name, evr and arch columns need no hashing. */
+class StringTable {
+public:
+    explicit StringTable(std::vector<std::string> & strings) : strings(strings)
+    {
+        strings.assign(1, std::string());
+    }
+
+    uint64_t add(const char *str)
+    {
+        if (!str)
+            return 0;
+        auto it = indexes.find(str);
+        if (it != indexes.end())
+            return it->second;
+        uint64_t index = strings.size();
+        strings.emplace_back(str);
+        indexes.emplace(strings.back(), index);
+        return index;
+    }
+
+    uint64_t addPoolString(Pool *pool, Id id)
+    {
+        if (id <= 0)
+            return 0;
+        if (static_cast<std::size_t>(id) >= poolIndexes.size())
+            poolIndexes.resize(std::max(static_cast<std::size_t>(id) + 1,
+                                        static_cast<std::size_t>(pool->ss.nstrings)));
+        auto & index = poolIndexes[id];
+        if (index == 0)
+            index = add(pool_id2str(pool, id));
+        return index;
+    }
+
+private:
+    std::vector<std::string> & strings;
+    std::vector<uint64_t> poolIndexes;
+    std::unordered_map<std::string, uint64_t> indexes;
+};
+
+}
+
+static uint64_t
+getValue(DnfSack *sack, Id id, PackageColumns::Key key, StringTable & table)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+    Solvable *s = pool_id2solvable(pool, id);
+    char *e, *v, *r;
+
+    switch (key) {
+        case PackageColumns::Key::NAME:
+            return table.addPoolString(pool, s->name);
+        case PackageColumns::Key::EPOCH:
+            return pool_get_epoch(pool, pool_id2str(pool, s->evr));
+        case PackageColumns::Key::VERSION:
+            pool_split_evr(pool, pool_id2str(pool, s->evr), &e, &v, &r);
+            return table.add(v);
+        case PackageColumns::Key::RELEASE:
+            pool_split_evr(pool, pool_id2str(pool, s->evr), &e, &v, &r);
+            return table.add(r);
+        case PackageColumns::Key::EVR:
+            return table.addPoolString(pool, s->evr);
+        case PackageColumns::Key::ARCH:
+            return table.addPoolString(pool, s->arch);
+        case PackageColumns::Key::NEVRA:
+            return table.add(dnf_sack_get_nevra(sack, id));
+        case PackageColumns::Key::REPONAME:
+            return table.add(s->repo->name);
+        case PackageColumns::Key::SOURCERPM:
+            return table.add(solvable_lookup_sourcepkg(s));
+        case PackageColumns::Key::SUMMARY:
+            return table.add(solvable_lookup_str(s, SOLVABLE_SUMMARY));
+        case PackageColumns::Key::LICENSE:
+            return table.add(solvable_lookup_str(s, SOLVABLE_LICENSE));
+        case PackageColumns::Key::URL:
+            return table.add(solvable_lookup_str(s, SOLVABLE_URL));
+        case PackageColumns::Key::LOCATION:
+            return table.add(solvable_get_location(s, NULL));
+        case PackageColumns::Key::PACKAGER:
+            return table.add(solvable_lookup_str(s, SOLVABLE_PACKAGER));
+        case PackageColumns::Key::GROUP:
+            return table.add(solvable_lookup_str(s, SOLVABLE_GROUP));
+        case PackageColumns::Key::DOWNLOADSIZE:
+            return solvable_lookup_num(s, SOLVABLE_DOWNLOADSIZE, 0);
+        case PackageColumns::Key::INSTALLSIZE:
+            return solvable_lookup_num(s, SOLVABLE_INSTALLSIZE, 0);
+        case PackageColumns::Key::SIZE:
+            return solvable_lookup_num(s, pool->installed == s->repo ? SOLVABLE_INSTALLSIZE :
+                                       SOLVABLE_DOWNLOADSIZE, 0);
+        case PackageColumns::Key::BUILDTIME:
+            return solvable_lookup_num(s, SOLVABLE_BUILDTIME, 0);
+        case PackageColumns::Key::INSTALLTIME:
+            return solvable_lookup_num(s, SOLVABLE_INSTALLTIME, 0);
+        case PackageColumns::Key::RPMDBID:
+            return solvable_lookup_num(s, RPM_RPMDBID, 0);
+    }
+    return 0;
+}
+
+bool
+PackageColumns::keyFromString(const char *name, Key *key)
+{
+    for (auto & keyName : keyNames) {
+        if (strcmp(keyName.name, name) == 0) {
+            *key = keyName.key;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+PackageColumns::isStringKey(Key key)
+{
+    switch (key) {
+        case Key::EPOCH:
+        case Key::DOWNLOADSIZE:
+        case Key::INSTALLSIZE:
+        case Key::SIZE:
+        case Key::BUILDTIME:
+        case Key::INSTALLTIME:
+        case Key::RPMDBID:
+            return false;
+        default:
+            return true;
+    }
+}
+
+PackageColumns::PackageColumns(const PackageSet & pset, const std::vector<Key> & keys)
+    : keys(keys), columns(keys.size())
+{
+    Pool *pool = dnf_sack_get_pool(pset.getSack());
+    StringTable table(strings);
+    Repo *internalized = nullptr;
+
+    auto count = pset.size();
+    ids.reserve(count);
+    for (auto & column : columns)
+        column.reserve(count);
+
+    for (Id id = pset.next(-1); id != -1; id = pset.next(id)) {
+        Solvable *s = pool_id2solvable(pool, id);
+        // the packages of a repo are next to each other in the set
+        if (s->repo != internalized) {
+            repo_internalize_trigger(s->repo);
+            internalized = s->repo;
+        }
+        ids.push_back(id);
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            columns[i].push_back(getValue(pset.getSack(), id, keys[i], table));
+    }
+}
+
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __PACKAGE_COLUMNS_HPP
+#define __PACKAGE_COLUMNS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <solv/pooltypes.h>
+#include "packageset.hpp"
+
+namespace libdnf {
+
+/**
+* @brief Attributes of all packages in a PackageSet, extracted in one pass
+*
+* Each requested attribute is a column with one value per package, in the
+* order of the package Ids. Numeric columns hold the values themselves,
+* string columns hold indexes into a string table shared by all columns, in
+* which every distinct string is stored once. Index 0 stands for no value.
+*/
+struct PackageColumns {
+public:
+    enum class Key {
+        NAME,
+        EPOCH,
+        VERSION,
+        RELEASE,
+        EVR,
+        ARCH,
+        NEVRA,
+        REPONAME,
+        SOURCERPM,
+        SUMMARY,
+        LICENSE,
+        URL,
+        LOCATION,
+        PACKAGER,
+        GROUP,
+        DOWNLOADSIZE,
+        INSTALLSIZE,
+        SIZE,
+        BUILDTIME,
+        INSTALLTIME,
+        RPMDBID
+    };
+
+    /**
+    * @brief Looks up the key of an attribute by its name, e.g. "reponame"
+    *
+    * @return false if there is no such attribute
+    */
+    static bool keyFromString(const char *name, Key *key);
+    static bool isStringKey(Key key);
+
+    PackageColumns(const PackageSet & pset, const std::vector<Key> & keys);
+
+    const std::vector<Key> & getKeys() const noexcept { return keys; }
+    const std::vector<Id> & getIds() const noexcept { return ids; }
+    const std::vector<uint64_t> & getColumn(std::size_t index) const { return columns[index]; }
+
+    /**
+    * @brief String table of the string columns, the first entry is the empty
+    * string at index 0 which means no value
+    */
+    const std::vector<std::string> & getStrings() const noexcept { return strings; }
+
+private:
+    std::vector<Key> keys;
+    std::vector<Id> ids;
+    std::vector<std::vector<uint64_t>> columns;
+    std::vector<std::string> strings;
+};
+
+}
+
+#endif // __PACKAGE_COLUMNS_HPP
@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+#include <solv/evr.h>
+#include <solv/repo.h>
+#include <solv/solvable.h>
+
+#include "packagehandle.hpp"
+#include "../dnf-sack-private.hpp"
+#include "../hy-iutil-private.hpp"
+
+namespace libdnf {
+
+PackageHandle::PackageHandle(DnfPackage *pkg)
+    : sack(dnf_package_get_sack(pkg)), id(dnf_package_get_id(pkg))
+{}
+
+Pool *
+PackageHandle::getPool() const
+{
+    return dnf_sack_get_pool(sack);
+}
+
+Solvable *
+PackageHandle::getSolvable() const
+{
+    return pool_id2solvable(getPool(), id);
+}
+
+guint64
+PackageHandle::lookupNum(Id type) const
+{
+    Solvable *s = getSolvable();
+    repo_internalize_trigger(s->repo);
+    return solvable_lookup_num(s, type, 0);
+}
+
+const char *
+PackageHandle::getName() const
+{
+    return pool_id2str(getPool(), getSolvable()->name);
+}
+
+const char *
+PackageHandle::getEvr() const
+{
+    return pool_id2str(getPool(), getSolvable()->evr);
+}
+
+guint64
+PackageHandle::getEpoch() const
+{
+    return pool_get_epoch(getPool(), getEvr());
+}
+
+const char *
+PackageHandle::getVersion() const
+{
+    char *e, *v, *r;
+    pool_split_evr(getPool(), getEvr(), &e, &v, &r);
+    return v;
+}
+
+const char *
+PackageHandle::getRelease() const
+{
+    char *e, *v, *r;
+    pool_split_evr(getPool(), getEvr(), &e, &v, &r);
+    return r;
+}
+
+const char *
+PackageHandle::getArch() const
+{
+    return pool_id2str(getPool(), getSolvable()->arch);
+}
+
+const char *
+PackageHandle::getNevra() const
+{
+    return dnf_sack_get_nevra(sack, id);
+}
+
+const char *
+PackageHandle::getReponame() const
+{
+    return getSolvable()->repo->name;
+}
+
+const char *
+PackageHandle::getLocation() const
+{
+    Solvable *s = getSolvable();
+    if (s->repo)
+        repo_internalize_trigger(s->repo);
+    return solvable_get_location(s, NULL);
+}
+
+const char *
+PackageHandle::getBaseurl() const
+{
+    return solvable_lookup_str(getSolvable(), SOLVABLE_MEDIABASE);
+}
+
+const char *
+PackageHandle::getSourcerpm() const
+{
+    Solvable *s = getSolvable();
+    repo_internalize_trigger(s->repo);
+    return solvable_lookup_sourcepkg(s);
+}
+
+const char *
+PackageHandle::getSummary() const
+{
+    return solvable_lookup_str(getSolvable(), SOLVABLE_SUMMARY);
+}
+
+const char *
+PackageHandle::getDescription() const
+{
+    return solvable_lookup_str(getSolvable(), SOLVABLE_DESCRIPTION);
+}
+
+const char *
+PackageHandle::getUrl() const
+{
+    return solvable_lookup_str(getSolvable(), SOLVABLE_URL);
+}
+
+const char *
+PackageHandle::getLicense() const
+{
+    return solvable_lookup_str(getSolvable(), SOLVABLE_LICENSE);
+}
+
+const char *
+PackageHandle::getPackager() const
+{
+    return solvable_lookup_str(getSolvable(), SOLVABLE_PACKAGER);
+}
+
+const char *
+PackageHandle::getGroup() const
+{
+    return solvable_lookup_str(getSolvable(), SOLVABLE_GROUP);
+}
+
+const unsigned char *
+PackageHandle::getChksum(int *type) const
+{
+    Solvable *s = getSolvable();
+    repo_internalize_trigger(s->repo);
+    auto ret = solvable_lookup_bin_checksum(s, SOLVABLE_CHECKSUM, type);
+    if (ret)
+        *type = checksumt_l2h(*type);
+    return ret;
+}
+
+const unsigned char *
+PackageHandle::getHdrChksum(int *type) const
+{
+    Solvable *s = getSolvable();
+    repo_internalize_trigger(s->repo);
+    auto ret = solvable_lookup_bin_checksum(s, SOLVABLE_HDRID, type);
+    if (ret)
+        *type = checksumt_l2h(*type);
+    return ret;
+}
+
+guint64
+PackageHandle::getDownloadsize() const
+{
+    return lookupNum(SOLVABLE_DOWNLOADSIZE);
+}
+
+guint64
+PackageHandle::getInstallsize() const
+{
+    return lookupNum(SOLVABLE_INSTALLSIZE);
+}
+
+guint64
+PackageHandle::getBuildtime() const
+{
+    return lookupNum(SOLVABLE_BUILDTIME);
+}
+
+guint64
+PackageHandle::getInstalltime() const
+{
+    return lookupNum(SOLVABLE_INSTALLTIME);
+}
+
+guint64
+PackageHandle::getMedianr() const
+{
+    return lookupNum(SOLVABLE_MEDIANR);
+}
+
+guint64
+PackageHandle::getRpmdbid() const
+{
+    return lookupNum(RPM_RPMDBID);
+}
+
+guint64
+PackageHandle::getHdrEnd() const
+{
+    return lookupNum(SOLVABLE_HEADEREND);
+}
+
+guint64
+PackageHandle::getSize() const
+{
+    return lookupNum(isInstalled() ? SOLVABLE_INSTALLSIZE : SOLVABLE_DOWNLOADSIZE);
+}
+
+bool
+PackageHandle::isInstalled() const
+{
+    return getPool()->installed == getSolvable()->repo;
+}
+
+int
+PackageHandle::cmp(const PackageHandle &other) const
+{
+    Pool *pool1 = getPool();
+    Pool *pool2 = other.getPool();
+    Solvable *s1 = getSolvable();
+    Solvable *s2 = other.getSolvable();
+    int ret = strcmp(pool_id2str(pool1, s1->name), pool_id2str(pool2, s2->name));
+    if (ret)
+        return ret;
+
+    ret = evrCmp(other);
+    if (ret)
+        return ret;
+
+    return strcmp(pool_id2str(pool1, s1->arch), pool_id2str(pool2, s2->arch));
+}
+
+int
+PackageHandle::evrCmp(const PackageHandle &other) const
+{
+    return pool_evrcmp_str(getPool(), getEvr(), other.getEvr(), EVRCMP_COMPARE);
+}
+
+DnfPackage *
+PackageHandle::toPackage() const
+{
+    return dnf_package_new(sack, id);
+}
+
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __PACKAGE_HANDLE_HPP
+#define __PACKAGE_HANDLE_HPP
+
+#include <solv/pool.h>
+#include <solv/pooltypes.h>
+#include "../dnf-types.h"
+#include "../hy-package.h"
+
+namespace libdnf {
+
+/**
+* @brief Package identified by its sack and solvable Id, passed by value.
+*
+* Unlike DnfPackage it is not a GObject: creating, copying and dropping it
+* costs nothing, so it suits iterating over large query results. It has
+* the accessors of DnfPackage, the dnf_package_* functions delegate to it.
+* The strings returned have the same lifetime as the DnfPackage ones, the
+* NEVRA is cached by the sack and lives as long as it.
+*/
+struct PackageHandle {
+public:
+    PackageHandle(DnfSack *sack, Id id) noexcept : sack(sack), id(id) {}
+    explicit PackageHandle(DnfPackage *pkg);
+
+    DnfSack *getSack() const noexcept { return sack; }
+    Id getId() const noexcept { return id; }
+    Pool *getPool() const;
+    Solvable *getSolvable() const;
+
+    const char *getName() const;
+    const char *getEvr() const;
+    guint64 getEpoch() const;
+    const char *getVersion() const;
+    const char *getRelease() const;
+    const char *getArch() const;
+    const char *getNevra() const;
+    const char *getReponame() const;
+    const char *getLocation() const;
+    const char *getBaseurl() const;
+    const char *getSourcerpm() const;
+    const char *getSummary() const;
+    const char *getDescription() const;
+    const char *getUrl() const;
+    const char *getLicense() const;
+    const char *getPackager() const;
+    const char *getGroup() const;
+    const unsigned char *getChksum(int *type) const;
+    const unsigned char *getHdrChksum(int *type) const;
+    guint64 getDownloadsize() const;
+    guint64 getInstallsize() const;
+    guint64 getBuildtime() const;
+    guint64 getInstalltime() const;
+    guint64 getMedianr() const;
+    guint64 getRpmdbid() const;
+    guint64 getHdrEnd() const;
+    guint64 getSize() const;
+    bool isInstalled() const;
+
+    /**
+    * @brief Compares name, EVR and arch like dnf_package_cmp()
+    */
+    int cmp(const PackageHandle &other) const;
+    int evrCmp(const PackageHandle &other) const;
+
+    /**
+    * @brief Promotes the handle to a DnfPackage for callers needing a GObject
+    *
+    * @return DnfPackage* new reference
+    */
+    DnfPackage *toPackage() const;
+
+    bool operator==(const PackageHandle &other) const noexcept
+    {
+        return id == other.id && sack == other.sack;
+    }
+    bool operator!=(const PackageHandle &other) const noexcept { return !(*this == other); }
+
+private:
+    guint64 lookupNum(Id type) const;
+
+    DnfSack *sack;
+    Id id;
+};
+
+}
+
+#endif // __PACKAGE_HANDLE_HPP
@@ -23,6 +23,7 @@
 #include "packageset.hpp"
 #include "../dnf-sack.h"
 #include "../hy-util-private.hpp"
+#include "../utils/bitmap.hpp"
 
 namespace libdnf {
 
@@ -62,73 +63,48 @@ PackageSet::Impl::~Impl() { map_free(&map); }
 Id
 PackageSet::operator [](unsigned int index) const
 {
-    const unsigned char *ti = pImpl->map.map;
-    const unsigned char *end = ti + pImpl->map.size;
-    unsigned int enabled;
-    Id id;
-
-    while (ti < end) {
-        enabled = _BitCountLookup[*ti];
-
-        if (index >= enabled ){
-            index -= enabled;
-            ti++;
-            continue;
-        }
-        id = (ti - pImpl->map.map) << 3;
-
-        index++;
-        for (unsigned char byte = *ti; index; byte >>= 1) {
-            if ((byte & 0x01))
-                index--;
-            if (index)
-                id++;
-        }
-        return id;
-    }
-    id = -1;
-    return id;
+    return bitmap::nth(&pImpl->map, index);
 }
 
 PackageSet &
 PackageSet::operator +=(const PackageSet & other)
 {
-    map_or(&pImpl->map, &other.pImpl->map);
+    bitmap::unite(&pImpl->map, &other.pImpl->map);
     return *this;
 }
 
 PackageSet &
 PackageSet::operator -=(const PackageSet & other)
 {
-    map_subtract(&pImpl->map, &other.pImpl->map);
+    bitmap::subtract(&pImpl->map, &other.pImpl->map);
     return *this;
 }
 
 PackageSet &
 PackageSet::operator /=(const PackageSet & other)
 {
-    map_and(&pImpl->map, &other.pImpl->map);
+    bitmap::intersect(&pImpl->map, &other.pImpl->map);
     return *this;
 }
 
 PackageSet &
 PackageSet::operator +=(const Map * other)
 {
-    map_or(&pImpl->map, const_cast<Map *>(other));
+    bitmap::unite(&pImpl->map, other);
     return *this;
 }
 
 PackageSet &
 PackageSet::operator -=(const Map * other)
 {
-    map_subtract(&pImpl->map, const_cast<Map *>(other));
+    bitmap::subtract(&pImpl->map, other);
     return *this;
 }
 
 PackageSet &
 PackageSet::operator /=(const Map * other)
 {
-    map_and(&pImpl->map, const_cast<Map *>(other));
+    bitmap::intersect(&pImpl->map, other);
     return *this;
 }
 
@@ -141,17 +117,9 @@ PackageSet::clear()
 bool
 PackageSet::empty()
 {
-    const unsigned char *res = pImpl->map.map;
-    const unsigned char *end = res + pImpl->map.size;
-
-    while (res < end) {
-        if (*res++)
-            return false;
-    }
-    return true;
+    return bitmap::empty(&pImpl->map);
 }
 
-
 void PackageSet::set(DnfPackage *pkg) { MAPSET(&pImpl->map, dnf_package_get_id(pkg)); }
 void PackageSet::set(Id id) { MAPSET(&pImpl->map, id); }
 bool PackageSet::has(DnfPackage *pkg) const { return MAPTST(&pImpl->map, dnf_package_get_id(pkg)); }
@@ -159,38 +127,16 @@ bool PackageSet::has(Id id) const { return MAPTST(&pImpl->map, id); }
 void PackageSet::remove(Id id) { MAPCLR(&pImpl->map, id); }
 Map *PackageSet::getMap() const { return &pImpl->map; }
 DnfSack *PackageSet::getSack() const { return pImpl->sack; }
-size_t PackageSet::size() const { return map_count(&pImpl->map); }
+size_t PackageSet::size() const { return bitmap::count(&pImpl->map); }
+
+Id PackageSet::next(Id previous) const { return bitmap::next(&pImpl->map, previous); }
 
-Id PackageSet::next(Id previous) const
+std::vector<Id>
+PackageSet::getIds() const
 {
-    const unsigned char *ti = pImpl->map.map;
-    const unsigned char *end = ti + pImpl->map.size;
-    Id id;
-
-    if (previous >= 0) {
-        ti += previous >> 3;
-        unsigned char byte = *ti; // byte with the previous match
-        byte >>= (previous & 7) + 1; // shift away all previous 1 bits
-
-        for (id = previous + 1; byte; byte >>= 1, id++)
-            if (byte & 0x01)
-                return id;
-        ti++;
-    }
-
-    while (ti < end) {
-
-        if (!*ti){
-            ti++;
-            continue;
-        }
-        id = (ti - pImpl->map.map) << 3;
-        for (unsigned char byte = *ti; 1; byte >>= 1, id++) {
-            if (byte & 0x01)
-                return id;
-        }
-    }
-    return -1;
+    std::vector<Id> ids(size());
+    ids.resize(bitmap::toIds(&pImpl->map, ids.data()));
+    return ids;
 }
 
 }
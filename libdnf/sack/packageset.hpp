@@ -22,6 +22,7 @@
 #define __PACKAGE_SET_HPP
 
 #include <memory>
+#include <vector>
 #include <solv/bitmap.h>
 #include "../dnf-types.h"
 #include <solv/pooltypes.h>
@@ -61,6 +62,11 @@ public:
     */
     Id next(Id previous) const;
 
+    /**
+    * @brief Returns ids of all packages in the set in ascending order
+    */
+    std::vector<Id> getIds() const;
+
 private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <assert.h>
 #include <fnmatch.h>
+#include <unordered_set>
 #include <vector>
 
 extern "C" {
@@ -43,6 +44,8 @@ extern "C" {
 #include "advisory.hpp"
 #include "advisorypkg.hpp"
 #include "packageset.hpp"
+#include "../utils/bitmap.hpp"
+#include "../utils/metrics.hpp"
 
 #include "libdnf/repo/solvable/Dependency.hpp"
 #include "libdnf/repo/solvable/DependencyContainer.hpp"
@@ -501,128 +504,256 @@ advisoryPkgCompareSolvableNameArch(const AdvisoryPkg &first, const Solvable &s)
     return first.getArch() < s.arch;
 }
 
-static char *
-copyFilterChar(const char * match, int keyname)
-{
-    if (!match)
-        throw std::runtime_error("Query can not accept NULL for STR match");
-    size_t len = strlen(match);
-    char * matchNew = new char[len + 1];
-    if (keyname == HY_PKG_FILE && len > 1 && match[--len] == '/') {
-        strncpy(matchNew, match, len);
-        matchNew[len] = '\0';
-        return matchNew;
-    }
-    return strcpy(matchNew, match);
-}
-
-class Filter::Impl {
+/**
+* @brief Storage of filters and their matches
+*
+* The arena is append only, the handles of its filters stay valid for its whole lifetime. Copies
+* of a Query share the arena until one of them adds a filter, which forks a new arena on top of
+* the shared one. The match strings are interned, each distinct string is stored once.
+*/
+class FilterArena {
 public:
-    ~Impl();
+    explicit FilterArena(std::shared_ptr<FilterArena> parent = nullptr);
+    ~FilterArena();
+    FilterArena(const FilterArena &) = delete;
+    FilterArena & operator=(const FilterArena &) = delete;
+
+    Filter numFilter(int keyname, int cmpType, int nmatches, const int *matches);
+    Filter psetFilter(int keyname, int cmpType, const DnfPackageSet *pset);
+    Filter reldepFilter(int keyname, int cmpType, int nmatches, const Id *reldeps);
+    /**
+    * @brief Filter of strings, the strings are resolved to pool Ids if pool is given and the
+    * filter compares the Ids
+    */
+    Filter strFilter(int keyname, int cmpType, int nmatches, const char * const *matches,
+                     Pool *pool);
+
+    /// Filters of the Query owning the arena, including the ones of the parent
+    std::vector<Filter> filters;
+
 private:
-    friend struct Filter;
-    int cmpType;
-    int keyname;
-    int matchType;
-    std::vector<_Match> matches;
+    struct StringRef {
+        const char *str;
+        std::size_t len;
+        bool operator==(const StringRef & other) const noexcept
+        {
+            return len == other.len && memcmp(str, other.str, len) == 0;
+        }
+    };
+    struct StringRefHash {
+        std::size_t operator()(const StringRef & ref) const noexcept
+        {
+            // FNV-1a
+            std::size_t hash = 2166136261u;
+            for (std::size_t i = 0; i < ref.len; ++i)
+                hash = (hash ^ static_cast<unsigned char>(ref.str[i])) * 16777619u;
+            return hash;
+        }
+    };
+
+    static constexpr std::size_t BLOCK_SIZE = 1024;
+    static constexpr std::size_t INLINE_SIZE = 256;
+
+    void * allocate(std::size_t size);
+    _Match * allocateMatches(std::size_t count, Id ** ids);
+    char * intern(const char *str, int keyname);
+
+    std::shared_ptr<FilterArena> parent;
+    alignas(_Match) char inlineBlock[INLINE_SIZE];
+    char *cursor;
+    std::size_t left;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::unordered_set<StringRef, StringRefHash> strings;
+    std::vector<DnfPackageSet *> psets;
 };
-Filter::Filter(int keyname, int cmp_type, int match) : pImpl(new Impl)
-{
-    pImpl->keyname = keyname;
-    pImpl->cmpType = cmp_type;
-    pImpl->matchType = _HY_NUM;
-    _Match match_in;
-    match_in.num = match;
-    pImpl->matches.push_back(match_in);
-}
-Filter::Filter(int keyname, int cmp_type, int nmatches, const int *matches) : pImpl(new Impl)
-{
-    pImpl->keyname = keyname;
-    pImpl->cmpType = cmp_type;
-    pImpl->matchType = _HY_NUM;
-    pImpl->matches.reserve(nmatches);
-    for (int i = 0; i < nmatches; ++i) {
-        _Match match_in;
-        match_in.num = matches[i];
-        pImpl->matches.push_back(match_in);
-    }
-}
-Filter::Filter(int keyname, int cmp_type, const DnfPackageSet *pset) : pImpl(new Impl)
-{
-    pImpl->keyname = keyname;
-    pImpl->cmpType = cmp_type;
-    pImpl->matchType = _HY_PKG;
-    _Match match_in;
-    match_in.pset = new libdnf::PackageSet(*pset);
-    pImpl->matches.push_back(match_in);
-}
-Filter::Filter(int keyname, int cmp_type, const Dependency * reldep) : pImpl(new Impl)
-{
-    pImpl->keyname = keyname;
-    pImpl->cmpType = cmp_type;
-    pImpl->matchType = _HY_RELDEP;
-    _Match match_in;
-    match_in.reldep = reldep->getId();
-    pImpl->matches.push_back(match_in);
-}
-Filter::Filter(int keyname, int cmp_type, const DependencyContainer * reldeplist) : pImpl(new Impl)
-{
-    pImpl->keyname = keyname;
-    pImpl->cmpType = cmp_type;
-    pImpl->matchType = _HY_RELDEP;
-    const int nmatches = reldeplist->count();
-    pImpl->matches.reserve(nmatches);
-    for (int i = 0; i < nmatches; ++i) {
-        _Match match_in;
-        match_in.reldep = reldeplist->getId(i);
-        pImpl->matches.push_back(match_in);
-    }
-}
-Filter::Filter(int keyname, int cmp_type, const char *match) : pImpl(new Impl)
-{
-    pImpl->keyname = keyname;
-    pImpl->cmpType = cmp_type;
-    pImpl->matchType = _HY_STR;
-    _Match match_in;
-    match_in.str = copyFilterChar(match, keyname);
-    pImpl->matches.push_back(match_in);
-}
-Filter::Filter(int keyname, int cmp_type, const char **matches) : pImpl(new Impl)
-{
-    pImpl->keyname = keyname;
-    pImpl->cmpType = cmp_type;
-    pImpl->matchType = _HY_STR;
-    const unsigned nmatches = g_strv_length((gchar**)matches);
-    pImpl->matches.reserve(nmatches);
-    for (unsigned int i = 0; i < nmatches; ++i) {
-        _Match match_in;
-        match_in.str = copyFilterChar(matches[i], keyname);
-        pImpl->matches.push_back(match_in);
+
+constexpr std::size_t FilterArena::BLOCK_SIZE;
+constexpr std::size_t FilterArena::INLINE_SIZE;
+
+FilterArena::FilterArena(std::shared_ptr<FilterArena> parent)
+: parent(std::move(parent)), cursor(inlineBlock), left(INLINE_SIZE)
+{
+    if (this->parent)
+        filters = this->parent->filters;
+}
+
+FilterArena::~FilterArena()
+{
+    for (auto pset : psets)
+        delete pset;
+}
+
+void *
+FilterArena::allocate(std::size_t size)
+{
+    // everything is aligned as _Match, the most aligned type stored
+    size = (size + alignof(_Match) - 1) & ~(alignof(_Match) - 1);
+    if (size > BLOCK_SIZE / 4) {
+        blocks.emplace_back(new char[size]);
+        return blocks.back().get();
     }
+    if (size > left) {
+        blocks.emplace_back(new char[BLOCK_SIZE]);
+        cursor = blocks.back().get();
+        left = BLOCK_SIZE;
+    }
+    void *ptr = cursor;
+    cursor += size;
+    left -= size;
+    return ptr;
 }
 
-Filter::~Filter() = default;
+_Match *
+FilterArena::allocateMatches(std::size_t count, Id ** ids)
+{
+    auto matches = static_cast<_Match *>(allocate(count * sizeof(_Match)));
+    *ids = static_cast<Id *>(allocate(count * sizeof(Id)));
+    std::fill_n(*ids, count, 0);
+    return matches;
+}
 
-Filter::Impl::~Impl()
+char *
+FilterArena::intern(const char *str, int keyname)
 {
-    for (auto & match : matches) {
-        switch (matchType) {
-            case _HY_PKG:
-                delete match.pset;
-                break;
-            case _HY_STR:
-                delete[] match.str;
+    if (!str)
+        throw std::runtime_error("Query can not accept NULL for STR match");
+    std::size_t len = strlen(str);
+    if (keyname == HY_PKG_FILE && len > 1 && str[len - 1] == '/')
+        --len;
+    auto it = strings.find(StringRef{str, len});
+    if (it != strings.end())
+        return const_cast<char *>(it->str);
+    auto copy = static_cast<char *>(allocate(len + 1));
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    strings.insert(StringRef{copy, len});
+    return copy;
+}
+
+Filter
+FilterArena::numFilter(int keyname, int cmpType, int nmatches, const int *matches)
+{
+    Id *ids;
+    auto matchesIn = allocateMatches(nmatches, &ids);
+    for (int i = 0; i < nmatches; ++i)
+        matchesIn[i].num = matches[i];
+    return Filter(keyname, cmpType, _HY_NUM, matchesIn, ids, nmatches);
+}
+
+Filter
+FilterArena::psetFilter(int keyname, int cmpType, const DnfPackageSet *pset)
+{
+    Id *ids;
+    auto matchesIn = allocateMatches(1, &ids);
+    psets.reserve(psets.size() + 1);
+    matchesIn[0].pset = new libdnf::PackageSet(*pset);
+    psets.push_back(matchesIn[0].pset);
+    return Filter(keyname, cmpType, _HY_PKG, matchesIn, ids, 1);
+}
+
+Filter
+FilterArena::reldepFilter(int keyname, int cmpType, int nmatches, const Id *reldeps)
+{
+    Id *ids;
+    auto matchesIn = allocateMatches(nmatches, &ids);
+    for (int i = 0; i < nmatches; ++i)
+        matchesIn[i].reldep = reldeps[i];
+    return Filter(keyname, cmpType, _HY_RELDEP, matchesIn, ids, nmatches);
+}
+
+Filter
+FilterArena::strFilter(int keyname, int cmpType, int nmatches, const char * const *matches,
+                       Pool *pool)
+{
+    Id *ids;
+    auto matchesIn = allocateMatches(nmatches, &ids);
+    for (int i = 0; i < nmatches; ++i)
+        matchesIn[i].str = intern(matches[i], keyname);
+    if (pool) {
+        switch (keyname) {
+            case HY_PKG_NAME:
+            case HY_PKG_ARCH:
+                if ((cmpType & HY_EQ) && !(cmpType & HY_ICASE)) {
+                    for (int i = 0; i < nmatches; ++i)
+                        ids[i] = pool_str2id(pool, matchesIn[i].str, 0);
+                }
                 break;
-            default:
+            case HY_PKG_EVR:
+                for (int i = 0; i < nmatches; ++i)
+                    ids[i] = pool_str2id(pool, matchesIn[i].str, 1);
                 break;
         }
     }
-};
+    return Filter(keyname, cmpType, _HY_STR, matchesIn, ids, nmatches);
+}
+
+Filter::Filter(int keyname, int cmpType, int matchType, const _Match * matches, const Id * ids,
+               std::size_t count) noexcept
+: keyname(keyname), cmpType(cmpType), matchType(matchType), matches(matches), ids(ids)
+, count(count)
+{}
+
+Filter::Filter(int keyname, int cmp_type, int match)
+: Filter(keyname, cmp_type, 1, &match)
+{}
+Filter::Filter(int keyname, int cmp_type, int nmatches, const int *matches)
+{
+    auto owner = std::make_shared<FilterArena>();
+    *this = owner->numFilter(keyname, cmp_type, nmatches, matches);
+    arena = std::move(owner);
+}
+Filter::Filter(int keyname, int cmp_type, const DnfPackageSet *pset)
+{
+    auto owner = std::make_shared<FilterArena>();
+    *this = owner->psetFilter(keyname, cmp_type, pset);
+    arena = std::move(owner);
+}
+Filter::Filter(int keyname, int cmp_type, const Dependency * reldep)
+{
+    auto owner = std::make_shared<FilterArena>();
+    Id id = reldep->getId();
+    *this = owner->reldepFilter(keyname, cmp_type, 1, &id);
+    arena = std::move(owner);
+}
+Filter::Filter(int keyname, int cmp_type, const DependencyContainer * reldeplist)
+{
+    auto owner = std::make_shared<FilterArena>();
+    const Queue & queue = reldeplist->getQueue();
+    *this = owner->reldepFilter(keyname, cmp_type, queue.count, queue.elements);
+    arena = std::move(owner);
+}
+Filter::Filter(int keyname, int cmp_type, const char *match)
+{
+    auto owner = std::make_shared<FilterArena>();
+    *this = owner->strFilter(keyname, cmp_type, 1, &match, nullptr);
+    arena = std::move(owner);
+}
+Filter::Filter(int keyname, int cmp_type, const char **matches)
+{
+    auto owner = std::make_shared<FilterArena>();
+    const unsigned nmatches = g_strv_length((gchar**)matches);
+    *this = owner->strFilter(keyname, cmp_type, nmatches, matches, nullptr);
+    arena = std::move(owner);
+}
+
+Filter::~Filter() = default;
 
-int Filter::getKeyname() const noexcept { return pImpl->keyname; }
-int Filter::getCmpType() const noexcept { return pImpl->cmpType; }
-int Filter::getMatchType() const noexcept { return pImpl->matchType; }
-const std::vector< _Match >& Filter::getMatches() const noexcept { return pImpl->matches; }
+int Filter::getKeyname() const noexcept { return keyname; }
+int Filter::getCmpType() const noexcept { return cmpType; }
+int Filter::getMatchType() const noexcept { return matchType; }
+FilterMatches Filter::getMatches() const noexcept { return FilterMatches(matches, count); }
+const Id * Filter::getMatchIds() const noexcept { return ids; }
+
+/* The pool Id of a string match, the strings missing in the pool when the filter was added
+ * are looked up again as the pool may have grown since then. */
+static Id
+matchStrId(Pool *pool, const Filter & f, std::size_t index, int create)
+{
+    Id id = f.getMatchIds()[index];
+    if (id == 0)
+        id = pool_str2id(pool, f.getMatches()[index].str, create);
+    return id;
+}
 
 class Query::Impl {
 private:
@@ -634,8 +765,9 @@ private:
     DnfSack *sack;
     int flags;
     std::unique_ptr<PackageSet> result;
-    std::vector<Filter> filters;
+    std::shared_ptr<FilterArena> filters;
     void apply();
+    FilterArena & filterArena();
 
     /**
     * @brief It accepts strings of whole NEVRA and apply them to the query. It requires full
@@ -675,6 +807,17 @@ private:
 Query::Impl::Impl(DnfSack* sack, int flags)
 : sack(sack), flags(flags) {}
 
+/* The arena to add filters to, forked if it is shared with a copy of the query */
+FilterArena &
+Query::Impl::filterArena()
+{
+    if (!filters)
+        filters = std::make_shared<FilterArena>();
+    else if (filters.use_count() > 1)
+        filters = std::make_shared<FilterArena>(filters);
+    return *filters;
+}
+
 Query::Impl::Impl(const Query::Impl & src)
 : applied(src.applied)
 , sack(src.sack)
@@ -731,7 +874,7 @@ Query::clear()
 {
     pImpl->applied = false;
     pImpl->result.reset();
-    pImpl->filters.clear();
+    pImpl->filters.reset();
 }
 
 size_t
@@ -748,7 +891,8 @@ Query::addFilter(int keyname, int cmp_type, int match)
     if (!valid_filter_num(keyname, cmp_type))
         return DNF_ERROR_BAD_QUERY;
     pImpl->applied = false;
-    pImpl->filters.push_back(Filter(keyname, cmp_type, match));
+    auto & arena = pImpl->filterArena();
+    arena.filters.push_back(arena.numFilter(keyname, cmp_type, 1, &match));
     return 0;
 }
 int
@@ -757,7 +901,8 @@ Query::addFilter(int keyname, int cmp_type, int nmatches, const int *matches)
     if (!valid_filter_num(keyname, cmp_type))
         return DNF_ERROR_BAD_QUERY;
     pImpl->applied = false;
-    pImpl->filters.push_back(Filter(keyname, cmp_type, nmatches, matches));
+    auto & arena = pImpl->filterArena();
+    arena.filters.push_back(arena.numFilter(keyname, cmp_type, nmatches, matches));
     return 0;
 }
 int
@@ -766,7 +911,8 @@ Query::addFilter(int keyname, int cmp_type, const DnfPackageSet *pset)
     if (!valid_filter_pkg(keyname, cmp_type))
         return DNF_ERROR_BAD_QUERY;
     pImpl->applied = false;
-    pImpl->filters.push_back(Filter(keyname, cmp_type, pset));
+    auto & arena = pImpl->filterArena();
+    arena.filters.push_back(arena.psetFilter(keyname, cmp_type, pset));
     return 0;
 }
 int
@@ -775,7 +921,9 @@ Query::addFilter(int keyname, const Dependency * reldep)
     if (!valid_filter_reldep(keyname))
         return DNF_ERROR_BAD_QUERY;
     pImpl->applied = false;
-    pImpl->filters.push_back(Filter(keyname, HY_EQ, reldep));
+    auto & arena = pImpl->filterArena();
+    Id id = reldep->getId();
+    arena.filters.push_back(arena.reldepFilter(keyname, HY_EQ, 1, &id));
     return 0;
 }
 int
@@ -784,7 +932,9 @@ Query::addFilter(int keyname, const DependencyContainer * reldeplist)
     if (!valid_filter_reldep(keyname))
         return DNF_ERROR_BAD_QUERY;
     pImpl->applied = false;
-    pImpl->filters.push_back(Filter(keyname, HY_EQ, reldeplist));
+    auto & arena = pImpl->filterArena();
+    const Queue & queue = reldeplist->getQueue();
+    arena.filters.push_back(arena.reldepFilter(keyname, HY_EQ, queue.count, queue.elements));
     return 0;
 }
 int
@@ -834,7 +984,9 @@ Query::addFilter(int keyname, int cmp_type, const char *match)
             }
         }
         default: {
-            pImpl->filters.push_back(Filter(keyname, cmp_type, match));
+            auto & arena = pImpl->filterArena();
+            arena.filters.push_back(arena.strFilter(keyname, cmp_type, 1, &match,
+                                                    dnf_sack_get_pool(pImpl->sack)));
             return 0;
         }
     }
@@ -865,7 +1017,9 @@ Query::addFilter(int keyname, int cmp_type, const char **matches)
     if (!valid_filter_str(keyname, cmp_type))
         return DNF_ERROR_BAD_QUERY;
     pImpl->applied = false;
-    pImpl->filters.push_back(Filter(keyname, cmp_type, matches));
+    auto & arena = pImpl->filterArena();
+    arena.filters.push_back(arena.strFilter(keyname, cmp_type, g_strv_length((gchar**)matches),
+                                            matches, dnf_sack_get_pool(pImpl->sack)));
     return 0;
 }
 
@@ -943,9 +1097,9 @@ Query::Impl::filterNevraStrict(int cmpType, const char **matches)
         }
     }
     if (cmpType & HY_NOT)
-        map_subtract(result->getMap(), &nevraResult);
+        bitmap::subtract(result->getMap(), &nevraResult);
     else
-        map_and(result->getMap(), &nevraResult);
+        bitmap::intersect(result->getMap(), &nevraResult);
     map_free(&nevraResult);
 }
 
@@ -967,7 +1121,7 @@ Query::Impl::initResult()
     if (!(flags & HY_IGNORE_EXCLUDES)) {
         dnf_sack_recompute_considered(sack);
         if (pool->considered)
-            map_and(result->getMap(), pool->considered);
+            bitmap::intersect(result->getMap(), pool->considered);
     }
 }
 
@@ -1024,9 +1178,8 @@ Query::Impl::filterName(const Filter & f, Map *m)
     if ((cmpType & HY_EQ) && !(cmpType & HY_ICASE)) {
         Id match_name_id = 0;
         if (f.getMatches().size() < 3) {
-            for (auto match_union : f.getMatches()) {
-                const char *match = match_union.str;
-                match_name_id = pool_str2id(pool, match, 0);
+            for (std::size_t i = 0; i < f.getMatches().size(); ++i) {
+                match_name_id = matchStrId(pool, f, i, 0);
                 if (match_name_id == 0)
                     continue;
                 Id id = -1;
@@ -1043,9 +1196,8 @@ Query::Impl::filterName(const Filter & f, Map *m)
             return;
         }
         std::vector<Id> names;
-        for (auto match_union : f.getMatches()) {
-            const char *match = match_union.str;
-            match_name_id = pool_str2id(pool, match, 0);
+        for (std::size_t i = 0; i < f.getMatches().size(); ++i) {
+            match_name_id = matchStrId(pool, f, i, 0);
             if (match_name_id == 0)
                 continue;
             names.push_back(match_name_id);
@@ -1147,8 +1299,8 @@ Query::Impl::filterEvr(const Filter & f, Map *m)
     int cmp_type = f.getCmpType();
     auto resultPset = result.get();
 
-    for (auto match : f.getMatches()) {
-        Id match_evr = pool_str2id(pool, match.str, 1);
+    for (std::size_t i = 0; i < f.getMatches().size(); ++i) {
+        Id match_evr = matchStrId(pool, f, i, 1);
 
         Id id = -1;
         while (true) {
@@ -1298,10 +1450,10 @@ Query::Impl::filterArch(const Filter & f, Map *m)
     Id match_arch_id = 0;
     auto resultPset = result.get();
 
-    for (auto match_in : f.getMatches()) {
-        const char *match = match_in.str;
+    for (std::size_t i = 0; i < f.getMatches().size(); ++i) {
+        const char *match = f.getMatches()[i].str;
         if (cmp_type & HY_EQ) {
-            match_arch_id = pool_str2id(pool, match, 0);
+            match_arch_id = matchStrId(pool, f, i, 0);
             if (match_arch_id == 0)
                 continue;
         }
@@ -1744,13 +1896,23 @@ Query::Impl::apply()
     if (applied)
         return;
 
+    Metrics::ScopedTimer timer(Metrics::Timer::QUERY_APPLY);
+    const bool metrics = Metrics::isEnabled();
     Pool *pool = dnf_sack_get_pool(sack);
     Map m;
     if (!result)
         initResult();
     map_init(&m, pool->nsolvables);
     assert(m.size == result->getMap()->size);
-    for (auto f : filters) {
+    Metrics::add(Metrics::Counter::QUERY_APPLY);
+    static const std::vector<Filter> noFilters;
+    for (const auto & f : filters ? filters->filters : noFilters) {
+        uint64_t start = 0;
+        std::size_t scanned = 0;
+        if (metrics) {
+            scanned = result->size();
+            start = Metrics::now();
+        }
         map_empty(&m);
         switch (f.getKeyname()) {
             case HY_PKG:
@@ -1836,14 +1998,17 @@ Query::Impl::apply()
                 filterDataiterator(f, &m);
         }
         if (f.getCmpType() & HY_NOT)
-            map_subtract(result->getMap(), &m);
+            bitmap::subtract(result->getMap(), &m);
         else
-            map_and(result->getMap(), &m);
+            bitmap::intersect(result->getMap(), &m);
+        if (metrics)
+            Metrics::recordFilter(f.getKeyname(), Metrics::now() - start, scanned,
+                                  result->size());
     }
     map_free(&m);
 
     applied = true;
-    filters.clear();
+    filters.reset();
 }
 
 GPtrArray *
@@ -2040,7 +2205,7 @@ Query::filterUnneeded(const libdnf::Swdb &swdb, bool debug_solver)
     for (int i = 0; i < que.size(); ++i) {
         MAPSET(&result, que[i]);
     }
-    map_and(getResult(), &result);
+    bitmap::intersect(getResult(), &result);
     map_free(&result);
     return 0;
 }
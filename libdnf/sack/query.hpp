@@ -39,6 +39,31 @@ union _Match {
     char *str;
 };
 
+class FilterArena;
+
+/**
+* @brief Matches of a Filter, they are stored in the FilterArena of the filter
+*/
+class FilterMatches {
+public:
+    FilterMatches(const _Match * matches, std::size_t count) noexcept
+    : matches(matches), count(count) {}
+    const _Match * begin() const noexcept { return matches; }
+    const _Match * end() const noexcept { return matches + count; }
+    std::size_t size() const noexcept { return count; }
+    bool empty() const noexcept { return count == 0; }
+    const _Match & operator[](std::size_t index) const noexcept { return matches[index]; }
+private:
+    const _Match * matches;
+    std::size_t count;
+};
+
+/**
+* @brief A filter of a Query or a Selector
+*
+* A Filter is a small handle. The filters added to a Query are stored in its FilterArena, the
+* filters constructed directly own an arena of their own.
+*/
 struct Filter {
 public:
     Filter(int keyname, int cmp_type, int match);
@@ -53,10 +78,25 @@ public:
     int getKeyname() const noexcept;
     int getCmpType() const noexcept;
     int getMatchType() const noexcept;
-    const std::vector<_Match> & getMatches() const noexcept;
+    FilterMatches getMatches() const noexcept;
+    /**
+    * @brief Pool Ids of the string matches, resolved when the filter was added to a Query
+    *
+    * An Id is 0 if the match is not a string, the string was not in the pool yet or the filter
+    * does not use the Ids.
+    */
+    const Id * getMatchIds() const noexcept;
 private:
-    class Impl;
-    std::shared_ptr<Impl> pImpl;
+    friend class FilterArena;
+    Filter(int keyname, int cmpType, int matchType, const _Match * matches, const Id * ids,
+           std::size_t count) noexcept;
+    int keyname;
+    int cmpType;
+    int matchType;
+    const _Match * matches;
+    const Id * ids;
+    std::size_t count;
+    std::shared_ptr<FilterArena> arena;
 };
 
 /**
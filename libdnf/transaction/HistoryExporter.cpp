@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2017-2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <fstream>
+#include <stdexcept>
+
+#include "HistoryExporter.hpp"
+#include "Types.hpp"
+
+namespace libdnf {
+
+constexpr uint32_t HistoryExporter::formatVersion;
+
+/**
+ * Write an unsigned integer of the given size in the little-endian byte order
+ */
+static void
+writeUInt(std::ostream &out, uint64_t value, std::size_t size)
+{
+    char buf[8];
+    for (std::size_t i = 0; i < size; ++i) {
+        buf[i] = static_cast< char >((value >> (8 * i)) & 0xff);
+    }
+    out.write(buf, size);
+}
+
+static void
+writeInt64(std::ostream &out, int64_t value)
+{
+    writeUInt(out, static_cast< uint64_t >(value), 8);
+}
+
+static void
+writeInt32(std::ostream &out, int64_t value)
+{
+    writeUInt(out, static_cast< uint32_t >(value), 4);
+}
+
+static void
+writeUInt8(std::ostream &out, int64_t value)
+{
+    writeUInt(out, static_cast< uint8_t >(value), 1);
+}
+
+HistoryExporter::HistoryExporter(SQLite3Ptr conn)
+  : conn(conn)
+{
+}
+
+/**
+ * Get index of the string in the string table.
+ * A string seen for the first time is written to the output as 'S' record.
+ * \param out stream to write to
+ * \param value string to look up
+ * \return index of the string
+ */
+uint32_t
+HistoryExporter::getStringIndex(std::ostream &out, const std::string &value)
+{
+    if (value.empty()) {
+        return 0;
+    }
+    auto it = strings.find(value);
+    if (it != strings.end()) {
+        return it->second;
+    }
+    uint32_t index = strings.size() + 1;
+    strings.emplace(value, index);
+    writeUInt8(out, 'S');
+    writeInt32(out, value.size());
+    out.write(value.data(), value.size());
+    return index;
+}
+
+int64_t
+HistoryExporter::exportTransactions(std::ostream &out, int64_t sinceTransactionId)
+{
+    // NULL columns are read as empty strings and 0
+    const char *trans_sql = R"**(
+        SELECT
+            id,
+            dt_begin,
+            dt_end,
+            user_id,
+            releasever,
+            cmdline,
+            state
+        FROM
+            trans
+        WHERE
+            id > ?
+        ORDER BY
+            id
+    )**";
+
+    // comps items are not exported
+    const char *item_sql = R"**(
+        SELECT
+            ti.trans_id,
+            ti.action,
+            ti.reason,
+            ti.state,
+            r.name,
+            r.epoch,
+            r.version,
+            r.release,
+            r.arch,
+            repo.repoid
+        FROM
+            trans_item ti
+            JOIN rpm r ON ti.item_id = r.item_id
+            LEFT JOIN repo ON ti.repo_id = repo.id
+        WHERE
+            ti.trans_id > ?
+        ORDER BY
+            ti.trans_id,
+            ti.id
+    )**";
+
+    strings.clear();
+
+    out.write("DNFHIST", 8);
+    writeInt32(out, formatVersion);
+    writeInt64(out, sinceTransactionId);
+
+    int64_t lastId = sinceTransactionId;
+
+    // only the newest transaction can still be running,
+    // the older ones in UNKNOWN state were interrupted and are exported as they are
+    int64_t newestId = 0;
+    SQLite3::Query newestQuery(*conn, "SELECT max(id) FROM trans");
+    if (newestQuery.step() == SQLite3::Statement::StepResult::ROW) {
+        newestId = newestQuery.get< int64_t >(0);
+    }
+
+    // both queries are ordered by transaction ID and are read side by side
+    SQLite3::Query transQuery(*conn, trans_sql);
+    transQuery.bindv(sinceTransactionId);
+    SQLite3::Query itemQuery(*conn, item_sql);
+    itemQuery.bindv(sinceTransactionId);
+    bool itemRow = itemQuery.step() == SQLite3::Statement::StepResult::ROW;
+
+    while (transQuery.step() == SQLite3::Statement::StepResult::ROW) {
+        auto id = transQuery.get< int64_t >(0);
+        auto state = transQuery.get< int >(6);
+        if (state == static_cast< int >(TransactionState::UNKNOWN) && id == newestId) {
+            // the transaction may be in progress, it's exported once it's finished
+            break;
+        }
+
+        // strings first, the transaction record must be followed only by its items
+        auto releasever = getStringIndex(out, transQuery.get< std::string >(4));
+        auto cmdline = getStringIndex(out, transQuery.get< std::string >(5));
+
+        writeUInt8(out, 'T');
+        writeInt64(out, id);
+        writeInt64(out, transQuery.get< int64_t >(1));
+        writeInt64(out, transQuery.get< int64_t >(2));
+        writeInt32(out, transQuery.get< int64_t >(3));
+        writeInt32(out, releasever);
+        writeInt32(out, cmdline);
+        writeUInt8(out, state);
+
+        // skip items of transactions which are not in the trans table
+        while (itemRow && itemQuery.get< int64_t >(0) < id) {
+            itemRow = itemQuery.step() == SQLite3::Statement::StepResult::ROW;
+        }
+
+        for (; itemRow && itemQuery.get< int64_t >(0) == id;
+             itemRow = itemQuery.step() == SQLite3::Statement::StepResult::ROW) {
+            auto name = getStringIndex(out, itemQuery.get< std::string >(4));
+            auto version = getStringIndex(out, itemQuery.get< std::string >(6));
+            auto release = getStringIndex(out, itemQuery.get< std::string >(7));
+            auto arch = getStringIndex(out, itemQuery.get< std::string >(8));
+            auto repoid = getStringIndex(out, itemQuery.get< std::string >(9));
+
+            writeUInt8(out, 'I');
+            writeInt32(out, name);
+            writeInt32(out, itemQuery.get< int64_t >(5));
+            writeInt32(out, version);
+            writeInt32(out, release);
+            writeInt32(out, arch);
+            writeInt32(out, repoid);
+            writeUInt8(out, itemQuery.get< int >(1));
+            writeUInt8(out, itemQuery.get< int >(2));
+            writeUInt8(out, itemQuery.get< int >(3));
+        }
+
+        lastId = id;
+    }
+
+    writeUInt8(out, 'E');
+    writeInt64(out, lastId);
+
+    if (!out) {
+        throw std::runtime_error("Failed to write history export");
+    }
+    return lastId;
+}
+
+int64_t
+HistoryExporter::exportTransactions(const std::string &path, int64_t sinceTransactionId)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to open history export file: " + path);
+    }
+    auto lastId = exportTransactions(out, sinceTransactionId);
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Failed to write history export file: " + path);
+    }
+    return lastId;
+}
+
+} // namespace libdnf
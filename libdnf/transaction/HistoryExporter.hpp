@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2017-2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LIBDNF_TRANSACTION_HISTORYEXPORTER_HPP
+#define LIBDNF_TRANSACTION_HISTORYEXPORTER_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "../utils/sqlite3/Sqlite3.hpp"
+
+namespace libdnf {
+
+/**
+ * Export of the RPM history into a compact binary stream.
+ *
+ * Transactions and their RPM items are read straight from the database
+ * and written as dictionary-encoded fixed-width records,
+ * so the export doesn't materialize Transaction/TransactionItem objects.
+ * Exports are incremental: only transactions newer than a given ID are written
+ * and the ID of the last exported transaction is returned for the next run.
+ *
+ * All integers are little-endian.
+ *
+ *     header:       "DNFHIST\0", uint32 format version, int64 since transaction ID
+ *     records:      uint8 record type followed by the record body
+ *       'S' string:      uint32 length, bytes
+ *       'T' transaction: int64 id, int64 dt_begin, int64 dt_end, uint32 user_id,
+ *                        uint32 releasever, uint32 cmdline, uint8 state
+ *       'I' item:        uint32 name, int32 epoch, uint32 version, uint32 release,
+ *                        uint32 arch, uint32 repoid, uint8 action, uint8 reason, uint8 state
+ *       'E' end:         int64 last exported transaction ID
+ *
+ * Strings are referred to by their index in the string table.
+ * The table starts empty in each export, index 0 is the empty string
+ * and each 'S' record appends the next index right before its first use.
+ * Items belong to the closest preceding transaction record.
+ */
+class HistoryExporter {
+public:
+    static constexpr uint32_t formatVersion = 1;
+
+    explicit HistoryExporter(SQLite3Ptr conn);
+
+    /**
+     * Export transactions with ID greater than sinceTransactionId.
+     * The newest transaction is skipped while its state is UNKNOWN, because it may be in progress,
+     * so it's exported completely by one of the following exports.
+     * Older transactions in UNKNOWN state were interrupted and are exported with that state.
+     * \param out stream to write to
+     * \param sinceTransactionId ID of the last already exported transaction
+     * \return ID of the last exported transaction (sinceTransactionId if nothing was exported)
+     */
+    int64_t exportTransactions(std::ostream &out, int64_t sinceTransactionId = 0);
+    int64_t exportTransactions(const std::string &path, int64_t sinceTransactionId = 0);
+
+protected:
+    uint32_t getStringIndex(std::ostream &out, const std::string &value);
+
+    SQLite3Ptr conn;
+    std::unordered_map< std::string, uint32_t > strings;
+};
+
+} // namespace libdnf
+
+#endif // LIBDNF_TRANSACTION_HISTORYEXPORTER_HPP
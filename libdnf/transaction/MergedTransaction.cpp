@@ -18,7 +18,10 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <algorithm>
+
 #include "MergedTransaction.hpp"
+#include "private/Transaction.hpp"
 
 namespace libdnf {
 
@@ -188,9 +191,32 @@ MergedTransaction::getItems()
 {
     ItemPairMap itemPairMap;
 
+    // load RPM items of all the stored transactions at once;
+    // transactions in progress keep their items in memory and are loaded separately
+    // (storedIds end up sorted, because transactions are kept sorted by ID)
+    std::vector< int64_t > storedIds;
+    for (auto t : transactions) {
+        if (!std::dynamic_pointer_cast< swdb_private::Transaction >(t)) {
+            storedIds.push_back(t->getId());
+        }
+    }
+    std::map< int64_t, std::vector< TransactionItemPtr > > rpmItems;
+    if (storedIds.size() > 1) {
+        rpmItems = RPMItem::getTransactionItems(transactions.front()->conn, storedIds);
+    } else {
+        storedIds.clear();
+    }
+
     // iterate over transaction
     for (auto t : transactions) {
-        auto transItems = t->getItems();
+        std::vector< TransactionItemPtr > transItems;
+        if (std::binary_search(storedIds.begin(), storedIds.end(), t->getId())) {
+            transItems = std::move(rpmItems[t->getId()]);
+            auto comps = t->getCompsItems();
+            transItems.insert(transItems.end(), comps.begin(), comps.end());
+        } else {
+            transItems = t->getItems();
+        }
         // iterate over transaction items
         for (auto transItem : transItems) {
             // get item and its type
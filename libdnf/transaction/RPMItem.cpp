@@ -23,6 +23,7 @@
 #include <sstream>
 
 #include "../hy-subject.h"
+#include "../hy-util-private.hpp"
 #include "../nevra.hpp"
 
 #include "RPMItem.hpp"
@@ -150,6 +151,107 @@ RPMItem::getTransactionItems(SQLite3Ptr conn, int64_t transaction_id)
     return result;
 }
 
+/**
+ * Load RPM transaction items of multiple transactions at once.
+ * Rows are read in batches using a single query per batch and the RPMItem objects
+ * are shared among all transaction items referring to the same item_id.
+ * \param conn database connection
+ * \param transactionIds IDs of the transactions to load items for
+ * \return map of transaction ID to its transaction items
+ */
+std::map< int64_t, std::vector< TransactionItemPtr > >
+RPMItem::getTransactionItems(SQLite3Ptr conn, const std::vector< int64_t > &transactionIds)
+{
+    // stay well below SQLITE_MAX_VARIABLE_NUMBER (999 in older sqlite versions)
+    constexpr std::size_t batchSize = 500;
+
+    std::map< int64_t, std::vector< TransactionItemPtr > > result;
+    std::map< int64_t, RPMItemPtr > itemPool;
+
+    for (std::size_t begin = 0; begin < transactionIds.size(); begin += batchSize) {
+        auto end = std::min(begin + batchSize, transactionIds.size());
+
+        std::string sql = R"**(
+            SELECT
+                ti.trans_id,
+                ti.id,
+                ti.action,
+                ti.reason,
+                ti.state,
+                r.repoid,
+                i.item_id,
+                i.name,
+                i.epoch,
+                i.version,
+                i.release,
+                i.arch
+            FROM
+                trans_item ti,
+                repo r,
+                rpm i
+            WHERE
+                ti.repo_id = r.id
+                AND ti.item_id = i.item_id
+                AND ti.trans_id IN (?)**";
+        for (auto i = begin + 1; i < end; ++i) {
+            sql += ", ?";
+        }
+        sql += R"**()
+            ORDER BY
+                ti.trans_id,
+                ti.id
+        )**";
+
+        SQLite3::Query query(*conn, sql);
+        int pos = 0;
+        for (auto i = begin; i < end; ++i) {
+            query.bind(++pos, transactionIds[i]);
+        }
+
+        // resolve column indexes once instead of looking them up for every row
+        const int transIdCol = query.getColumnIndex("trans_id");
+        const int idCol = query.getColumnIndex("id");
+        const int actionCol = query.getColumnIndex("action");
+        const int reasonCol = query.getColumnIndex("reason");
+        const int stateCol = query.getColumnIndex("state");
+        const int repoidCol = query.getColumnIndex("repoid");
+        const int itemIdCol = query.getColumnIndex("item_id");
+        const int nameCol = query.getColumnIndex("name");
+        const int epochCol = query.getColumnIndex("epoch");
+        const int versionCol = query.getColumnIndex("version");
+        const int releaseCol = query.getColumnIndex("release");
+        const int archCol = query.getColumnIndex("arch");
+
+        while (query.step() == SQLite3::Statement::StepResult::ROW) {
+            auto transID = query.get< int64_t >(transIdCol);
+            auto itemID = query.get< int64_t >(itemIdCol);
+
+            auto &item = itemPool[itemID];
+            if (!item) {
+                item = std::make_shared< RPMItem >(conn);
+                item->setId(itemID);
+                item->setName(query.get< std::string >(nameCol));
+                item->setEpoch(query.get< int >(epochCol));
+                item->setVersion(query.get< std::string >(versionCol));
+                item->setRelease(query.get< std::string >(releaseCol));
+                item->setArch(query.get< std::string >(archCol));
+            }
+
+            auto trans_item = std::make_shared< TransactionItem >(conn, transID);
+            trans_item->setItem(item);
+            trans_item->setId(query.get< int64_t >(idCol));
+            trans_item->setAction(
+                static_cast< TransactionItemAction >(query.get< int >(actionCol)));
+            trans_item->setReason(
+                static_cast< TransactionItemReason >(query.get< int >(reasonCol)));
+            trans_item->setRepoid(query.get< std::string >(repoidCol));
+            trans_item->setState(static_cast< TransactionItemState >(query.get< int >(stateCol)));
+            result[transID].push_back(trans_item);
+        }
+    }
+    return result;
+}
+
 std::string
 RPMItem::getNEVRA() const
 {
@@ -359,38 +461,125 @@ RPMItem::operator<(const RPMItem &other) const
     return false;
 }
 
+/**
+ * Append SQL condition matching an rpm column against a value from a parsed pattern.
+ * Exact values are compared for equality. Globs with a literal prefix are limited
+ * by a range over the prefix, so the index on the column can be used.
+ */
+static void
+addColumnCondition(std::string &sql,
+                   std::vector< std::string > &args,
+                   const char *column,
+                   const std::string &value)
+{
+    sql += " AND ";
+    sql += column;
+    if (!hy_is_glob_pattern(value.c_str())) {
+        sql += " = ?";
+        args.push_back(value);
+        return;
+    }
+
+    auto prefix = value.substr(0, value.find_first_of("*[?"));
+    if (!prefix.empty() && static_cast< unsigned char >(prefix.back()) < 0xff) {
+        auto upperBound = prefix;
+        upperBound.back() = upperBound.back() + 1;
+        sql += " >= ? AND ";
+        sql += column;
+        sql += " < ? AND ";
+        sql += column;
+        args.push_back(prefix);
+        args.push_back(upperBound);
+    }
+    sql += " GLOB ?";
+    args.push_back(value);
+}
+
+/**
+ * Append a subquery selecting rpm items matching the pattern in any of the NEVRA forms.
+ * \return false if the pattern can't be parsed in any form
+ */
+static bool
+addPatternSubquery(std::string &sql, std::vector< std::string > &args, const std::string &pattern)
+{
+    bool parsed = false;
+    for (auto form = HY_FORMS_MOST_SPEC; *form != _HY_FORM_STOP_; ++form) {
+        Nevra nevra;
+        if (!nevra.parse(pattern.c_str(), *form)) {
+            continue;
+        }
+        if (!sql.empty()) {
+            sql += " UNION ";
+        }
+        sql += "SELECT item_id FROM rpm WHERE 1";
+        addColumnCondition(sql, args, "name", nevra.getName());
+        if (nevra.getEpoch() != Nevra::EPOCH_NOT_SET) {
+            sql += " AND epoch = " + std::to_string(nevra.getEpoch());
+        }
+        if (!nevra.getVersion().empty()) {
+            addColumnCondition(sql, args, "version", nevra.getVersion());
+        }
+        if (!nevra.getRelease().empty()) {
+            addColumnCondition(sql, args, "release", nevra.getRelease());
+        }
+        if (!nevra.getArch().empty()) {
+            addColumnCondition(sql, args, "arch", nevra.getArch());
+        }
+        parsed = true;
+    }
+    return parsed;
+}
+
+/**
+ * Search for transactions containing RPMs matching given patterns.
+ * Each pattern is parsed in all the NEVRA forms and may contain globs.
+ * Patterns are searched in batches, each batch using a single query.
+ * \param conn database connection
+ * \param patterns list of package names, NEVRAs or globs
+ * \return sorted list of IDs of successfully finished transactions
+ */
 std::vector< int64_t >
 RPMItem::searchTransactions(SQLite3Ptr conn, const std::vector< std::string > &patterns)
 {
+    // every pattern takes up to 5 forms with 12 parameters each;
+    // stay below SQLITE_MAX_VARIABLE_NUMBER (999 in older sqlite versions)
+    constexpr std::size_t batchSize = 16;
+
     std::vector< int64_t > result;
 
-    const char *sql = R"**(
-        SELECT DISTINCT
-            t.id
-        FROM
-            trans t,
-            trans_item ti,
-            rpm i
-        WHERE
-            t.state = 1
-            AND ti.item_id = i.item_id
-            AND (
-                i.name = ?
-                OR i.epoch = ?
-                OR i.version = ?
-                OR i.release = ?
-                OR i.arch = ?
-            )
-        ORDER BY
-           trans_id DESC
-    )**";
-    SQLite3::Query query(*conn, sql);
-    for (auto pattern : patterns) {
-        query.bindv(pattern, pattern, pattern, pattern, pattern);
+    for (std::size_t begin = 0; begin < patterns.size(); begin += batchSize) {
+        auto end = std::min(begin + batchSize, patterns.size());
+
+        std::string subqueries;
+        std::vector< std::string > args;
+        for (auto i = begin; i < end; ++i) {
+            addPatternSubquery(subqueries, args, patterns[i]);
+        }
+        if (subqueries.empty()) {
+            continue;
+        }
+
+        std::string sql = R"**(
+            SELECT DISTINCT
+                ti.trans_id as id
+            FROM
+                trans_item ti
+            JOIN
+                trans t ON ti.trans_id = t.id
+            WHERE
+                t.state = 1
+                AND ti.item_id IN ()**" + subqueries + R"**()
+        )**";
+        SQLite3::Query query(*conn, sql);
+        int pos = 0;
+        for (auto &arg : args) {
+            query.bind(++pos, arg);
+        }
         while (query.step() == SQLite3::Statement::StepResult::ROW) {
             result.push_back(query.get< int64_t >("id"));
         }
     }
+
     std::sort(result.begin(), result.end());
     auto last = std::unique(result.begin(), result.end());
     result.erase(last, result.end());
@@ -21,6 +21,7 @@
 #ifndef LIBDNF_TRANSACTION_RPMITEM_HPP
 #define LIBDNF_TRANSACTION_RPMITEM_HPP
 
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -65,6 +66,8 @@ public:
     static std::vector< int64_t > searchTransactions(SQLite3Ptr conn, const std::vector< std::string > &patterns);
     static std::vector< TransactionItemPtr > getTransactionItems(SQLite3Ptr conn,
                                                                  int64_t transaction_id);
+    static std::map< int64_t, std::vector< TransactionItemPtr > >
+    getTransactionItems(SQLite3Ptr conn, const std::vector< int64_t > &transactionIds);
     static TransactionItemReason resolveTransactionItemReason(SQLite3Ptr conn,
                                                               const std::string &name,
                                                               const std::string &arch,
@@ -32,12 +32,15 @@
 #include "../utils/filesystem.hpp"
 #include "../utils/sqlite3/Sqlite3.hpp"
 
+#include "HistoryExporter.hpp"
 #include "RPMItem.hpp"
 #include "Swdb.hpp"
 #include "Transformer.hpp"
 
 namespace libdnf {
 
+constexpr int Swdb::defaultBusyTimeout;
+
 Swdb::Swdb(SQLite3Ptr conn)
   : conn{conn}
   , autoClose(true)
@@ -127,6 +130,12 @@ Swdb::endTransaction(int64_t dtEnd, std::string rpmdbVersionEnd, TransactionStat
     int64_t result = transactionInProgress->getId();
     transactionInProgress = std::unique_ptr< swdb_private::Transaction >(nullptr);
     itemsInProgress.clear();
+    // keep the write-ahead log short; passive checkpoint doesn't wait for readers
+    try {
+        conn->walCheckpoint();
+    } catch (SQLite3::LibException &) {
+        // the transaction is committed already, the next checkpoint catches up
+    }
     return result;
 }
 
@@ -255,19 +264,29 @@ Swdb::getLastTransaction()
 std::vector< TransactionPtr >
 Swdb::listTransactions()
 {
+    // load all the transactions in a single query instead of selecting them one by one
     const char *sql = R"**(
         SELECT
-            id
+            id,
+            dt_begin,
+            dt_end,
+            rpmdb_version_begin,
+            rpmdb_version_end,
+            releasever,
+            user_id,
+            cmdline,
+            state
         FROM
             trans
         ORDER BY
             id
     )**";
-    SQLite3::Statement query(*conn, sql);
+    SQLite3::Query query(*conn, sql);
     std::vector< TransactionPtr > result;
     while (query.step() == SQLite3::Statement::StepResult::ROW) {
-        auto transId = query.get< int64_t >(0);
-        auto transaction = std::make_shared< Transaction >(conn, transId);
+        auto transaction = TransactionPtr(new Transaction(conn));
+        transaction->id = query.get< int64_t >("id");
+        transaction->dbLoad(query);
         result.push_back(transaction);
     }
     return result;
@@ -484,24 +503,49 @@ Swdb::createCompsGroupItem()
     return std::make_shared< CompsGroupItem >(conn);
 }
 
-Swdb::Swdb(const std::string &path)
-  : conn(nullptr)
-  , autoClose(true)
+/**
+ * Create the database at path from the legacy history in its directory if it doesn't exist
+ */
+static void
+migrate(const std::string &path, Transformer::ProgressCallback progress)
 {
     // check if DB file is present
-    if (!pathExists(path.c_str())) {
-        // file not present
+    if (pathExists(path.c_str())) {
+        return;
+    }
 
-        // extract persistdir from path - "/var/lib/dnf/"
-        auto found = path.find_last_of("/");
+    // extract persistdir from path - "/var/lib/dnf/"
+    auto found = path.find_last_of("/");
 
-        Transformer transformer(path.substr(0, found), path);
-        transformer.transform();
+    Transformer transformer(path.substr(0, found), path);
+    transformer.setProgressCallback(progress);
+    transformer.transform();
+}
 
-        conn = std::make_shared< SQLite3 >(path);
-    } else {
-        conn = std::make_shared< SQLite3 >(path);
+Swdb::Swdb(const std::string &path, Transformer::ProgressCallback progress)
+  : conn(nullptr)
+  , autoClose(true)
+{
+    migrate(path, progress);
+    conn = std::make_shared< SQLite3 >(path, SQLite3::Mode::DEFAULT, defaultBusyTimeout);
+}
+
+Swdb::Swdb(const std::string &path,
+           bool readOnly,
+           bool wal,
+           Transformer::ProgressCallback progress)
+  : conn(nullptr)
+  , autoClose(true)
+{
+    if (readOnly) {
+        conn = std::make_shared< SQLite3 >(path, SQLite3::Mode::READ_ONLY, defaultBusyTimeout);
+        return;
     }
+
+    migrate(path, progress);
+
+    auto mode = wal ? SQLite3::Mode::WAL : SQLite3::Mode::DEFAULT;
+    conn = std::make_shared< SQLite3 >(path, mode, defaultBusyTimeout);
 }
 
 /**
@@ -537,4 +581,11 @@ Swdb::searchTransactionsByRPM(const std::vector< std::string > &patterns)
     return RPMItem::searchTransactions(conn, patterns);
 }
 
+int64_t
+Swdb::exportTransactions(const std::string &path, int64_t sinceTransactionId)
+{
+    HistoryExporter exporter(conn);
+    return exporter.exportTransactions(path, sinceTransactionId);
+}
+
 } // namespace libdnf
@@ -40,6 +40,7 @@ class Transformer;
 #include "CompsGroupItem.hpp"
 #include "Transaction.hpp"
 #include "TransactionItem.hpp"
+#include "Transformer.hpp"
 #include "private/Transaction.hpp"
 
 namespace libdnf {
@@ -47,7 +48,35 @@ namespace libdnf {
 class Swdb {
 public:
     explicit Swdb(SQLite3Ptr conn);
-    explicit Swdb(const std::string &path);
+
+    /**
+    * @brief Open history database, migrate the legacy yum history first if it doesn't exist
+    *
+    * @param path path to the database
+    * @param progress called after each migrated transaction with the number of migrated
+    *                 transactions and the number of all of them
+    */
+    explicit Swdb(const std::string &path, Transformer::ProgressCallback progress = nullptr);
+
+    /**
+    * @brief Open history database in read-only or write-ahead logging mode
+    *
+    * Read-only instances require an existing database and don't migrate the legacy yum history.
+    * In WAL mode readers and the writer don't block each other and readers keep
+    * a consistent snapshot for the whole duration of their read transaction.
+    * With the rollback journal a writer has to wait until the read transactions end
+    * and a reader until the writer commits, both wait up to defaultBusyTimeout.
+    *
+    * @param path path to the database
+    * @param readOnly open the database read-only, its journal mode is kept untouched
+    * @param wal switch the database to write-ahead logging (ignored if readOnly is set),
+    *            without it a database already in WAL mode is kept in it
+    * @param progress called after each migrated transaction like in Swdb(path, progress)
+    */
+    Swdb(const std::string &path,
+         bool readOnly,
+         bool wal = false,
+         Transformer::ProgressCallback progress = nullptr);
     ~Swdb();
 
     SQLite3Ptr getConn() { return conn; }
@@ -56,6 +85,8 @@ public:
     // FIXME load this from conf
     static constexpr const char *defaultPath = "/var/lib/dnf/history.sqlite";
     static constexpr const char *defaultDatabaseName = "history.sqlite";
+    // how long the connections wait for a lock [ms]
+    static constexpr int defaultBusyTimeout = 10000;
 
     const std::string &getPath() { return conn->getPath(); }
     void resetDatabase();
@@ -108,6 +139,17 @@ public:
     std::vector< TransactionItemPtr > getCompsEnvironmentItemsByPattern(const std::string &pattern);
     std::vector< std::string > getCompsGroupEnvironments(const std::string &groupId);
 
+    /**
+    * @brief Export finished transactions newer than sinceTransactionId into a compact binary file
+    *
+    * See HistoryExporter for the format description.
+    *
+    * @param path path to the export file, it's overwritten
+    * @param sinceTransactionId ID of the last already exported transaction
+    * @return ID of the last exported transaction
+    */
+    int64_t exportTransactions(const std::string &path, int64_t sinceTransactionId = 0);
+
     // misc
     void setReleasever(std::string value);
     void addConsoleOutputLine(int fileDescriptor, std::string line);
@@ -92,6 +92,16 @@ Transaction::dbSelect(int64_t pk)
     query.step();
 
     id = pk;
+    dbLoad(query);
+}
+
+/**
+ * Fill the transaction attributes from the current row of a query over the trans table.
+ * \param query query positioned at a row containing the trans table columns
+ */
+void
+Transaction::dbLoad(SQLite3::Query &query)
+{
     dtBegin = query.get< int >("dt_begin");
     dtEnd = query.get< int >("dt_end");
     rpmdbVersionBegin = query.get< std::string >("rpmdb_version_begin");
@@ -113,6 +123,20 @@ Transaction::getItems()
     auto rpms = RPMItem::getTransactionItems(conn, getId());
     result.insert(result.end(), rpms.begin(), rpms.end());
 
+    auto comps = getCompsItems();
+    result.insert(result.end(), comps.begin(), comps.end());
+
+    return result;
+}
+
+/**
+ * Loader for the comps group and environment transaction items.
+ * \return list of comps transaction items associated with the transaction
+ */
+std::vector< TransactionItemPtr >
+Transaction::getCompsItems()
+{
+    std::vector< TransactionItemPtr > result;
     auto comps_groups = CompsGroupItem::getTransactionItems(conn, getId());
     result.insert(result.end(), comps_groups.begin(), comps_groups.end());
 
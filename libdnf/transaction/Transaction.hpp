@@ -63,8 +63,12 @@ public:
 protected:
     explicit Transaction(SQLite3Ptr conn);
     void dbSelect(int64_t transaction_id);
+    void dbLoad(SQLite3::Query &query);
+    std::vector< TransactionItemPtr > getCompsItems();
     std::set< std::shared_ptr< RPMItem > > softwarePerformedWith;
 
+    friend class MergedTransaction;
+    friend class Swdb;
     friend class TransactionItem;
     SQLite3Ptr conn;
 
@@ -133,6 +133,7 @@ Transformer::transform()
         history->exec("CREATE INDEX IF NOT EXISTS i_trans_cmdline_tid ON trans_cmdline(tid);");
         history->exec("CREATE INDEX IF NOT EXISTS i_trans_data_pkgs_tid ON trans_data_pkgs(tid);");
         history->exec("CREATE INDEX IF NOT EXISTS i_trans_script_stdout_tid ON trans_script_stdout(tid);");
+        history->exec("CREATE INDEX IF NOT EXISTS i_trans_error_tid ON trans_error(tid);");
         history->exec("CREATE INDEX IF NOT EXISTS i_trans_with_pkgs_tid_pkgtupid ON trans_with_pkgs(tid, pkgtupid);");
 
         // transform objects
@@ -150,14 +151,154 @@ Transformer::transform()
 }
 
 /**
- * Transform transactions from the history database
+ * Record of a package from the history database
+ */
+struct Transformer::LegacyPackage {
+    int64_t pkgtupid;
+    std::string name;
+    int64_t epoch;
+    std::string version;
+    std::string release;
+    std::string arch;
+    // trans_data_pkgs only
+    std::string state;
+    std::string done;
+};
+
+/**
+ * History database data of a batch of transactions, grouped by transaction ID
+ */
+struct Transformer::LegacyBatch {
+    std::map< int64_t, std::vector< LegacyPackage > > packages;
+    std::map< int64_t, std::vector< LegacyPackage > > softwarePerformedWith;
+    std::map< int64_t, std::vector< std::pair< int, std::string > > > output;
+};
+
+static void
+fillLegacyPackage(Transformer::LegacyPackage &pkg, SQLite3::Query &query)
+{
+    pkg.pkgtupid = query.get< int64_t >("pkgtupid");
+    pkg.name = query.get< std::string >("name");
+    pkg.epoch = query.get< int64_t >("epoch");
+    pkg.version = query.get< std::string >("version");
+    pkg.release = query.get< std::string >("release");
+    pkg.arch = query.get< std::string >("arch");
+}
+
+/**
+ * Load packages, software performed with and console output of transactions
+ * with IDs in the given range using a single query per table.
+ * Rows are read in the order the per-transaction queries used to return them.
+ */
+static void
+loadLegacyBatch(SQLite3Ptr history, int64_t firstId, int64_t lastId, Transformer::LegacyBatch &batch)
+{
+    // the order is important here - its Update, Updated
+    const char *pkg_sql = R"**(
+        SELECT
+            t.tid,
+            t.state,
+            t.done,
+            r.pkgtupid,
+            r.name,
+            r.epoch,
+            r.version,
+            r.release,
+            r.arch
+        FROM
+            trans_data_pkgs t
+            JOIN pkgtups r using(pkgtupid)
+        WHERE
+            t.tid BETWEEN ? AND ?
+        ORDER BY
+            t.tid,
+            t.rowid
+    )**";
+
+    SQLite3::Query pkgQuery(*history, pkg_sql);
+    pkgQuery.bindv(firstId, lastId);
+    while (pkgQuery.step() == SQLite3::Statement::StepResult::ROW) {
+        Transformer::LegacyPackage pkg;
+        fillLegacyPackage(pkg, pkgQuery);
+        pkg.state = pkgQuery.get< std::string >("state");
+        pkg.done = pkgQuery.get< std::string >("done");
+        batch.packages[pkgQuery.get< int64_t >("tid")].push_back(std::move(pkg));
+    }
+
+    const char *with_sql = R"**(
+        SELECT
+            tid,
+            pkgtupid,
+            name,
+            epoch,
+            version,
+            release,
+            arch
+        FROM
+            trans_with_pkgs
+            JOIN pkgtups using (pkgtupid)
+        WHERE
+            tid BETWEEN ? AND ?
+        ORDER BY
+            tid,
+            pkgtupid
+    )**";
+
+    SQLite3::Query withQuery(*history, with_sql);
+    withQuery.bindv(firstId, lastId);
+    while (withQuery.step() == SQLite3::Statement::StepResult::ROW) {
+        Transformer::LegacyPackage pkg;
+        fillLegacyPackage(pkg, withQuery);
+        batch.softwarePerformedWith[withQuery.get< int64_t >("tid")].push_back(std::move(pkg));
+    }
+
+    // stdout lines go first, then errors; both in the original order
+    const char *output_sql = R"**(
+        SELECT
+            tid,
+            1 as fd,
+            lid as pos,
+            line
+        FROM
+            trans_script_stdout
+        WHERE
+            tid BETWEEN ? AND ?
+        UNION ALL
+        SELECT
+            tid,
+            2 as fd,
+            mid as pos,
+            msg as line
+        FROM
+            trans_error
+        WHERE
+            tid BETWEEN ? AND ?
+        ORDER BY
+            tid,
+            fd,
+            pos
+    )**";
+
+    SQLite3::Query outputQuery(*history, output_sql);
+    outputQuery.bindv(firstId, lastId, firstId, lastId);
+    while (outputQuery.step() == SQLite3::Statement::StepResult::ROW) {
+        batch.output[outputQuery.get< int64_t >("tid")].emplace_back(
+            outputQuery.get< int >("fd"), outputQuery.get< std::string >("line"));
+    }
+}
+
+/**
+ * Transform transactions from the history database.
+ * Data are read in batches of transactions and written into swdb
+ * in a single database transaction.
  * \param swdb pointer to swdb SQLite3 object
  * \param swdb pointer to history database SQLite3 object
  */
 void
 Transformer::transformTrans(SQLite3Ptr swdb, SQLite3Ptr history)
 {
-    std::vector< std::shared_ptr< TransformerTransaction > > result;
+    // number of transactions whose data are loaded at once
+    constexpr std::size_t batchSize = 256;
 
     // we need to left join with trans_cmdline
     // there is no cmdline for certain transactions (e.g. 1)
@@ -191,6 +332,20 @@ Transformer::transformTrans(SQLite3Ptr swdb, SQLite3Ptr history)
             yumdb_key='releasever'
     )**";
 
+    const char *count_sql = R"**(
+        SELECT
+            COUNT(*) as count
+        FROM
+            trans_beg tb
+            JOIN trans_end te using(tid)
+    )**";
+
+    int64_t total = 0;
+    SQLite3::Query count_query(*history.get(), count_sql);
+    if (count_query.step() == SQLite3::Statement::StepResult::ROW) {
+        total = count_query.get< int64_t >("count");
+    }
+
     // get release version for all the transactions
     std::map< int64_t, std::string > releasever;
     SQLite3::Query releasever_query(*history.get(), releasever_sql);
@@ -199,151 +354,148 @@ Transformer::transformTrans(SQLite3Ptr swdb, SQLite3Ptr history)
         releasever[releasever_query.get< int64_t >("tid")] = releaseVerStr;
     }
 
-    // iterate over history transactions
-    SQLite3::Query query(*history.get(), trans_sql);
-    while (query.step() == SQLite3::Statement::StepResult::ROW) {
-        auto trans = std::make_shared< TransformerTransaction >(swdb);
-        trans->setId(query.get< int >("id"));
-        trans->setDtBegin(query.get< int64_t >("dt_begin"));
-        trans->setDtEnd(query.get< int64_t >("dt_end"));
-        trans->setRpmdbVersionBegin(query.get< std::string >("rpmdb_version_begin"));
-        trans->setRpmdbVersionEnd(query.get< std::string >("rpmdb_version_end"));
-
-        // set release version if available
-        auto it = releasever.find(trans->getId());
-        if (it != releasever.end()) {
-            trans->setReleasever(it->second);
+    // get reason and from_repo for all the packages
+    YumdbData yumdb;
+    loadYumdbData(history, yumdb);
+
+    // RPM items which were already saved, by pkgtupid
+    std::map< int64_t, RPMItemPtr > rpmItems;
+
+    std::vector< std::pair< std::shared_ptr< TransformerTransaction >, TransactionState > > batch;
+    int64_t done = 0;
+
+    auto transformBatch = [&]() {
+        if (batch.empty()) {
+            return;
         }
+        LegacyBatch data;
+        loadLegacyBatch(history, batch.front().first->getId(), batch.back().first->getId(), data);
 
-        trans->setUserId(query.get< int >("user_id"));
-        trans->setCmdline(query.get< std::string >("cmdline"));
+        for (auto &transState : batch) {
+            auto trans = transState.first;
+            auto id = trans->getId();
 
-        TransactionState state = query.get< int >("state") == 0 ? TransactionState::DONE : TransactionState::ERROR;
+            transformRPMItems(swdb, trans, data.packages[id], yumdb, rpmItems);
+            transformTransWith(swdb, trans, data.softwarePerformedWith[id], rpmItems);
 
-        transformRPMItems(swdb, history, trans);
-        transformTransWith(swdb, history, trans);
+            trans->begin();
 
-        trans->begin();
+            for (auto &line : data.output[id]) {
+                trans->addConsoleOutputLine(line.first, line.second);
+            }
 
-        transformOutput(history, trans);
+            trans->finish(transState.second);
+
+            if (progressCallback) {
+                progressCallback(++done, total);
+            }
+        }
+        batch.clear();
+    };
 
-        trans->finish(state);
+    // write everything in a single database transaction
+    swdb->exec("BEGIN");
+    try {
+        // iterate over history transactions
+        SQLite3::Query query(*history.get(), trans_sql);
+        while (query.step() == SQLite3::Statement::StepResult::ROW) {
+            auto trans = std::make_shared< TransformerTransaction >(swdb);
+            trans->setId(query.get< int >("id"));
+            trans->setDtBegin(query.get< int64_t >("dt_begin"));
+            trans->setDtEnd(query.get< int64_t >("dt_end"));
+            trans->setRpmdbVersionBegin(query.get< std::string >("rpmdb_version_begin"));
+            trans->setRpmdbVersionEnd(query.get< std::string >("rpmdb_version_end"));
+
+            // set release version if available
+            auto it = releasever.find(trans->getId());
+            if (it != releasever.end()) {
+                trans->setReleasever(it->second);
+            }
+
+            trans->setUserId(query.get< int >("user_id"));
+            trans->setCmdline(query.get< std::string >("cmdline"));
+
+            TransactionState state = query.get< int >("state") == 0 ? TransactionState::DONE : TransactionState::ERROR;
+
+            batch.emplace_back(trans, state);
+            if (batch.size() == batchSize) {
+                transformBatch();
+            }
+        }
+        transformBatch();
+    } catch (...) {
+        swdb->exec("ROLLBACK");
+        throw;
     }
+    swdb->exec("COMMIT");
 }
 
-static void
-fillRPMItem(std::shared_ptr< RPMItem > rpm, SQLite3::Query &query)
+/**
+ * Get RPM item for a package from the history database.
+ * Each package is saved only once and then reused from the rpmItems cache.
+ */
+static RPMItemPtr
+getRPMItem(SQLite3Ptr swdb,
+           const Transformer::LegacyPackage &pkg,
+           std::map< int64_t, RPMItemPtr > &rpmItems)
 {
-    rpm->setName(query.get< std::string >("name"));
-    rpm->setEpoch(query.get< int64_t >("epoch"));
-    rpm->setVersion(query.get< std::string >("version"));
-    rpm->setRelease(query.get< std::string >("release"));
-    rpm->setArch(query.get< std::string >("arch"));
-    rpm->save();
+    auto &rpm = rpmItems[pkg.pkgtupid];
+    if (!rpm) {
+        rpm = std::make_shared< RPMItem >(swdb);
+        rpm->setName(pkg.name);
+        rpm->setEpoch(pkg.epoch);
+        rpm->setVersion(pkg.version);
+        rpm->setRelease(pkg.release);
+        rpm->setArch(pkg.arch);
+        rpm->save();
+    }
+    return rpm;
 }
 
 /**
  * Transform binding between a Transaction and packages, which performed the transaction.
  * \param swdb pointer to swdb SQLite3 object
- * \param swdb pointer to history database SQLite3 object
+ * \param packages packages which performed the transaction
+ * \param rpmItems cache of already saved RPM items
  */
 void
 Transformer::transformTransWith(SQLite3Ptr swdb,
-                                SQLite3Ptr history,
-                                std::shared_ptr< TransformerTransaction > trans)
+                                std::shared_ptr< TransformerTransaction > trans,
+                                const std::vector< LegacyPackage > &packages,
+                                std::map< int64_t, RPMItemPtr > &rpmItems)
 {
-    const char *sql = R"**(
-        SELECT
-            name,
-            epoch,
-            version,
-            release,
-            arch
-        FROM
-            trans_with_pkgs
-            JOIN pkgtups using (pkgtupid)
-        WHERE
-            tid=?
-    )**";
-
-    // transform stdout
-    SQLite3::Query query(*history.get(), sql);
-    query.bindv(trans->getId());
-    while (query.step() == SQLite3::Statement::StepResult::ROW) {
-        // create RPM item object
-        auto rpm = std::make_shared< RPMItem >(swdb);
-        fillRPMItem(rpm, query);
-        trans->addSoftwarePerformedWith(rpm);
+    for (auto &pkg : packages) {
+        trans->addSoftwarePerformedWith(getRPMItem(swdb, pkg, rpmItems));
     }
 }
 
 /**
- * Transform transaction console outputs.
- * \param swdb pointer to history database SQLite3 object
+ * Load reason and repoid data of all the packages from yumdb.
+ * \param history pointer to history database SQLite3 object
+ * \param yumdb map to be filled, by pkgtupid
  */
 void
-Transformer::transformOutput(SQLite3Ptr history, std::shared_ptr< TransformerTransaction > trans)
-{
-    const char *sql = R"**(
-        SELECT
-            line
-        FROM
-            trans_script_stdout
-        WHERE
-            tid = ?
-        ORDER BY
-            lid
-    )**";
-
-    // transform stdout
-    SQLite3::Query query(*history.get(), sql);
-    query.bindv(trans->getId());
-    while (query.step() == SQLite3::Statement::StepResult::ROW) {
-        trans->addConsoleOutputLine(1, query.get< std::string >("line"));
-    }
-
-    sql = R"**(
-        SELECT
-            msg
-        FROM
-            trans_error
-        WHERE
-            tid = ?
-        ORDER BY
-            mid
-    )**";
-
-    // transform stderr
-    SQLite3::Query errorQuery(*history.get(), sql);
-    errorQuery.bindv(trans->getId());
-    while (errorQuery.step() == SQLite3::Statement::StepResult::ROW) {
-        trans->addConsoleOutputLine(2, errorQuery.get< std::string >("msg"));
-    }
-}
-
-static void
-getYumdbData(int64_t itemId, SQLite3Ptr history, TransactionItemReason &reason, std::string &repoid)
+Transformer::loadYumdbData(SQLite3Ptr history, YumdbData &yumdb)
 {
     const char *sql = R"**(
         SELECT
+            pkgtupid,
             yumdb_key as key,
             yumdb_val as value
         FROM
             pkg_yumdb
         WHERE
-            pkgtupid=?
-            and key IN ('reason', 'from_repo')
+            key IN ('reason', 'from_repo')
     )**";
 
-    // load reason and repoid data from yumdb
     SQLite3::Query query(*history.get(), sql);
-    query.bindv(itemId);
     while (query.step() == SQLite3::Statement::StepResult::ROW) {
+        auto &data = yumdb[query.get< int64_t >("pkgtupid")];
         std::string key = query.get< std::string >("key");
         if (key == "reason") {
-            reason = Transformer::getReason(query.get< std::string >("value"));
+            data.first = Transformer::getReason(query.get< std::string >("value"));
         } else if (key == "from_repo") {
-            repoid = query.get< std::string >("value");
+            data.second = query.get< std::string >("value");
         }
     }
 }
@@ -351,35 +503,18 @@ getYumdbData(int64_t itemId, SQLite3Ptr history, TransactionItemReason &reason,
 /**
  * Transform RPM Items from a particular transaction.
  * \param swdb pointer to swdb SQLite3 object
- * \param swdb pointer to history database SQLite3 objects
  * \param trans Transaction whose items should be transformed
+ * \param packages packages of the transaction, in the history database order
+ * \param yumdb reason and repoid data of the packages
+ * \param rpmItems cache of already saved RPM items
  */
 void
 Transformer::transformRPMItems(SQLite3Ptr swdb,
-                               SQLite3Ptr history,
-                               std::shared_ptr< TransformerTransaction > trans)
+                               std::shared_ptr< TransformerTransaction > trans,
+                               const std::vector< LegacyPackage > &packages,
+                               const YumdbData &yumdb,
+                               std::map< int64_t, RPMItemPtr > &rpmItems)
 {
-    // the order is important here - its Update, Updated
-    const char *pkg_sql = R"**(
-        SELECT
-            t.state,
-            t.done,
-            r.pkgtupid as id,
-            r.name,
-            r.epoch,
-            r.version,
-            r.release,
-            r.arch
-        FROM
-            trans_data_pkgs t
-            JOIN pkgtups r using(pkgtupid)
-        WHERE
-            t.tid=?
-    )**";
-
-    SQLite3::Query query(*history.get(), pkg_sql);
-    query.bindv(trans->getId());
-
     TransactionItemPtr last = nullptr;
 
     /*
@@ -393,15 +528,13 @@ Transformer::transformRPMItems(SQLite3Ptr swdb,
     std::map< int64_t, TransactionItemPtr > obsoletedItems;
 
     // interate over transaction packages in the history database
-    while (query.step() == SQLite3::Statement::StepResult::ROW) {
+    for (auto &pkg : packages) {
 
         // create RPM item object
-        auto rpm = std::make_shared< RPMItem >(swdb);
-        fillRPMItem(rpm, query);
+        auto rpm = getRPMItem(swdb, pkg, rpmItems);
 
         // get item state/action
-        std::string stateString = query.get< std::string >("state");
-        TransactionItemAction action = actions.at(stateString);
+        TransactionItemAction action = actions.at(pkg.state);
 
         // `Obsoleting` record is duplicit with previous record (with different action)
         if (action == TransactionItemAction::OBSOLETE) {
@@ -416,14 +549,18 @@ Transformer::transformRPMItems(SQLite3Ptr swdb,
         if (pastObsoleted == obsoletedItems.end()) {
             // item hasn't been obsoleted yet
 
-            // load reason and from_repo
+            // reason and from_repo
             TransactionItemReason reason = TransactionItemReason::UNKNOWN;
             std::string repoid;
-            getYumdbData(query.get< int64_t >("id"), history, reason, repoid);
+            auto yumdbData = yumdb.find(pkg.pkgtupid);
+            if (yumdbData != yumdb.end()) {
+                reason = yumdbData->second.first;
+                repoid = yumdbData->second.second;
+            }
 
             // add TransactionItem object
             transItem = trans->addItem(rpm, repoid, action, reason);
-            transItem->setState(query.get< std::string >("done") == "TRUE" ? TransactionItemState::DONE : TransactionItemState::ERROR);
+            transItem->setState(pkg.done == "TRUE" ? TransactionItemState::DONE : TransactionItemState::ERROR);
         } else {
             // item has been obsoleted - we just need to update the action
             transItem = pastObsoleted->second;
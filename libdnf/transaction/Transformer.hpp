@@ -21,7 +21,9 @@
 #ifndef LIBDNF_TRANSACTION_TRANSFORMER_HPP
 #define LIBDNF_TRANSACTION_TRANSFORMER_HPP
 
+#include <functional>
 #include <json.h>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -53,8 +55,18 @@ public:
         }
     };
 
+    /**
+     * Called after each transformed transaction
+     * with number of processed transactions and number of all transactions
+     */
+    typedef std::function< void(int64_t, int64_t) > ProgressCallback;
+
+    struct LegacyPackage;
+    struct LegacyBatch;
+
     Transformer(const std::string &inputDir, const std::string &outputFile);
     void transform();
+    void setProgressCallback(ProgressCallback callback) { progressCallback = callback; }
 
     static void createDatabase(SQLite3Ptr conn);
 
@@ -67,13 +79,19 @@ protected:
     void processGroupPersistor(SQLite3Ptr swdb, struct json_object *root);
 
 private:
+    // reason and repoid, by pkgtupid
+    typedef std::map< int64_t, std::pair< TransactionItemReason, std::string > > YumdbData;
+
+    void loadYumdbData(SQLite3Ptr history, YumdbData &yumdb);
     void transformRPMItems(SQLite3Ptr swdb,
-                           SQLite3Ptr history,
-                           std::shared_ptr< TransformerTransaction > trans);
-    void transformOutput(SQLite3Ptr history, std::shared_ptr< TransformerTransaction > trans);
+                           std::shared_ptr< TransformerTransaction > trans,
+                           const std::vector< LegacyPackage > &packages,
+                           const YumdbData &yumdb,
+                           std::map< int64_t, RPMItemPtr > &rpmItems);
     void transformTransWith(SQLite3Ptr swdb,
-                            SQLite3Ptr history,
-                            std::shared_ptr< TransformerTransaction > trans);
+                            std::shared_ptr< TransformerTransaction > trans,
+                            const std::vector< LegacyPackage > &packages,
+                            std::map< int64_t, RPMItemPtr > &rpmItems);
     CompsGroupItemPtr processGroup(SQLite3Ptr swdb,
                                    const char *groupId,
                                    struct json_object *group);
@@ -84,6 +102,7 @@ private:
     const std::string inputDir;
     const std::string outputFile;
     const std::string transformFile;
+    ProgressCallback progressCallback;
 };
 
 } // namespace libdnf
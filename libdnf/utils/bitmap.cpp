@@ -0,0 +1,426 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "bitmap.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BITMAP_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace libdnf {
+
+namespace bitmap {
+
+namespace {
+
+struct Kernels {
+    Isa isa;
+    std::size_t (*count)(const unsigned char * map, std::size_t size);
+    void (*intersect)(unsigned char * target, const unsigned char * source, std::size_t size);
+    void (*unite)(unsigned char * target, const unsigned char * source, std::size_t size);
+    void (*subtract)(unsigned char * target, const unsigned char * source, std::size_t size);
+    std::size_t (*toIds)(const unsigned char * map, std::size_t size, Id * ids);
+};
+
+inline uint64_t
+load(const unsigned char * bytes)
+{
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+    return word;
+}
+
+inline void
+store(unsigned char * bytes, uint64_t word)
+{
+    memcpy(bytes, &word, sizeof(word));
+}
+
+// bit i of the map is bit i of the word, (map[i >> 3] >> (i & 7)) & 1 in libsolv
+inline uint64_t
+loadBits(const unsigned char * bytes)
+{
+    uint64_t word = load(bytes);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+std::size_t
+countGeneric(const unsigned char * map, std::size_t size)
+{
+    std::size_t count = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+        count += __builtin_popcountll(load(map + i));
+    for (; i < size; ++i)
+        count += __builtin_popcount(map[i]);
+    return count;
+}
+
+void
+intersectGeneric(unsigned char * target, const unsigned char * source, std::size_t size)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+        store(target + i, load(target + i) & load(source + i));
+    for (; i < size; ++i)
+        target[i] &= source[i];
+}
+
+void
+uniteGeneric(unsigned char * target, const unsigned char * source, std::size_t size)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+        store(target + i, load(target + i) | load(source + i));
+    for (; i < size; ++i)
+        target[i] |= source[i];
+}
+
+void
+subtractGeneric(unsigned char * target, const unsigned char * source, std::size_t size)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+        store(target + i, load(target + i) & ~load(source + i));
+    for (; i < size; ++i)
+        target[i] &= ~source[i];
+}
+
+inline Id *
+wordToIds(uint64_t word, std::size_t offset, Id * ids)
+{
+    for (; word; word &= word - 1)
+        *ids++ = static_cast<Id>((offset << 3) + __builtin_ctzll(word));
+    return ids;
+}
+
+// the Ids of the bytes from begin up to size
+inline Id *
+bytesToIds(const unsigned char * map, std::size_t begin, std::size_t size, Id * ids)
+{
+    std::size_t i = begin;
+    for (; i + 8 <= size; i += 8)
+        ids = wordToIds(loadBits(map + i), i, ids);
+    for (; i < size; ++i)
+        ids = wordToIds(map[i], i, ids);
+    return ids;
+}
+
+std::size_t
+toIdsGeneric(const unsigned char * map, std::size_t size, Id * ids)
+{
+    return bytesToIds(map, 0, size, ids) - ids;
+}
+
+const Kernels genericKernels = {
+    Isa::GENERIC,
+    countGeneric,
+    intersectGeneric,
+    uniteGeneric,
+    subtractGeneric,
+    toIdsGeneric,
+};
+
+#ifdef BITMAP_AVX2
+
+inline __attribute__((target("avx2"))) __m256i
+load256(const unsigned char * bytes)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes));
+}
+
+inline __attribute__((target("avx2"))) void
+store256(unsigned char * bytes, __m256i value)
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(bytes), value);
+}
+
+// popcount of 32 bytes at a time by a lookup of the nibbles, summed up by _mm256_sad_epu8
+__attribute__((target("avx2,popcnt"))) std::size_t
+countAvx2(const unsigned char * map, std::size_t size)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibbles = _mm256_set1_epi8(0x0f);
+    __m256i total = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i bytes = load256(map + i);
+        __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(bytes, lowNibbles));
+        __m256i high = _mm256_shuffle_epi8(
+            lookup, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), lowNibbles));
+        total = _mm256_add_epi64(
+            total, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+    }
+    std::size_t count = _mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1) +
+        _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3);
+    return count + countGeneric(map + i, size - i);
+}
+
+__attribute__((target("avx2"))) void
+intersectAvx2(unsigned char * target, const unsigned char * source, std::size_t size)
+{
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+        store256(target + i, _mm256_and_si256(load256(target + i), load256(source + i)));
+    intersectGeneric(target + i, source + i, size - i);
+}
+
+__attribute__((target("avx2"))) void
+uniteAvx2(unsigned char * target, const unsigned char * source, std::size_t size)
+{
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+        store256(target + i, _mm256_or_si256(load256(target + i), load256(source + i)));
+    uniteGeneric(target + i, source + i, size - i);
+}
+
+__attribute__((target("avx2"))) void
+subtractAvx2(unsigned char * target, const unsigned char * source, std::size_t size)
+{
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+        store256(target + i, _mm256_andnot_si256(load256(source + i), load256(target + i)));
+    subtractGeneric(target + i, source + i, size - i);
+}
+
+// skips the empty 32 byte blocks, the sets of a query are mostly sparse
+__attribute__((target("avx2,bmi"))) std::size_t
+toIdsAvx2(const unsigned char * map, std::size_t size, Id * ids)
+{
+    Id * out = ids;
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i bytes = load256(map + i);
+        if (_mm256_testz_si256(bytes, bytes))
+            continue;
+        for (std::size_t j = i; j < i + 32; j += 8)
+            out = wordToIds(loadBits(map + j), j, out);
+    }
+    return bytesToIds(map, i, size, out) - ids;
+}
+
+const Kernels avx2Kernels = {
+    Isa::AVX2,
+    countAvx2,
+    intersectAvx2,
+    uniteAvx2,
+    subtractAvx2,
+    toIdsAvx2,
+};
+
+#endif
+
+std::atomic<const Kernels *> active{nullptr};
+
+bool
+isSupported(Isa isa) noexcept
+{
+    switch (isa) {
+        case Isa::GENERIC:
+            return true;
+        case Isa::AVX2:
+#ifdef BITMAP_AVX2
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi") &&
+                __builtin_cpu_supports("popcnt");
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+const Kernels &
+kernels() noexcept
+{
+    auto selected = active.load(std::memory_order_relaxed);
+    if (!selected) {
+        selected = &genericKernels;
+#ifdef BITMAP_AVX2
+        if (isSupported(Isa::AVX2))
+            selected = &avx2Kernels;
+#endif
+        active.store(selected, std::memory_order_relaxed);
+    }
+    return *selected;
+}
+
+}
+
+Isa
+getIsa() noexcept
+{
+    return kernels().isa;
+}
+
+bool
+setIsa(Isa isa) noexcept
+{
+    if (!isSupported(isa))
+        return false;
+    switch (isa) {
+        case Isa::GENERIC:
+            active.store(&genericKernels, std::memory_order_relaxed);
+            break;
+        case Isa::AVX2:
+#ifdef BITMAP_AVX2
+            active.store(&avx2Kernels, std::memory_order_relaxed);
+#endif
+            break;
+    }
+    return true;
+}
+
+const char *
+isaToString(Isa isa) noexcept
+{
+    switch (isa) {
+        case Isa::GENERIC:
+            return "generic";
+        case Isa::AVX2:
+            return "avx2";
+    }
+    return nullptr;
+}
+
+std::size_t
+count(const Map * map) noexcept
+{
+    return kernels().count(map->map, map->size);
+}
+
+bool
+empty(const Map * map) noexcept
+{
+    const std::size_t size = map->size;
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        if (load(map->map + i))
+            return false;
+    }
+    for (; i < size; ++i) {
+        if (map->map[i])
+            return false;
+    }
+    return true;
+}
+
+void
+intersect(Map * target, const Map * source) noexcept
+{
+    if (target->size <= source->size) {
+        kernels().intersect(target->map, source->map, target->size);
+    } else {
+        kernels().intersect(target->map, source->map, source->size);
+        memset(target->map + source->size, 0, target->size - source->size);
+    }
+}
+
+void
+unite(Map * target, const Map * source)
+{
+    if (target->size < source->size)
+        map_grow(target, source->size << 3);
+    kernels().unite(target->map, source->map, source->size);
+}
+
+void
+subtract(Map * target, const Map * source) noexcept
+{
+    kernels().subtract(target->map, source->map,
+                       target->size < source->size ? target->size : source->size);
+}
+
+Id
+next(const Map * map, Id previous) noexcept
+{
+    const unsigned char * bytes = map->map;
+    const std::size_t size = map->size;
+    std::size_t bit = previous < 0 ? 0 : static_cast<std::size_t>(previous) + 1;
+    std::size_t i = bit >> 3;
+    if (i >= size)
+        return -1;
+
+    // the rest of the byte with the previous bit
+    unsigned int byte = bytes[i] >> (bit & 7);
+    if (byte)
+        return static_cast<Id>(bit + __builtin_ctz(byte));
+    for (++i; i + 8 <= size; i += 8) {
+        uint64_t word = loadBits(bytes + i);
+        if (word)
+            return static_cast<Id>((i << 3) + __builtin_ctzll(word));
+    }
+    for (; i < size; ++i) {
+        if (bytes[i])
+            return static_cast<Id>((i << 3) + __builtin_ctz(bytes[i]));
+    }
+    return -1;
+}
+
+Id
+nth(const Map * map, std::size_t index) noexcept
+{
+    const unsigned char * bytes = map->map;
+    const std::size_t size = map->size;
+    std::size_t i = 0;
+    uint64_t word = 0;
+
+    for (; i + 8 <= size; i += 8) {
+        word = loadBits(bytes + i);
+        std::size_t count = __builtin_popcountll(word);
+        if (index < count)
+            break;
+        index -= count;
+    }
+    if (i + 8 > size) {
+        for (; i < size; ++i) {
+            std::size_t count = __builtin_popcount(bytes[i]);
+            if (index < count)
+                break;
+            index -= count;
+        }
+        if (i == size)
+            return -1;
+        word = bytes[i];
+    }
+    // clear the lower set bits of the word
+    for (; index; --index)
+        word &= word - 1;
+    return static_cast<Id>((i << 3) + __builtin_ctzll(word));
+}
+
+std::size_t
+toIds(const Map * map, Id * ids) noexcept
+{
+    return kernels().toIds(map->map, map->size, ids);
+}
+
+}
+
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _BITMAP_HPP_
+#define _BITMAP_HPP_
+
+#include <cstddef>
+#include <solv/bitmap.h>
+#include <solv/pooltypes.h>
+
+namespace libdnf {
+
+/**
+* @brief Kernels of the libsolv Map operations used by PackageSet and Query
+*
+* The maps are processed a 64-bit word or an AVX2 register at a time instead of a byte at a time.
+* The implementation is selected at the first use by the capabilities of the CPU. The results are
+* the same as of the corresponding libsolv functions.
+*/
+namespace bitmap {
+
+enum class Isa {
+    GENERIC,    // 64-bit words, any CPU
+    AVX2        // x86_64 with AVX2, BMI and POPCNT
+};
+
+Isa getIsa() noexcept;
+
+/**
+* @brief Overrides the selected implementation, for tests and benchmarks
+*
+* @return false if the CPU does not support isa, the implementation is not changed then
+*/
+bool setIsa(Isa isa) noexcept;
+
+const char * isaToString(Isa isa) noexcept;
+
+/// Number of the set bits, as map_count()
+std::size_t count(const Map * map) noexcept;
+
+bool empty(const Map * map) noexcept;
+
+/// target &= source, the bits of target beyond the size of source are cleared, as map_and()
+void intersect(Map * target, const Map * source) noexcept;
+
+/// target |= source, target grows to the size of source, as map_or()
+void unite(Map * target, const Map * source);
+
+/// target &= ~source, as map_subtract()
+void subtract(Map * target, const Map * source) noexcept;
+
+/// First set bit after previous or -1, a negative previous starts at the beginning
+Id next(const Map * map, Id previous) noexcept;
+
+/// The set bit with the given index in ascending order or -1
+Id nth(const Map * map, std::size_t index) noexcept;
+
+/**
+* @brief Writes the set bits in ascending order
+*
+* @param ids array with room for count(map) elements
+* @return number of written Ids
+*/
+std::size_t toIds(const Map * map, Id * ids) noexcept;
+
+}
+
+}
+
+#endif // _BITMAP_HPP_
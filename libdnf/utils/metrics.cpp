@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "metrics.hpp"
+#include "../hy-types.h"
+
+#include <chrono>
+
+namespace libdnf {
+
+namespace {
+
+// zero initialized as they have static storage
+std::atomic<uint64_t> counters[static_cast<int>(Metrics::Counter::COUNT)];
+Metrics::Histogram timers[static_cast<int>(Metrics::Timer::COUNT)];
+Metrics::FilterStats filters[Metrics::KEYNAMES];
+
+const char * const counterNames[] = {
+    "query_apply",
+    "query_scanned",
+    "query_matched",
+    "goal_solve",
+    "goal_rerun",
+    "solv_cache_hit",
+    "solv_cache_miss",
+};
+
+const char * const timerNames[] = {
+    "query_apply",
+    "goal_solve",
+    "sack_make_provides_ready",
+    "sack_load_repo",
+    "sack_load_solv_cache",
+};
+
+struct KeynameName {
+    int keyname;
+    const char * name;
+};
+
+const KeynameName keynameNames[] = {
+    {HY_PKG, "pkg"},
+    {HY_PKG_ALL, "all"},
+    {HY_PKG_ARCH, "arch"},
+    {HY_PKG_CONFLICTS, "conflicts"},
+    {HY_PKG_DESCRIPTION, "description"},
+    {HY_PKG_EPOCH, "epoch"},
+    {HY_PKG_EVR, "evr"},
+    {HY_PKG_FILE, "file"},
+    {HY_PKG_NAME, "name"},
+    {HY_PKG_NEVRA, "nevra"},
+    {HY_PKG_OBSOLETES, "obsoletes"},
+    {HY_PKG_PROVIDES, "provides"},
+    {HY_PKG_RELEASE, "release"},
+    {HY_PKG_REPONAME, "reponame"},
+    {HY_PKG_REQUIRES, "requires"},
+    {HY_PKG_SOURCERPM, "sourcerpm"},
+    {HY_PKG_SUMMARY, "summary"},
+    {HY_PKG_URL, "url"},
+    {HY_PKG_VERSION, "version"},
+    {HY_PKG_LOCATION, "location"},
+    {HY_PKG_ENHANCES, "enhances"},
+    {HY_PKG_RECOMMENDS, "recommends"},
+    {HY_PKG_SUGGESTS, "suggests"},
+    {HY_PKG_SUPPLEMENTS, "supplements"},
+    {HY_PKG_ADVISORY, "advisory"},
+    {HY_PKG_ADVISORY_BUG, "advisory_bug"},
+    {HY_PKG_ADVISORY_CVE, "advisory_cve"},
+    {HY_PKG_ADVISORY_SEVERITY, "advisory_severity"},
+    {HY_PKG_ADVISORY_TYPE, "advisory_type"},
+    {HY_PKG_DOWNGRADABLE, "downgradable"},
+    {HY_PKG_DOWNGRADES, "downgrades"},
+    {HY_PKG_EMPTY, "empty"},
+    {HY_PKG_LATEST_PER_ARCH, "latest_per_arch"},
+    {HY_PKG_LATEST, "latest"},
+    {HY_PKG_UPGRADABLE, "upgradable"},
+    {HY_PKG_UPGRADES, "upgrades"},
+    {HY_PKG_NEVRA_STRICT, "nevra_strict"},
+};
+
+}
+
+std::atomic<bool> Metrics::enabled{false};
+
+void
+Metrics::Histogram::record(uint64_t ns) noexcept
+{
+    int bucket = 0;
+    for (uint64_t us = ns / 1000; us && bucket < BUCKETS - 1; us >>= 1)
+        ++bucket;
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(ns, std::memory_order_relaxed);
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    auto prev = max.load(std::memory_order_relaxed);
+    while (prev < ns && !max.compare_exchange_weak(prev, ns, std::memory_order_relaxed));
+}
+
+void
+Metrics::Histogram::reset() noexcept
+{
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+    for (auto & bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+void
+Metrics::reset() noexcept
+{
+    for (auto & counter : counters)
+        counter.store(0, std::memory_order_relaxed);
+    for (auto & timer : timers)
+        timer.reset();
+    for (auto & filter : filters) {
+        filter.time.reset();
+        filter.scanned.store(0, std::memory_order_relaxed);
+        filter.matched.store(0, std::memory_order_relaxed);
+    }
+}
+
+void
+Metrics::add(Counter counter, uint64_t value) noexcept
+{
+    if (isEnabled())
+        counters[static_cast<int>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+void
+Metrics::record(Timer timer, uint64_t ns) noexcept
+{
+    if (isEnabled())
+        timers[static_cast<int>(timer)].record(ns);
+}
+
+void
+Metrics::recordFilter(int keyname, uint64_t ns, uint64_t scanned, uint64_t matched) noexcept
+{
+    if (!isEnabled() || keyname < 0 || keyname >= KEYNAMES)
+        return;
+    auto & filter = filters[keyname];
+    filter.time.record(ns);
+    filter.scanned.fetch_add(scanned, std::memory_order_relaxed);
+    filter.matched.fetch_add(matched, std::memory_order_relaxed);
+    add(Counter::QUERY_SCANNED, scanned);
+    add(Counter::QUERY_MATCHED, matched);
+}
+
+uint64_t
+Metrics::get(Counter counter) noexcept
+{
+    return counters[static_cast<int>(counter)].load(std::memory_order_relaxed);
+}
+
+const Metrics::Histogram &
+Metrics::get(Timer timer) noexcept
+{
+    return timers[static_cast<int>(timer)];
+}
+
+const Metrics::FilterStats &
+Metrics::getFilter(int keyname) noexcept
+{
+    return filters[keyname];
+}
+
+const char *
+Metrics::toString(Counter counter) noexcept
+{
+    return counterNames[static_cast<int>(counter)];
+}
+
+const char *
+Metrics::toString(Timer timer) noexcept
+{
+    return timerNames[static_cast<int>(timer)];
+}
+
+const char *
+Metrics::keynameToString(int keyname) noexcept
+{
+    for (auto & keynameName : keynameNames) {
+        if (keynameName.keyname == keyname)
+            return keynameName.name;
+    }
+    return nullptr;
+}
+
+uint64_t
+Metrics::now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
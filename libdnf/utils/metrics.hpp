@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _METRICS_HPP_
+#define _METRICS_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+namespace libdnf {
+
+/**
+* @brief Process wide counters and timers of the hot paths
+*
+* Metrics are disabled by default. While disabled, each recording point costs
+* a single relaxed atomic load and the clock is not read. All values are
+* atomic, so they can be recorded from any thread.
+*/
+class Metrics {
+public:
+    enum class Counter {
+        QUERY_APPLY,        // queries which applied their filters
+        QUERY_SCANNED,      // packages in the results before each filter
+        QUERY_MATCHED,      // packages in the results after each filter
+        GOAL_SOLVE,         // runs of the solver
+        GOAL_RERUN,         // runs repeated to apply the installonly limit
+        SOLV_CACHE_HIT,     // repos and extensions loaded from .solv files
+        SOLV_CACHE_MISS,    // repos and extensions loaded from metadata or the rpmdb
+        COUNT
+    };
+
+    enum class Timer {
+        QUERY_APPLY,                // Query::Impl::apply()
+        GOAL_SOLVE,                 // Goal::Impl::solve()
+        SACK_MAKE_PROVIDES_READY,   // dnf_sack_make_provides_ready()
+        SACK_LOAD_REPO,             // loading of a repo or an extension, from any source
+        SACK_LOAD_SOLV_CACHE,       // reading of .solv files
+        COUNT
+    };
+
+    /// Number of the histogram buckets, bucket i counts durations below 2^i microseconds
+    static constexpr int BUCKETS = 32;
+    /// Filter keynames above this are not recorded
+    static constexpr int KEYNAMES = 64;
+
+    struct Histogram {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sum;      // nanoseconds
+        std::atomic<uint64_t> max;      // nanoseconds
+        std::atomic<uint64_t> buckets[BUCKETS];
+
+        void record(uint64_t ns) noexcept;
+        void reset() noexcept;
+    };
+
+    struct FilterStats {
+        Histogram time;
+        std::atomic<uint64_t> scanned;
+        std::atomic<uint64_t> matched;
+    };
+
+    static bool isEnabled() noexcept { return enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool value) noexcept { enabled.store(value, std::memory_order_relaxed); }
+    static void reset() noexcept;
+
+    static void add(Counter counter, uint64_t value = 1) noexcept;
+    static void record(Timer timer, uint64_t ns) noexcept;
+
+    /**
+    * @brief Records a query filter
+    *
+    * @param keyname HY_PKG_* keyname of the filter
+    * @param ns duration of the filter in nanoseconds
+    * @param scanned number of packages in the result before the filter
+    * @param matched number of packages in the result after the filter
+    */
+    static void recordFilter(int keyname, uint64_t ns, uint64_t scanned, uint64_t matched) noexcept;
+
+    static uint64_t get(Counter counter) noexcept;
+    static const Histogram & get(Timer timer) noexcept;
+    static const FilterStats & getFilter(int keyname) noexcept;
+
+    static const char * toString(Counter counter) noexcept;
+    static const char * toString(Timer timer) noexcept;
+
+    /// Name of a keyname as used by the Python bindings, e.g. "name", or nullptr
+    static const char * keynameToString(int keyname) noexcept;
+
+    /// Monotonic time in nanoseconds
+    static uint64_t now() noexcept;
+
+    /**
+    * @brief Records the lifetime of the object into a timer, if the metrics
+    * were enabled at its construction
+    */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Timer timer) noexcept : timer(timer), start(isEnabled() ? now() : 0) {}
+        ~ScopedTimer() { if (start) record(timer, now() - start); }
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer & operator=(const ScopedTimer &) = delete;
+
+    private:
+        Timer timer;
+        uint64_t start;
+    };
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+}
+
+#endif // _METRICS_HPP_
@@ -25,15 +25,98 @@ void
 SQLite3::open()
 {
     if (db == nullptr) {
-        auto result = sqlite3_open(path.c_str(), &db);
+        int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+        if (mode == Mode::READ_ONLY) {
+            flags = SQLITE_OPEN_READONLY;
+        }
+        auto result = sqlite3_open_v2(path.c_str(), &db, flags, nullptr);
         if (result != SQLITE_OK) {
             sqlite3_close(db);
+            db = nullptr;
             throw LibException(result, "Open failed");
         }
-        // sqlite doesn't behave correctly in chroots without following line:
-        // turn foreign key checking on
-        exec("PRAGMA journal_mode = TRUNCATE; PRAGMA locking_mode = DEFAULT; PRAGMA foreign_keys = ON;");
+        if (busyTimeout > 0) {
+            sqlite3_busy_timeout(db, busyTimeout);
+        }
+        switch (mode) {
+            case Mode::DEFAULT:
+                // a database switched to WAL by a WAL connection stays in WAL,
+                // leaving it would make the WAL readers block the writers again
+                if (getJournalMode() == "wal") {
+                    exec("PRAGMA locking_mode = DEFAULT; PRAGMA foreign_keys = ON;");
+                    break;
+                }
+                // sqlite doesn't behave correctly in chroots without following line:
+                // turn foreign key checking on
+                exec("PRAGMA journal_mode = TRUNCATE; PRAGMA locking_mode = DEFAULT; PRAGMA foreign_keys = ON;");
+                break;
+            case Mode::WAL:
+                // the log is synced on checkpoints only, commits don't wait for fsync
+                exec("PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL; "
+                     "PRAGMA locking_mode = DEFAULT; PRAGMA foreign_keys = ON;");
+                if (walAutoCheckpoint >= 0) {
+                    setWalAutoCheckpoint(walAutoCheckpoint);
+                }
+                break;
+            case Mode::READ_ONLY:
+                // journal mode can't be changed on read-only connection
+                exec("PRAGMA locking_mode = DEFAULT; PRAGMA foreign_keys = ON;");
+                break;
+        }
+    }
+}
+
+std::string
+SQLite3::getJournalMode()
+{
+    Query query(*this, "PRAGMA journal_mode");
+    query.step();
+    return query.get< std::string >(0);
+}
+
+void
+SQLite3::setBusyTimeout(int milliseconds)
+{
+    busyTimeout = milliseconds;
+    if (db != nullptr) {
+        sqlite3_busy_timeout(db, milliseconds);
+    }
+}
+
+void
+SQLite3::setWalAutoCheckpoint(int pages)
+{
+    walAutoCheckpoint = pages;
+    if (db != nullptr && mode == Mode::WAL) {
+        auto result = sqlite3_wal_autocheckpoint(db, pages);
+        if (result != SQLITE_OK) {
+            throw LibException(result, "Setting WAL autocheckpoint failed: " + getError());
+        }
+    }
+}
+
+bool
+SQLite3::walCheckpoint(bool truncate)
+{
+    if (db == nullptr || mode != Mode::WAL) {
+        return false;
+    }
+    int logFrames = 0;
+    int checkpointedFrames = 0;
+    auto result = sqlite3_wal_checkpoint_v2(db,
+                                            nullptr,
+                                            truncate ? SQLITE_CHECKPOINT_TRUNCATE
+                                                     : SQLITE_CHECKPOINT_PASSIVE,
+                                            &logFrames,
+                                            &checkpointedFrames);
+    if (result == SQLITE_BUSY) {
+        // readers or another checkpoint are in the way, try again later
+        return false;
+    }
+    if (result != SQLITE_OK) {
+        throw LibException(result, "WAL checkpoint failed: " + getError());
     }
+    return logFrames == checkpointedFrames;
 }
 
 void
@@ -324,6 +324,15 @@ public:
         std::map< std::string, int > colsName2idx;
     };
 
+    /**
+     * Mode the database is opened in.
+     * DEFAULT uses rollback journal in TRUNCATE mode, a database already in WAL mode stays in it.
+     * WAL switches the database to write-ahead logging, readers don't block the writer
+     * and the writer doesn't block readers.
+     * READ_ONLY opens the database read-only and keeps its journal mode untouched.
+     */
+    enum class Mode { DEFAULT, WAL, READ_ONLY };
+
     SQLite3(const SQLite3 &) = delete;
     SQLite3 &operator=(const SQLite3 &) = delete;
 
@@ -334,14 +343,52 @@ public:
         open();
     }
 
+    SQLite3(const std::string &dbPath, Mode mode, int busyTimeout = 0)
+      : path{dbPath}
+      , db{nullptr}
+      , mode{mode}
+      , busyTimeout{busyTimeout}
+    {
+        open();
+    }
+
     ~SQLite3() { close(); }
 
     const std::string &getPath() const { return path; }
+    Mode getMode() const noexcept { return mode; }
+    bool isReadOnly() const noexcept { return mode == Mode::READ_ONLY; }
 
     void open();
     void close();
     bool isOpened() { return db != nullptr; };
 
+    /// Journal mode of the database in lower case, e.g. "wal" or "truncate"
+    std::string getJournalMode();
+
+    /**
+     * Set how long to wait for a lock held by another connection before giving up.
+     * The value is kept and applied again when the database is reopened.
+     * \param milliseconds timeout, 0 disables waiting
+     */
+    void setBusyTimeout(int milliseconds);
+
+    /**
+     * Set number of WAL pages after which a commit triggers a passive checkpoint.
+     * Has effect only in WAL mode.
+     * \param pages number of pages, 0 disables automatic checkpoints
+     */
+    void setWalAutoCheckpoint(int pages);
+
+    /**
+     * Copy content of the write-ahead log back to the database.
+     * Passive checkpoint never blocks readers; truncating checkpoint waits for them
+     * (up to the busy timeout) and truncates the log afterwards.
+     * Does nothing when the database is not in WAL mode.
+     * \param truncate run truncating checkpoint instead of passive one
+     * \return true if the whole log was checkpointed
+     */
+    bool walCheckpoint(bool truncate = false);
+
     void exec(const char *sql)
     {
         auto result = sqlite3_exec(db, sql, nullptr, nullptr, nullptr);
@@ -363,6 +410,10 @@ protected:
     std::string path;
 
     sqlite3 *db;
+    Mode mode{Mode::DEFAULT};
+    int busyTimeout{0};
+    // negative value means sqlite default
+    int walAutoCheckpoint{-1};
 };
 
 typedef std::shared_ptr< SQLite3 > SQLite3Ptr;
@@ -51,8 +51,9 @@ __all__ = [
     'ValueException',
     # functions
     'chksum_name', 'chksum_type', 'split_nevra', 'convert_hawkey_reason',
+    'metrics', 'metrics_enabled', 'set_metrics_enabled', 'reset_metrics',
     # classes
-    'Goal', 'NEVRA', 'NSVCAP', 'Package', 'Query', 'Repo', 'Sack', 'Selector', 'Subject']
+    'Goal', 'NEVRA', 'NSVCAP', 'Package', 'PackageSet', 'Query', 'Repo', 'Sack', 'Selector', 'Subject']
 
 NEVRA = _hawkey.NEVRA
 Query = _hawkey.Query
@@ -127,6 +128,7 @@ REFERENCE_CVE = _hawkey.REFERENCE_CVE
 REFERENCE_VENDOR = _hawkey.REFERENCE_VENDOR
 
 Package = _hawkey.Package
+PackageSet = _hawkey.PackageSet
 Reldep = _hawkey.Reldep
 Repo = _hawkey.Repo
 Sack = _hawkey.Sack
@@ -140,6 +142,10 @@ RuntimeException = _hawkey.RuntimeException
 chksum_name = _hawkey.chksum_name
 chksum_type = _hawkey.chksum_type
 detect_arch = _hawkey.detect_arch
+metrics = _hawkey.metrics
+metrics_enabled = _hawkey.metrics_enabled
+set_metrics_enabled = _hawkey.set_metrics_enabled
+reset_metrics = _hawkey.reset_metrics
 
 ERASE = _hawkey.ERASE
 DISTUPGRADE = _hawkey.DISTUPGRADE
@@ -33,6 +33,7 @@
 #include "hy-types.h"
 #include "hy-util.h"
 #include "dnf-version.h"
+#include "utils/metrics.hpp"
 
 // pyhawkey
 #include "advisory-py.hpp"
@@ -40,10 +41,12 @@
 #include "advisoryref-py.hpp"
 #include "exception-py.hpp"
 #include "goal-py.hpp"
+#include "iutil-py.hpp"
 #include "nevra-py.hpp"
 #include "nsvcap-py.hpp"
 #include "package-py.hpp"
 #include "packagedelta-py.hpp"
+#include "packageset-py.hpp"
 #include "query-py.hpp"
 #include "reldep-py.hpp"
 #include "repo-py.hpp"
@@ -115,6 +118,96 @@ split_nevra(PyObject *unused, PyObject *nevra_o)
     return ret;
 }
 
+static PyObject *
+histogram_to_pydict(const libdnf::Metrics::Histogram & histogram)
+{
+    UniquePtrPyObject buckets(PyList_New(libdnf::Metrics::BUCKETS));
+    if (!buckets)
+        return NULL;
+    for (int i = 0; i < libdnf::Metrics::BUCKETS; ++i) {
+        PyObject *count = PyLong_FromUnsignedLongLong(histogram.buckets[i].load());
+        if (!count)
+            return NULL;
+        PyList_SET_ITEM(buckets.get(), i, count);
+    }
+    return Py_BuildValue("{s:K,s:K,s:K,s:O}",
+                         "count", (unsigned long long)histogram.count.load(),
+                         "sum_ns", (unsigned long long)histogram.sum.load(),
+                         "max_ns", (unsigned long long)histogram.max.load(),
+                         "buckets", buckets.get());
+}
+
+static PyObject *
+metrics(PyObject *unused, PyObject *args)
+{
+    using libdnf::Metrics;
+
+    UniquePtrPyObject counters(PyDict_New());
+    UniquePtrPyObject timers(PyDict_New());
+    UniquePtrPyObject filters(PyDict_New());
+    if (!counters || !timers || !filters)
+        return NULL;
+
+    for (int i = 0; i < static_cast<int>(Metrics::Counter::COUNT); ++i) {
+        auto counter = static_cast<Metrics::Counter>(i);
+        UniquePtrPyObject value(PyLong_FromUnsignedLongLong(Metrics::get(counter)));
+        if (!value || PyDict_SetItemString(counters.get(), Metrics::toString(counter),
+                                           value.get()) == -1)
+            return NULL;
+    }
+    for (int i = 0; i < static_cast<int>(Metrics::Timer::COUNT); ++i) {
+        auto timer = static_cast<Metrics::Timer>(i);
+        UniquePtrPyObject value(histogram_to_pydict(Metrics::get(timer)));
+        if (!value || PyDict_SetItemString(timers.get(), Metrics::toString(timer),
+                                           value.get()) == -1)
+            return NULL;
+    }
+    for (int keyname = 0; keyname < Metrics::KEYNAMES; ++keyname) {
+        auto & filter = Metrics::getFilter(keyname);
+        const char *name = Metrics::keynameToString(keyname);
+        if (!name || filter.time.count.load() == 0)
+            continue;
+        UniquePtrPyObject value(histogram_to_pydict(filter.time));
+        if (!value)
+            return NULL;
+        UniquePtrPyObject scanned(PyLong_FromUnsignedLongLong(filter.scanned.load()));
+        UniquePtrPyObject matched(PyLong_FromUnsignedLongLong(filter.matched.load()));
+        if (!scanned || !matched ||
+            PyDict_SetItemString(value.get(), "scanned", scanned.get()) == -1 ||
+            PyDict_SetItemString(value.get(), "matched", matched.get()) == -1 ||
+            PyDict_SetItemString(filters.get(), name, value.get()) == -1)
+            return NULL;
+    }
+
+    return Py_BuildValue("{s:O,s:O,s:O}",
+                         "counters", counters.get(),
+                         "timers", timers.get(),
+                         "filters", filters.get());
+}
+
+static PyObject *
+metrics_enabled(PyObject *unused, PyObject *args)
+{
+    return PyBool_FromLong(libdnf::Metrics::isEnabled());
+}
+
+static PyObject *
+set_metrics_enabled(PyObject *unused, PyObject *enabled_o)
+{
+    int enabled = PyObject_IsTrue(enabled_o);
+    if (enabled == -1)
+        return NULL;
+    libdnf::Metrics::setEnabled(enabled);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+reset_metrics(PyObject *unused, PyObject *args)
+{
+    libdnf::Metrics::reset();
+    Py_RETURN_NONE;
+}
+
 static struct PyMethodDef hawkey_methods[] = {
     {"chksum_name",                (PyCFunction)chksum_name,
      METH_VARARGS,        NULL},
@@ -124,6 +217,14 @@ static struct PyMethodDef hawkey_methods[] = {
      METH_NOARGS,        NULL},
     {"split_nevra",                (PyCFunction)split_nevra,
      METH_O,                NULL},
+    {"metrics",                 (PyCFunction)metrics,
+     METH_NOARGS,        NULL},
+    {"metrics_enabled",         (PyCFunction)metrics_enabled,
+     METH_NOARGS,        NULL},
+    {"set_metrics_enabled",     (PyCFunction)set_metrics_enabled,
+     METH_O,                NULL},
+    {"reset_metrics",           (PyCFunction)reset_metrics,
+     METH_NOARGS,        NULL},
     {NULL}                                /* sentinel */
 };
 
@@ -179,6 +280,11 @@ PYCOMP_MOD_INIT(_hawkey)
         return PYCOMP_MOD_ERROR_VAL;
     Py_INCREF(&packageDelta_Type);
     PyModule_AddObject(m, "PackageDelta", (PyObject *)&packageDelta_Type);
+    /* _hawkey.PackageSet */
+    if (PyType_Ready(&packageset_Type) < 0)
+        return PYCOMP_MOD_ERROR_VAL;
+    Py_INCREF(&packageset_Type);
+    PyModule_AddObject(m, "PackageSet", (PyObject *)&packageset_Type);
     /* _hawkey.Query */
     if (PyType_Ready(&query_Type) < 0)
         return PYCOMP_MOD_ERROR_VAL;
@@ -37,12 +37,14 @@
 #include "advisoryref-py.hpp"
 #include "iutil-py.hpp"
 #include "package-py.hpp"
+#include "packageset-py.hpp"
 #include "query-py.hpp"
 #include "reldep-py.hpp"
 #include "sack-py.hpp"
 #include "pycomp.hpp"
 #include "sack/advisorypkg.hpp"
 #include "sack/changelog.hpp"
+#include "sack/packagecolumns.hpp"
 #include "sack/packageset.hpp"
 #include "sack/query.hpp"
 
@@ -206,6 +208,71 @@ packageset_to_pylist(const DnfPackageSet *pset, PyObject *sack)
     return list.release();
 }
 
+/**
+ * Attributes of the packages as a tuple with a list per key. Equal strings are
+ * the same Python object.
+ */
+PyObject *
+packageset_to_pycolumns(const DnfPackageSet *pset, PyObject *keys)
+{
+    UniquePtrPyObject sequence(PySequence_Fast(keys, "Expected a sequence."));
+    if (!sequence)
+        return NULL;
+    std::vector<libdnf::PackageColumns::Key> ckeys;
+    const unsigned count = PySequence_Size(sequence.get());
+    for (unsigned int i = 0; i < count; ++i) {
+        PycompString name(PySequence_Fast_GET_ITEM(sequence.get(), i));
+        if (!name.getCString())
+            return NULL;
+        libdnf::PackageColumns::Key key;
+        if (!libdnf::PackageColumns::keyFromString(name.getCString(), &key)) {
+            PyErr_Format(PyExc_ValueError, "Unknown package attribute: %s", name.getCString());
+            return NULL;
+        }
+        ckeys.push_back(key);
+    }
+
+    libdnf::PackageColumns columns(*pset, ckeys);
+
+    auto & strings = columns.getStrings();
+    UniquePtrPyObject pystrings(PyList_New(strings.size()));
+    if (!pystrings)
+        return NULL;
+    Py_INCREF(Py_None);
+    PyList_SET_ITEM(pystrings.get(), 0, Py_None);
+    for (std::size_t i = 1; i < strings.size(); ++i) {
+        PyObject *str = PyUnicode_FromString(strings[i].c_str());
+        if (!str)
+            return NULL;
+        PyList_SET_ITEM(pystrings.get(), i, str);
+    }
+
+    UniquePtrPyObject result(PyTuple_New(ckeys.size()));
+    if (!result)
+        return NULL;
+    for (std::size_t i = 0; i < ckeys.size(); ++i) {
+        auto & values = columns.getColumn(i);
+        bool isString = libdnf::PackageColumns::isStringKey(ckeys[i]);
+        PyObject *list = PyList_New(values.size());
+        if (!list)
+            return NULL;
+        PyTuple_SET_ITEM(result.get(), i, list);
+        for (std::size_t j = 0; j < values.size(); ++j) {
+            PyObject *item;
+            if (isString) {
+                item = PyList_GET_ITEM(pystrings.get(), values[j]);
+                Py_INCREF(item);
+            } else {
+                item = PyLong_FromUnsignedLongLong(values[j]);
+                if (!item)
+                    return NULL;
+            }
+            PyList_SET_ITEM(list, j, item);
+        }
+    }
+    return result.release();
+}
+
 std::unique_ptr<DnfPackageSet>
 pyseq_to_packageset(PyObject *obj, DnfSack *sack)
 {
@@ -213,6 +280,8 @@ pyseq_to_packageset(PyObject *obj, DnfSack *sack)
         HyQuery target = queryFromPyObject(obj);
         return std::unique_ptr<DnfPackageSet>(new libdnf::PackageSet(*target->runSet()));
     }
+    if (packagesetObject_Check(obj))
+        return std::unique_ptr<DnfPackageSet>(new libdnf::PackageSet(*packagesetFromPyObject(obj)));
 
     UniquePtrPyObject sequence(PySequence_Fast(obj, "Expected a sequence."));
     if (!sequence)
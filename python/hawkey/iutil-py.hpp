@@ -69,6 +69,7 @@ PyObject *advisoryRefVectorToPylist(const std::vector<libdnf::AdvisoryRef> & adv
 PyObject *changelogslist_to_pylist(const std::vector<libdnf::Changelog> & changelogslist);
 PyObject *packagelist_to_pylist(GPtrArray *plist, PyObject *sack);
 PyObject * packageset_to_pylist(const DnfPackageSet * pset, PyObject * sack);
+PyObject * packageset_to_pycolumns(const DnfPackageSet * pset, PyObject * keys);
 std::unique_ptr<DnfPackageSet> pyseq_to_packageset(PyObject * sequence, DnfSack * sack);
 std::unique_ptr<DnfReldepList> pyseq_to_reldeplist(PyObject *sequence, DnfSack *sack, int cmp_type);
 PyObject *strlist_to_pylist(const char **slist);
@@ -35,15 +35,34 @@
 #include "sack-py.hpp"
 #include "pycomp.hpp"
 #include "libdnf/repo/solvable/DependencyContainer.hpp"
+#include "libdnf/sack/packagehandle.hpp"
 
+/* The DnfPackage is only created when a caller needs it, the scalar
+ * attributes are read through a libdnf::PackageHandle. */
 typedef struct {
     PyObject_HEAD
     DnfPackage *package;
+    DnfSack *csack;
+    Id id;
     PyObject *sack;
 } _PackageObject;
 
 long package_hash(_PackageObject *self);
 
+static DnfPackage *
+package_get(_PackageObject *self)
+{
+    if (self->package == NULL && self->csack != NULL)
+        self->package = dnf_package_new(self->csack, self->id);
+    return self->package;
+}
+
+static libdnf::PackageHandle
+package_handle(_PackageObject *self)
+{
+    return libdnf::PackageHandle(self->csack, self->id);
+}
+
 DnfPackage *
 packageFromPyObject(PyObject *o)
 {
@@ -51,7 +70,7 @@ packageFromPyObject(PyObject *o)
         PyErr_SetString(PyExc_TypeError, "Expected a Package object.");
         return NULL;
     }
-    return ((_PackageObject *)o)->package;
+    return package_get((_PackageObject *)o);
 }
 
 int
@@ -64,6 +83,19 @@ package_converter(PyObject *o, DnfPackage **pkg_ptr)
     return 1;
 }
 
+/* Gets the sack and the Id of a Package without creating its DnfPackage */
+int
+packageIdFromPyObject(PyObject *o, DnfSack **sack_ptr, Id *id_ptr)
+{
+    if (!PyType_IsSubtype(o->ob_type, &package_Type)) {
+        PyErr_SetString(PyExc_TypeError, "Expected a Package object.");
+        return 0;
+    }
+    *sack_ptr = ((_PackageObject *)o)->csack;
+    *id_ptr = ((_PackageObject *)o)->id;
+    return 1;
+}
+
 /* functions on the type */
 
 static PyObject *
@@ -73,6 +105,8 @@ package_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
     if (self) {
         self->sack = NULL;
         self->package = NULL;
+        self->csack = NULL;
+        self->id = 0;
     }
     return (PyObject*)self;
 }
@@ -101,7 +135,8 @@ package_init(_PackageObject *self, PyObject *args, PyObject *kwds)
         return -1;
     self->sack = sack;
     Py_INCREF(self->sack);
-    self->package = dnf_package_new(csack, id);
+    self->csack = csack;
+    self->id = id;
     return 0;
 }
 
@@ -109,17 +144,15 @@ static PyObject *
 package_py_richcompare(PyObject *self, PyObject *other, int op)
 {
     PyObject *v;
-    DnfPackage *self_package, *other_package;
 
-    if (!package_converter(self, &self_package) ||
-        !package_converter(other, &other_package)) {
-        if(PyErr_Occurred() && PyErr_ExceptionMatches(PyExc_TypeError))
-            PyErr_Clear();
+    if (!PyType_IsSubtype(self->ob_type, &package_Type) ||
+        !PyType_IsSubtype(other->ob_type, &package_Type)) {
         Py_INCREF(Py_NotImplemented);
         return Py_NotImplemented;
     }
 
-    long result = dnf_package_cmp(self_package, other_package);
+    long result = package_handle((_PackageObject *)self).cmp(
+        package_handle((_PackageObject *)other));
 
     switch (op) {
     case Py_EQ:
@@ -151,94 +184,90 @@ package_py_richcompare(PyObject *self, PyObject *other, int op)
 static PyObject *
 package_repr(_PackageObject *self)
 {
-    DnfPackage *pkg = self->package;
-    const char *nevra = dnf_package_get_nevra(pkg);
+    auto pkg = package_handle(self);
+    const char *nevra = pkg.getNevra();
     PyObject *repr;
 
     repr = PyString_FromFormat("<hawkey.Package object id %ld, %s, %s>",
                                package_hash(self), nevra,
-                               dnf_package_get_reponame(pkg));
+                               pkg.getReponame());
     return repr;
 }
 
 static PyObject *
 package_str(_PackageObject *self)
 {
-    const char *cstr = dnf_package_get_nevra(self->package);
+    const char *cstr = package_handle(self).getNevra();
     PyObject *ret = PyString_FromString(cstr);
     return ret;
 }
 
 long package_hash(_PackageObject *self)
 {
-    return dnf_package_get_id(self->package);
+    return self->id;
 }
 
 /* getsetters */
 
+template<bool (libdnf::PackageHandle::*getMethod)() const>
 static PyObject *
 get_bool(_PackageObject *self, void *closure)
 {
-    unsigned long (*func)(DnfPackage*);
-    func = (unsigned long (*)(DnfPackage*))closure;
-    return PyBool_FromLong(func(self->package));
+    return PyBool_FromLong((package_handle(self).*getMethod)());
 }
 
+template<guint64 (libdnf::PackageHandle::*getMethod)() const>
 static PyObject *
 get_num(_PackageObject *self, void *closure)
 {
-    guint64 (*func)(DnfPackage*);
-    func = (guint64 (*)(DnfPackage*))closure;
-    return PyLong_FromUnsignedLongLong(func(self->package));
+    return PyLong_FromUnsignedLongLong((package_handle(self).*getMethod)());
 }
 
 static PyObject *
 get_reldep(_PackageObject *self, void *closure)
 {
     DnfReldepList *(*func)(DnfPackage*) = (DnfReldepList *(*)(DnfPackage*))closure;
-    std::unique_ptr<DnfReldepList> reldeplist(func(self->package));
+    std::unique_ptr<DnfReldepList> reldeplist(func(package_get(self)));
     assert(reldeplist);
     PyObject *list = reldeplist_to_pylist(reldeplist.get(), self->sack);
 
     return list;
 }
 
+template<const char *(libdnf::PackageHandle::*getMethod)() const>
 static PyObject *
 get_str(_PackageObject *self, void *closure)
 {
-    const char *(*func)(DnfPackage*);
-    const char *cstr;
-
-    func = (const char *(*)(DnfPackage*))closure;
-    cstr = func(self->package);
+    const char *cstr = (package_handle(self).*getMethod)();
     if (cstr == NULL)
         Py_RETURN_NONE;
     return PyUnicode_FromString(cstr);
 }
 
-static PyObject *
-get_str_array(_PackageObject *self, void *closure)
+static gboolean
+add_file_cb(const char *filename, const char *basename, gpointer user_data)
 {
-    gchar ** (*func)(DnfPackage*);
-    gchar ** strv;
-
-    func = (gchar **(*)(DnfPackage*))closure;
-    strv = func(self->package);
-    PyObject *list = strlist_to_pylist((const char **)strv);
-    g_strfreev(strv);
+    UniquePtrPyObject str(PyUnicode_FromString(filename));
+    return str && PyList_Append(static_cast<PyObject *>(user_data), str.get()) == 0;
+}
 
-    return list;
+static PyObject *
+get_files(_PackageObject *self, void *closure)
+{
+    UniquePtrPyObject list(PyList_New(0));
+    if (!list)
+        return NULL;
+    if (!dnf_package_foreach_file(package_get(self), add_file_cb, list.get()))
+        return NULL;
+    return list.release();
 }
 
+template<const unsigned char *(libdnf::PackageHandle::*getMethod)(int *) const>
 static PyObject *
 get_chksum(_PackageObject *self, void *closure)
 {
-    HyChecksum *(*func)(DnfPackage*, int *);
     int type;
-    HyChecksum *cs;
-
-    func = (HyChecksum *(*)(DnfPackage*, int *))closure;
-    cs = func(self->package, &type);
+    const HyChecksum *cs = (package_handle(self).*getMethod)(&type);
     if (cs == 0) {
         Py_RETURN_NONE;
     }
@@ -258,50 +287,39 @@ get_chksum(_PackageObject *self, void *closure)
 static PyObject *
 get_changelogs(_PackageObject *self, void *closure)
 {
-    return changelogslist_to_pylist(dnf_package_get_changelogs(self->package));
+    return changelogslist_to_pylist(dnf_package_get_changelogs(package_get(self)));
 }
 
 static PyGetSetDef package_getsetters[] = {
-    {(char*)"baseurl",        (getter)get_str, NULL, NULL,
-     (void *)dnf_package_get_baseurl},
-    {(char*)"files",        (getter)get_str_array, NULL, NULL,
-     (void *)dnf_package_get_files},
+    {(char*)"baseurl", (getter)get_str<&libdnf::PackageHandle::getBaseurl>, NULL, NULL, NULL},
+    {(char*)"files", (getter)get_files, NULL, NULL, NULL},
     {(char*)"changelogs", (getter)get_changelogs, NULL, NULL, NULL},
-    {(char*)"hdr_end", (getter)get_num, NULL, NULL, (void *)dnf_package_get_hdr_end},
-    {(char*)"location",  (getter)get_str, NULL, NULL,
-     (void *)dnf_package_get_location},
-    {(char*)"sourcerpm",  (getter)get_str, NULL, NULL,
-     (void *)dnf_package_get_sourcerpm},
-    {(char*)"version",  (getter)get_str, NULL, NULL,
-     (void *)dnf_package_get_version},
-    {(char*)"release",  (getter)get_str, NULL, NULL,
-     (void *)dnf_package_get_release},
-    {(char*)"name", (getter)get_str, NULL, NULL, (void *)dnf_package_get_name},
-    {(char*)"arch", (getter)get_str, NULL, NULL, (void *)dnf_package_get_arch},
-    {(char*)"hdr_chksum", (getter)get_chksum, NULL, NULL,
-     (void *)dnf_package_get_hdr_chksum},
-    {(char*)"chksum", (getter)get_chksum, NULL, NULL, (void *)dnf_package_get_chksum},
-    {(char*)"description", (getter)get_str, NULL, NULL,
-     (void *)dnf_package_get_description},
-    {(char*)"evr",  (getter)get_str, NULL, NULL, (void *)dnf_package_get_evr},
-    {(char*)"group",  (getter)get_str, NULL, NULL, (void *)dnf_package_get_group},
-    {(char*)"license", (getter)get_str, NULL, NULL, (void *)dnf_package_get_license},
-    {(char*)"packager",  (getter)get_str, NULL, NULL, (void *)dnf_package_get_packager},
-    {(char*)"reponame",  (getter)get_str, NULL, NULL, (void *)dnf_package_get_reponame},
-    {(char*)"summary",  (getter)get_str, NULL, NULL, (void *)dnf_package_get_summary},
-    {(char*)"url",  (getter)get_str, NULL, NULL, (void *)dnf_package_get_url},
-    {(char*)"downloadsize", (getter)get_num, NULL, NULL,
-     (void *)dnf_package_get_downloadsize},
-    {(char*)"epoch", (getter)get_num, NULL, NULL, (void *)dnf_package_get_epoch},
-    {(char*)"installsize", (getter)get_num, NULL, NULL,
-     (void *)dnf_package_get_installsize},
-    {(char*)"buildtime", (getter)get_num, NULL, NULL, (void *)dnf_package_get_buildtime},
-    {(char*)"installtime", (getter)get_num, NULL, NULL,
-     (void *)dnf_package_get_installtime},
-    {(char*)"installed", (getter)get_bool, NULL, NULL, (void *)dnf_package_installed},
-    {(char*)"medianr", (getter)get_num, NULL, NULL, (void *)dnf_package_get_medianr},
-    {(char*)"rpmdbid", (getter)get_num, NULL, NULL, (void *)dnf_package_get_rpmdbid},
-    {(char*)"size", (getter)get_num, NULL, NULL, (void *)dnf_package_get_size},
+    {(char*)"hdr_end", (getter)get_num<&libdnf::PackageHandle::getHdrEnd>, NULL, NULL, NULL},
+    {(char*)"location", (getter)get_str<&libdnf::PackageHandle::getLocation>, NULL, NULL, NULL},
+    {(char*)"sourcerpm", (getter)get_str<&libdnf::PackageHandle::getSourcerpm>, NULL, NULL, NULL},
+    {(char*)"version", (getter)get_str<&libdnf::PackageHandle::getVersion>, NULL, NULL, NULL},
+    {(char*)"release", (getter)get_str<&libdnf::PackageHandle::getRelease>, NULL, NULL, NULL},
+    {(char*)"name", (getter)get_str<&libdnf::PackageHandle::getName>, NULL, NULL, NULL},
+    {(char*)"arch", (getter)get_str<&libdnf::PackageHandle::getArch>, NULL, NULL, NULL},
+    {(char*)"hdr_chksum", (getter)get_chksum<&libdnf::PackageHandle::getHdrChksum>, NULL, NULL, NULL},
+    {(char*)"chksum", (getter)get_chksum<&libdnf::PackageHandle::getChksum>, NULL, NULL, NULL},
+    {(char*)"description", (getter)get_str<&libdnf::PackageHandle::getDescription>, NULL, NULL, NULL},
+    {(char*)"evr", (getter)get_str<&libdnf::PackageHandle::getEvr>, NULL, NULL, NULL},
+    {(char*)"group", (getter)get_str<&libdnf::PackageHandle::getGroup>, NULL, NULL, NULL},
+    {(char*)"license", (getter)get_str<&libdnf::PackageHandle::getLicense>, NULL, NULL, NULL},
+    {(char*)"packager", (getter)get_str<&libdnf::PackageHandle::getPackager>, NULL, NULL, NULL},
+    {(char*)"reponame", (getter)get_str<&libdnf::PackageHandle::getReponame>, NULL, NULL, NULL},
+    {(char*)"summary", (getter)get_str<&libdnf::PackageHandle::getSummary>, NULL, NULL, NULL},
+    {(char*)"url", (getter)get_str<&libdnf::PackageHandle::getUrl>, NULL, NULL, NULL},
+    {(char*)"downloadsize", (getter)get_num<&libdnf::PackageHandle::getDownloadsize>, NULL, NULL, NULL},
+    {(char*)"epoch", (getter)get_num<&libdnf::PackageHandle::getEpoch>, NULL, NULL, NULL},
+    {(char*)"installsize", (getter)get_num<&libdnf::PackageHandle::getInstallsize>, NULL, NULL, NULL},
+    {(char*)"buildtime", (getter)get_num<&libdnf::PackageHandle::getBuildtime>, NULL, NULL, NULL},
+    {(char*)"installtime", (getter)get_num<&libdnf::PackageHandle::getInstalltime>, NULL, NULL, NULL},
+    {(char*)"installed", (getter)get_bool<&libdnf::PackageHandle::isInstalled>, NULL, NULL, NULL},
+    {(char*)"medianr", (getter)get_num<&libdnf::PackageHandle::getMedianr>, NULL, NULL, NULL},
+    {(char*)"rpmdbid", (getter)get_num<&libdnf::PackageHandle::getRpmdbid>, NULL, NULL, NULL},
+    {(char*)"size", (getter)get_num<&libdnf::PackageHandle::getSize>, NULL, NULL, NULL},
     {(char*)"conflicts",  (getter)get_reldep, NULL, NULL,
      (void *)dnf_package_get_conflicts},
     {(char*)"enhances",  (getter)get_reldep, NULL, NULL,
@@ -328,10 +346,11 @@ static PyGetSetDef package_getsetters[] = {
 static PyObject *
 evr_cmp(_PackageObject *self, PyObject *other)
 {
-    DnfPackage *pkg2 = packageFromPyObject(other);
-    if (pkg2 == NULL)
+    if (!PyType_IsSubtype(other->ob_type, &package_Type)) {
+        PyErr_SetString(PyExc_TypeError, "Expected a Package object.");
         return NULL;
-    return PyLong_FromLong(dnf_package_evr_cmp(self->package, pkg2));
+    }
+    return PyLong_FromLong(package_handle(self).evrCmp(package_handle((_PackageObject *)other)));
 }
 
 static PyObject *
@@ -340,7 +359,7 @@ get_delta_from_evr(_PackageObject *self, PyObject *evr_str)
     PycompString evr(evr_str);
     if (!evr.getCString())
         return NULL;
-    DnfPackageDelta *delta_c = dnf_package_get_delta_from_evr(self->package, evr.getCString());
+    DnfPackageDelta *delta_c = dnf_package_get_delta_from_evr(package_get(self), evr.getCString());
     if (delta_c)
         return packageDeltaToPyObject(delta_c);
     Py_RETURN_NONE;
@@ -356,7 +375,7 @@ get_advisories(_PackageObject *self, PyObject *args)
     if (!PyArg_ParseTuple(args, "i", &cmp_type))
         return NULL;
 
-    advisories = dnf_package_get_advisories(self->package, cmp_type);
+    advisories = dnf_package_get_advisories(package_get(self), cmp_type);
     list = advisorylist_to_pylist(advisories, self->sack);
     g_ptr_array_unref(advisories);
 
@@ -27,5 +27,6 @@ extern PyTypeObject package_Type;
 
 DnfPackage *packageFromPyObject(PyObject *o);
 int package_converter(PyObject *o, DnfPackage **pkg_ptr);
+int packageIdFromPyObject(PyObject *o, DnfSack **sack_ptr, Id *id_ptr);
 
 #endif // PACKAGE_PY_H
@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <Python.h>
+
+#include <vector>
+
+// hawkey
+#include "sack/packageset.hpp"
+
+// pyhawkey
+#include "iutil-py.hpp"
+#include "package-py.hpp"
+#include "packageset-py.hpp"
+#include "sack-py.hpp"
+
+#include "pycomp.hpp"
+
+/* Read-only sequence of packages backed by a PackageSet. Package objects are
+ * created on access, the Ids are listed in an array on the first indexing. */
+typedef struct {
+    PyObject_HEAD
+    DnfPackageSet *pset;
+    std::vector<Id> *ids;
+    PyObject *sack;
+} _PackageSetObject;
+
+DnfPackageSet *
+packagesetFromPyObject(PyObject *o)
+{
+    if (!packagesetObject_Check(o)) {
+        PyErr_SetString(PyExc_TypeError, "Expected a PackageSet object.");
+        return NULL;
+    }
+    return ((_PackageSetObject *)o)->pset;
+}
+
+PyObject *
+packagesetToPyObject(std::unique_ptr<DnfPackageSet> && pset, PyObject *sack)
+{
+    _PackageSetObject *self = (_PackageSetObject *)packageset_Type.tp_alloc(&packageset_Type, 0);
+    if (self == NULL)
+        return NULL;
+    self->pset = pset.release();
+    self->ids = NULL;
+    self->sack = sack;
+    Py_INCREF(sack);
+    return (PyObject *)self;
+}
+
+static const std::vector<Id> &
+packageset_ids(_PackageSetObject *self)
+{
+    if (!self->ids) {
+        self->ids = new std::vector<Id>;
+        self->ids->reserve(self->pset->size());
+        for (Id id = self->pset->next(-1); id != -1; id = self->pset->next(id))
+            self->ids->push_back(id);
+    }
+    return *self->ids;
+}
+
+/* new reference to the list of the packages, or to the object itself if it
+ * is not a PackageSet */
+static PyObject *
+packageset_as_list(PyObject *o)
+{
+    if (packagesetObject_Check(o)) {
+        auto self = (_PackageSetObject *)o;
+        return packageset_to_pylist(self->pset, self->sack);
+    }
+    Py_INCREF(o);
+    return o;
+}
+
+/* functions on the type */
+
+static void
+packageset_dealloc(_PackageSetObject *self)
+{
+    delete self->pset;
+    delete self->ids;
+    Py_XDECREF(self->sack);
+    Py_TYPE(self)->tp_free(self);
+}
+
+static PyObject *
+packageset_repr(_PackageSetObject *self)
+{
+    return PyString_FromFormat("<hawkey.PackageSet object, %zu packages>", self->pset->size());
+}
+
+static PyObject *
+packageset_richcompare(PyObject *self, PyObject *other, int op)
+{
+    if ((op == Py_EQ || op == Py_NE) && packagesetObject_Check(self) &&
+        packagesetObject_Check(other)) {
+        auto self_pset = ((_PackageSetObject *)self)->pset;
+        auto other_pset = ((_PackageSetObject *)other)->pset;
+        bool equal = self_pset->size() == other_pset->size();
+        for (Id id = self_pset->next(-1); equal && id != -1; id = self_pset->next(id))
+            equal = other_pset->has(id);
+        PyObject *v = TEST_COND(equal == (op == Py_EQ));
+        Py_INCREF(v);
+        return v;
+    }
+
+    // anything else compares like the list of the packages
+    UniquePtrPyObject self_list(packageset_as_list(self));
+    UniquePtrPyObject other_list(packageset_as_list(other));
+    if (!self_list || !other_list)
+        return NULL;
+    return PyObject_RichCompare(self_list.get(), other_list.get(), op);
+}
+
+/* sequence and mapping protocols */
+
+static Py_ssize_t
+packageset_len(_PackageSetObject *self)
+{
+    return self->pset->size();
+}
+
+static PyObject *
+packageset_get_item(_PackageSetObject *self, Py_ssize_t index)
+{
+    auto & ids = packageset_ids(self);
+    if (index < 0 || index >= (Py_ssize_t)ids.size()) {
+        PyErr_SetString(PyExc_IndexError, "list index out of range");
+        return NULL;
+    }
+    return new_package(self->sack, ids[index]);
+}
+
+static int
+packageset_contains(_PackageSetObject *self, PyObject *pypkg)
+{
+    DnfSack *sack;
+    Id id;
+    if (!packageIdFromPyObject(pypkg, &sack, &id)) {
+        PyErr_Clear();
+        return 0;
+    }
+    return sack == self->pset->getSack() && self->pset->has(id);
+}
+
+static PyObject *
+packageset_subscript(_PackageSetObject *self, PyObject *item)
+{
+    if (PySlice_Check(item)) {
+        auto & ids = packageset_ids(self);
+        Py_ssize_t start, stop, step, slicelength;
+#if PY_MAJOR_VERSION >= 3
+        if (PySlice_GetIndicesEx(item, ids.size(), &start, &stop, &step, &slicelength) < 0)
+#else
+        if (PySlice_GetIndicesEx((PySliceObject *)item, ids.size(), &start, &stop, &step,
+                                 &slicelength) < 0)
+#endif
+            return NULL;
+        UniquePtrPyObject list(PyList_New(slicelength));
+        if (!list)
+            return NULL;
+        for (Py_ssize_t i = 0, index = start; i < slicelength; ++i, index += step) {
+            PyObject *package = new_package(self->sack, ids[index]);
+            if (!package)
+                return NULL;
+            PyList_SET_ITEM(list.get(), i, package);
+        }
+        return list.release();
+    }
+
+    Py_ssize_t index = PyNumber_AsSsize_t(item, PyExc_IndexError);
+    if (index == -1 && PyErr_Occurred())
+        return NULL;
+    if (index < 0)
+        index += self->pset->size();
+    return packageset_get_item(self, index);
+}
+
+/* object methods */
+
+static PyObject *
+packageset_columns(_PackageSetObject *self, PyObject *args)
+{
+    return packageset_to_pycolumns(self->pset, args);
+}
+
+static struct PyMethodDef packageset_methods[] = {
+    {"columns", (PyCFunction)packageset_columns, METH_VARARGS, NULL},
+    {NULL}                      /* sentinel */
+};
+
+/* number protocol, concatenation gives a list like for the lists returned
+ * before, the set operators give a new PackageSet */
+
+static PyObject *
+packageset_add(PyObject *self, PyObject *other)
+{
+    UniquePtrPyObject self_list(packageset_as_list(self));
+    UniquePtrPyObject other_list(packageset_as_list(other));
+    if (!self_list || !other_list)
+        return NULL;
+    return PySequence_Concat(self_list.get(), other_list.get());
+}
+
+template<libdnf::PackageSet & (libdnf::PackageSet::*operation)(const libdnf::PackageSet &)>
+static PyObject *
+packageset_operation(PyObject *self, PyObject *other)
+{
+    auto pyset = (_PackageSetObject *)(packagesetObject_Check(self) ? self : other);
+    DnfSack *sack = pyset->pset->getSack();
+    auto self_pset = pyseq_to_packageset(self, sack);
+    std::unique_ptr<DnfPackageSet> other_pset;
+    if (self_pset)
+        other_pset = pyseq_to_packageset(other, sack);
+    if (!self_pset || !other_pset) {
+        if (PyErr_ExceptionMatches(PyExc_TypeError)) {
+            PyErr_Clear();
+            Py_INCREF(Py_NotImplemented);
+            return Py_NotImplemented;
+        }
+        return NULL;
+    }
+    ((*self_pset).*operation)(*other_pset);
+    return packagesetToPyObject(std::move(self_pset), pyset->sack);
+}
+
+static PySequenceMethods packageset_sequence = {
+    (lenfunc)packageset_len,                /* sq_length */
+    0,                                      /* sq_concat */
+    0,                                      /* sq_repeat */
+    (ssizeargfunc)packageset_get_item,      /* sq_item */
+    0,                                      /* sq_slice */
+    0,                                      /* sq_ass_item */
+    0,                                      /* sq_ass_slice */
+    (objobjproc)packageset_contains,        /* sq_contains */
+};
+
+static PyMappingMethods packageset_mapping = {
+    (lenfunc)packageset_len,                /* mp_length */
+    (binaryfunc)packageset_subscript,       /* mp_subscript */
+    0,                                      /* mp_ass_subscript */
+};
+
+static PyNumberMethods packageset_number = {
+    packageset_add,                                             /* nb_add */
+    packageset_operation<&libdnf::PackageSet::operator-=>,      /* nb_subtract */
+    0,                                                          /* nb_multiply */
+#if PY_MAJOR_VERSION < 3
+    0,                                                          /* nb_divide */
+#endif
+    0,                                                          /* nb_remainder */
+    0,                                                          /* nb_divmod */
+    0,                                                          /* nb_power */
+    0,                                                          /* nb_negative */
+    0,                                                          /* nb_positive */
+    0,                                                          /* nb_absolute */
+    0,                                                          /* nb_bool */
+    0,                                                          /* nb_invert */
+    0,                                                          /* nb_lshift */
+    0,                                                          /* nb_rshift */
+    packageset_operation<&libdnf::PackageSet::operator/=>,      /* nb_and */
+    0,                                                          /* nb_xor */
+    packageset_operation<&libdnf::PackageSet::operator+=>,      /* nb_or */
+};
+
+PyTypeObject packageset_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_hawkey.PackageSet",                /*tp_name*/
+    sizeof(_PackageSetObject),        /*tp_basicsize*/
+    0,                                /*tp_itemsize*/
+    (destructor) packageset_dealloc, /*tp_dealloc*/
+    0,                                /*tp_print*/
+    0,                                /*tp_getattr*/
+    0,                                /*tp_setattr*/
+    0,                                /*tp_compare*/
+    (reprfunc)packageset_repr,        /*tp_repr*/
+    &packageset_number,               /*tp_as_number*/
+    &packageset_sequence,             /*tp_as_sequence*/
+    &packageset_mapping,              /*tp_as_mapping*/
+    PyObject_HashNotImplemented,      /*tp_hash */
+    0,                                /*tp_call*/
+    0,                                /*tp_str*/
+    0,                                /*tp_getattro*/
+    0,                                /*tp_setattro*/
+    0,                                /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_CHECKTYPES,        /*tp_flags*/
+    "PackageSet object",                /* tp_doc */
+    0,                                /* tp_traverse */
+    0,                                /* tp_clear */
+    packageset_richcompare,           /* tp_richcompare */
+    0,                                /* tp_weaklistoffset */
+    0,                                /* tp_iter */
+    0,                                /* tp_iternext */
+    packageset_methods,               /* tp_methods */
+    0,                                /* tp_members */
+    0,                                /* tp_getset */
+    0,                                /* tp_base */
+    0,                                /* tp_dict */
+    0,                                /* tp_descr_get */
+    0,                                /* tp_descr_set */
+    0,                                /* tp_dictoffset */
+    0,                                /* tp_init */
+    0,                                /* tp_alloc */
+    0,                                /* tp_new */
+    0,                                /* tp_free */
+    0,                                /* tp_is_gc */
+};
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef PACKAGESET_PY_H
+#define PACKAGESET_PY_H
+
+#include <memory>
+
+#include "hy-types.h"
+
+extern PyTypeObject packageset_Type;
+
+#define packagesetObject_Check(o)   PyObject_TypeCheck(o, &packageset_Type)
+
+DnfPackageSet *packagesetFromPyObject(PyObject *o);
+PyObject *packagesetToPyObject(std::unique_ptr<DnfPackageSet> && pset, PyObject *sack);
+
+#endif // PACKAGESET_PY_H
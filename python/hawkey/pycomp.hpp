@@ -30,6 +30,7 @@
     #define PyString_FromFormat PyUnicode_FromFormat
     #define PyString_Check PyBytes_Check
     #define Py_TPFLAGS_HAVE_ITER 0
+    #define Py_TPFLAGS_CHECKTYPES 0
 #endif
 
 // uniform way to define Python 2 and Python 3 modules
@@ -37,6 +37,7 @@
 #include "hawkey-pysys.hpp"
 #include "iutil-py.hpp"
 #include "package-py.hpp"
+#include "packageset-py.hpp"
 #include "query-py.hpp"
 #include "reldep-py.hpp"
 #include "sack-py.hpp"
@@ -597,11 +598,15 @@ add_upgrades_filter(_QueryObject *self, PyObject *unused)
 static PyObject *
 run(_QueryObject *self, PyObject *unused)
 {
-    PyObject *list;
-
     const DnfPackageSet * pset = self->query->runSet();
-    list = packageset_to_pylist(pset, self->sack);
-    return list;
+    return packagesetToPyObject(std::unique_ptr<DnfPackageSet>(new libdnf::PackageSet(*pset)),
+                                self->sack);
+}
+
+static PyObject *
+q_columns(_QueryObject *self, PyObject *args)
+{
+    return packageset_to_pycolumns(self->query->runSet(), args);
 }
 
 static PyObject *
@@ -754,8 +759,9 @@ q_add(_QueryObject *self, PyObject *list)
         PyErr_SetString(PyExc_TypeError, "Only a list can be concatenated to a Query");
         return NULL;
     }
-    PyObject *unused = NULL;
-    PyObject *query_list = run(self, unused);
+    PyObject *query_list = packageset_to_pylist(self->query->runSet(), self->sack);
+    if (!query_list)
+        return NULL;
 
     int list_count = PyList_Size(list);
     for (int index = 0; index < list_count; ++index)
@@ -813,11 +819,10 @@ query_get_item_by_pyindex(PyObject *self, PyObject *index)
 static PyObject *
 query_iter(PyObject *self)
 {
-    const DnfPackageSet * pset = ((_QueryObject *) self)->query->runSet();
-    UniquePtrPyObject list(packageset_to_pylist(pset, ((_QueryObject *) self)->sack));
-    PyObject *iter = PyObject_GetIter(list.get());
-    Py_INCREF(iter);
-    return iter;
+    UniquePtrPyObject result(run((_QueryObject *) self, NULL));
+    if (!result)
+        return NULL;
+    return PyObject_GetIter(result.get());
 }
 
 static PyObject *
@@ -991,6 +996,7 @@ static struct PyMethodDef query_methods[] = {
      NULL},
     {"apply", (PyCFunction)apply, METH_NOARGS,
      NULL},
+    {"columns", (PyCFunction)q_columns, METH_VARARGS, NULL},
     {"available", (PyCFunction)add_available_filter, METH_NOARGS, NULL},
     {"downgrades", (PyCFunction)add_downgrades_filter, METH_NOARGS, NULL},
     {"duplicated", (PyCFunction)duplicated_filter, METH_NOARGS, NULL},
@@ -180,3 +180,66 @@ class FullPropertiesTest(base.TestCase):
 
     def test_sourcerpm(self):
         self.assertEqual(self.pkg.sourcerpm, 'mystery-19.67-1.src.rpm')
+
+class PackageHandleTest(base.TestCase):
+    """Tests the accessors read through the sack and the Id of a Package."""
+
+    def setUp(self):
+        self.sack = base.TestSack(repo_dir=self.repo_dir)
+        self.sack.load_system_repo()
+        self.sack.load_repo(load_filelists=True)
+        self.pkg = base.by_name_repo(self.sack, "tour", "messerk")
+
+    def test_accessors(self):
+        pkg = self.pkg
+        self.assertEqual(pkg.name, "tour")
+        self.assertEqual(pkg.epoch, 0)
+        self.assertEqual(pkg.version, "4")
+        self.assertEqual(pkg.release, "6")
+        self.assertEqual(pkg.arch, "noarch")
+        self.assertEqual(pkg.evr, "4-6")
+        self.assertEqual(pkg.reponame, "messerk")
+        self.assertEqual(pkg.location, "tour-4-6.noarch.rpm")
+        self.assertEqual(pkg.baseurl, "disagree")
+        self.assertEqual(pkg.sourcerpm, "tour-4-6.src.rpm")
+        self.assertEqual(pkg.summary, "tour package")
+        self.assertEqual(pkg.license, "GPLv2+")
+        self.assertEqual(pkg.group, "Utilities")
+        self.assertEqual(pkg.packager, "roll up <roll@up.net>")
+        self.assertEqual(pkg.downloadsize, 3000)
+        self.assertEqual(pkg.installsize, 193)
+        self.assertEqual(pkg.buildtime, 1404109194)
+        self.assertEqual(pkg.hdr_end, 2616)
+        self.assertFalse(pkg.installed)
+        self.assertEqual(str(pkg), "tour-4-6.noarch")
+
+    def test_installed(self):
+        pkg = base.by_name_repo(self.sack, "fool", hawkey.SYSTEM_REPO_NAME)
+        self.assertTrue(pkg.installed)
+        self.assertEqual(pkg.reponame, hawkey.SYSTEM_REPO_NAME)
+
+    def test_same_package(self):
+        # a Package built from the sack and the Id refers to the same package
+        pkg = hawkey.Package((self.sack, hash(self.pkg)))
+        self.assertIsNot(pkg, self.pkg)
+        self.assertEqual(pkg, self.pkg)
+        self.assertFalse(pkg != self.pkg)
+        self.assertEqual(pkg.evr_cmp(self.pkg), 0)
+        self.assertEqual(hash(pkg), hash(self.pkg))
+        self.assertEqual(len(set([pkg, self.pkg])), 1)
+        self.assertEqual(str(pkg), str(self.pkg))
+        self.assertEqual(pkg.installsize, self.pkg.installsize)
+
+    def test_same_package_promoted(self):
+        # reading the files creates the DnfPackage of only one of them
+        pkg = hawkey.Package((self.sack, hash(self.pkg)))
+        self.assertLength(pkg.files, 6)
+        self.assertEqual(pkg, self.pkg)
+        self.assertEqual(hash(pkg), hash(self.pkg))
+        self.assertIn(pkg, {self.pkg: True})
+
+    def test_other_package(self):
+        other = base.by_name_repo(self.sack, "mystery-devel", "messerk")
+        self.assertNotEqual(other, self.pkg)
+        self.assertNotEqual(hash(other), hash(self.pkg))
+        self.assertEqual(len(set([other, self.pkg])), 2)
@@ -63,6 +63,17 @@ class TestQuery(base.TestCase):
         self.assertFalse(q)
         self.assertEqual(len(q.run()), 0)
 
+    def test_columns(self):
+        q = hawkey.Query(self.sack).filter(name=["jay", "penny"])
+        names, evrs, reponames, sizes = q.columns("name", "evr", "reponame", "size")
+        self.assertEqual(names, [p.name for p in q])
+        self.assertEqual(evrs, [p.evr for p in q])
+        self.assertEqual(reponames, [p.reponame for p in q])
+        self.assertEqual(sizes, [p.size for p in q])
+        self.assertIs(reponames[0], reponames[-1])
+        self.assertEqual(q.run().columns("arch"), q.columns("arch"))
+        self.assertRaises(ValueError, q.columns, "color")
+
     def test_kwargs_check(self):
         q = hawkey.Query(self.sack)
         self.assertRaises(hawkey.ValueException, q.filter, name="flying", upgrades="maracas")
@@ -467,6 +478,23 @@ class TestQuerySetOperations(base.TestCase):
         union = set(self.q1.run() + self.q2.run())
         self.assertEqual(set(qu), union)
 
+    def test_run_packageset(self):
+        res1 = self.q1.run()
+        res2 = self.q2.run()
+        self.assertIsInstance(res1, hawkey.PackageSet)
+        self.assertEqual(len(res1), self.q1.count())
+        self.assertEqual(list(res1), [p for p in self.q1])
+        self.assertEqual(res1[-1], list(res1)[-1])
+        self.assertEqual(res1[:2], list(res1)[:2])
+        self.assertRaises(IndexError, lambda: res1[len(res1)])
+        for pkg in res2:
+            self.assertIn(pkg, res2)
+            self.assertEqual(pkg in res1, pkg in self.q1)
+        self.assertEqual(res1 | res2, self.q1.union(self.q2).run())
+        self.assertEqual(res1 & res2, self.q1.intersection(self.q2).run())
+        self.assertEqual(res1 - res2, self.q1.difference(self.q2).run())
+        self.assertIsInstance(res1 + res2, list)
+
     def test_zzz_queries_not_modified(self):
         self.assertEqual(len(self.q1), 5)
         self.assertEqual(len(self.q2), 5)
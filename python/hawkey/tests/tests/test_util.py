@@ -60,3 +60,36 @@ class UtilWithSack(base.TestCase):
         self.assertLength(q, 1)
         pkg = str(q[0])
         self.assertEqual(pkg, "baby-6:5.0-11.x86_64")
+
+class Metrics(base.TestCase):
+    def setUp(self):
+        self.sack = base.TestSack(repo_dir=self.repo_dir)
+        self.sack.load_system_repo()
+        hawkey.reset_metrics()
+        hawkey.set_metrics_enabled(True)
+
+    def tearDown(self):
+        hawkey.set_metrics_enabled(False)
+        hawkey.reset_metrics()
+
+    def test_query(self):
+        self.assertTrue(hawkey.metrics_enabled())
+        q = hawkey.Query(self.sack).filter(name="baby")
+        self.assertLength(q, 1)
+
+        metrics = hawkey.metrics()
+        self.assertEqual(metrics["counters"]["query_apply"], 1)
+        name = metrics["filters"]["name"]
+        self.assertEqual(name["count"], 1)
+        self.assertEqual(name["matched"], 1)
+        self.assertGreater(name["scanned"], name["matched"])
+        self.assertEqual(sum(name["buckets"]), 1)
+        self.assertEqual(metrics["timers"]["query_apply"]["count"], 1)
+
+    def test_disabled(self):
+        hawkey.set_metrics_enabled(False)
+        q = hawkey.Query(self.sack).filter(name="baby")
+        self.assertLength(q, 1)
+        metrics = hawkey.metrics()
+        self.assertEqual(metrics["counters"]["query_apply"], 0)
+        self.assertEqual(metrics["filters"], {})
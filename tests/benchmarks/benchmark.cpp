@@ -0,0 +1,447 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Runs every benchmark on synthetic repos of each of the given sizes and
+ * prints one JSON object per benchmark and size:
+ *
+ *   {"benchmark": "query_name_eq", "packages": 10000, "isa": "avx2",
+ *    "iterations": 20, "min_ns": ..., "median_ns": ..., "mean_ns": ..., "max_ns": ...}
+ *
+ * The isa field names the bitmap kernels of the package sets, see --isa.
+ * The subjects of the queries rotate through samples of the generated
+ * packages, so the timings do not depend on a single lucky name. */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repo_solv.h>
+#include <solv/repo_write.h>
+
+#include "libdnf/dnf-goal.h"
+#include "libdnf/dnf-package.h"
+#include "libdnf/dnf-sack-private.hpp"
+#include "libdnf/dnf-transaction-private.hpp"
+#include "libdnf/hy-repo.h"
+#include "libdnf/hy-repo-private.hpp"
+#include "libdnf/hy-selector.h"
+#include "libdnf/goal/Goal.hpp"
+#include "libdnf/module/ModulePackageContainer.hpp"
+#include "libdnf/repo/solvable/Dependency.hpp"
+#include "libdnf/sack/query.hpp"
+#include "libdnf/sack/Solution.hpp"
+#include "libdnf/sack/packageset.hpp"
+#include "libdnf/utils/bitmap.hpp"
+#include "synthetic.hpp"
+
+#define BENCHMARK_SEED 42
+
+struct Fixture {
+    DnfSack *sack;
+    SyntheticRepos repos;
+    gchar *solv_path;
+    gchar *install_root;
+    unsigned round;
+    /* all packages and every 50th package, for the set algebra */
+    std::unique_ptr<libdnf::PackageSet> dense;
+    std::unique_ptr<libdnf::PackageSet> sparse;
+    std::unique_ptr<libdnf::PackageSet> scratch;
+
+    /* the next sample of a kind, a different one in every run */
+    const std::string &
+    next(const std::vector<std::string> &samples)
+    {
+        return samples[round++ % samples.size()];
+    }
+};
+
+struct Benchmark {
+    const char *name;
+    /* not timed, run before every iteration */
+    std::function<void(Fixture &)> prepare;
+    std::function<void(Fixture &)> run;
+};
+
+static DnfSack *
+create_sack(const char *cachedir)
+{
+    DnfSack *sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, cachedir);
+    dnf_sack_set_arch(sack, "x86_64", NULL);
+    return sack;
+}
+
+static void
+run_query(DnfSack *sack, int keyname, int cmp_type, const char *match)
+{
+    libdnf::Query query(sack);
+    query.addFilter(keyname, cmp_type, match);
+    query.size();
+}
+
+static void
+run_query_reldep(DnfSack *sack, int keyname, const std::string &reldep)
+{
+    libdnf::Dependency dependency(sack, reldep);
+    libdnf::Query query(sack);
+    query.addFilter(keyname, &dependency);
+    query.size();
+}
+
+static std::unique_ptr<libdnf::ModulePackageContainer>
+load_modules(Fixture &fixture)
+{
+    std::unique_ptr<libdnf::ModulePackageContainer> modules(
+        new libdnf::ModulePackageContainer(false, fixture.install_root, "x86_64"));
+    modules->add(fixture.repos.modulemd, SYNTHETIC_REPO_NAME);
+    modules->createConflictsBetweenStreams();
+    return modules;
+}
+
+static std::unique_ptr<libdnf::ModulePackageContainer> prepared_modules;
+/* resolved once per size, the same for every run */
+static std::unique_ptr<libdnf::Goal> prepared_upgrade;
+static GPtrArray *prepared_upgrades;
+
+static void
+prepare_upgrade(Fixture &f)
+{
+    if (prepared_upgrade)
+        return;
+    prepared_upgrade.reset(new libdnf::Goal(f.sack));
+    prepared_upgrade->upgrade();
+    prepared_upgrade->run(DNF_NONE);
+    prepared_upgrades = dnf_goal_get_packages(prepared_upgrade.get(),
+                                              DNF_PACKAGE_INFO_UPDATE,
+                                              DNF_PACKAGE_INFO_DOWNGRADE,
+                                              DNF_PACKAGE_INFO_REINSTALL,
+                                              -1);
+}
+
+/* the benchmarks can not go on without their files */
+static FILE *
+open_or_exit(const char *path, const char *mode)
+{
+    FILE *fp = fopen(path, mode);
+    if (!fp) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, g_strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    return fp;
+}
+
+static void
+write_solv(Fixture &f)
+{
+    Pool *pool = dnf_sack_get_pool(f.sack);
+    Repo *repo = NULL;
+    Id id;
+    FOR_REPOS(id, repo) {
+        if (strcmp(repo->name, SYNTHETIC_REPO_NAME) == 0)
+            break;
+    }
+    FILE *fp = open_or_exit(f.solv_path, "w");
+    if (repo_write(repo, fp) != 0 || fclose(fp) != 0) {
+        fprintf(stderr, "Cannot write %s: %s\n", f.solv_path, pool_errstr(pool));
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void
+prepare_scratch(Fixture &f)
+{
+    f.scratch.reset(new libdnf::PackageSet(*f.dense));
+}
+
+static const std::vector<Benchmark> benchmarks = {
+    {"query_name_eq", nullptr, [](Fixture &f) {
+        run_query(f.sack, HY_PKG_NAME, HY_EQ, f.next(f.repos.names).c_str());
+    }},
+    {"query_name_glob", nullptr, [](Fixture &f) {
+        std::string glob = f.next(f.repos.names).substr(0, 8) + "*";
+        run_query(f.sack, HY_PKG_NAME, HY_GLOB, glob.c_str());
+    }},
+    {"query_nevra", nullptr, [](Fixture &f) {
+        run_query(f.sack, HY_PKG_NEVRA, HY_EQ, f.next(f.repos.nevras).c_str());
+    }},
+    {"query_provides", nullptr, [](Fixture &f) {
+        run_query_reldep(f.sack, HY_PKG_PROVIDES, f.next(f.repos.provides));
+    }},
+    {"query_requires", nullptr, [](Fixture &f) {
+        run_query_reldep(f.sack, HY_PKG_REQUIRES, f.next(f.repos.provides));
+    }},
+    {"query_file", nullptr, [](Fixture &f) {
+        run_query(f.sack, HY_PKG_FILE, HY_EQ, f.next(f.repos.files).c_str());
+    }},
+    {"query_file_glob", nullptr, [](Fixture &f) {
+        std::string glob = f.next(f.repos.files);
+        glob = glob.substr(0, glob.rfind('/')) + "/*";
+        run_query(f.sack, HY_PKG_FILE, HY_GLOB, glob.c_str());
+    }},
+    {"query_latest_per_arch", nullptr, [](Fixture &f) {
+        libdnf::Query query(f.sack);
+        query.addFilter(HY_PKG_LATEST_PER_ARCH, HY_EQ, 1);
+        query.size();
+    }},
+    {"query_upgrades", nullptr, [](Fixture &f) {
+        libdnf::Query query(f.sack);
+        query.addFilter(HY_PKG_UPGRADES, HY_EQ, 1);
+        query.size();
+    }},
+    {"query_advisory_type", nullptr, [](Fixture &f) {
+        run_query(f.sack, HY_PKG_ADVISORY_TYPE, HY_EQ, "security");
+    }},
+    {"query_advisory_cve", nullptr, [](Fixture &f) {
+        run_query(f.sack, HY_PKG_ADVISORY_CVE, HY_EQ, f.next(f.repos.cves).c_str());
+    }},
+    {"best_solution", nullptr, [](Fixture &f) {
+        libdnf::Solution solution;
+        solution.getBestSolution(f.next(f.repos.nevras).c_str(), f.sack, NULL, false,
+                                 true, true, true, false);
+    }},
+    {"goal_install", nullptr, [](Fixture &f) {
+        libdnf::Goal goal(f.sack);
+        HySelector sltr = hy_selector_create(f.sack);
+        hy_selector_set(sltr, HY_PKG_NAME, HY_EQ, f.next(f.repos.names).c_str());
+        goal.install(sltr, false);
+        hy_selector_free(sltr);
+        goal.run(DNF_NONE);
+    }},
+    {"goal_upgrade_all", nullptr, [](Fixture &f) {
+        libdnf::Goal goal(f.sack);
+        goal.upgrade();
+        goal.run(DNF_NONE);
+    }},
+    /* the packages replaced by an upgrade of every third package, as in a commit */
+    {"transaction_list_obsoletes", prepare_upgrade, [](Fixture &f) {
+        g_array_unref(dnf_transaction_list_obsoletes(prepared_upgrade.get(), prepared_upgrades));
+    }},
+    {"make_provides_ready", [](Fixture &f) {
+        dnf_sack_set_provides_not_ready(f.sack);
+    }, [](Fixture &f) {
+        dnf_sack_make_provides_ready(f.sack);
+    }},
+    {"solv_write", nullptr, write_solv},
+    {"solv_read", write_solv, [](Fixture &f) {
+        DnfSack *sack = create_sack(f.install_root);
+        Pool *pool = dnf_sack_get_pool(sack);
+        HyRepo hrepo = hy_repo_create(SYNTHETIC_REPO_NAME);
+        Repo *repo = repo_create(pool, SYNTHETIC_REPO_NAME);
+        hrepo->libsolv_repo = repo;
+        repo->appdata = hrepo;
+        FILE *fp = open_or_exit(f.solv_path, "r");
+        if (repo_add_solv(repo, fp, 0) != 0) {
+            fprintf(stderr, "Cannot read %s: %s\n", f.solv_path, pool_errstr(pool));
+            exit(EXIT_FAILURE);
+        }
+        fclose(fp);
+        dnf_sack_make_provides_ready(sack);
+        g_object_unref(sack);
+    }},
+    {"pset_count", nullptr, [](Fixture &f) {
+        f.dense->size();
+    }},
+    {"pset_iterate", nullptr, [](Fixture &f) {
+        for (Id id = f.dense->next(-1); id != -1; id = f.dense->next(id))
+            f.round++;
+    }},
+    {"pset_iterate_sparse", nullptr, [](Fixture &f) {
+        for (Id id = f.sparse->next(-1); id != -1; id = f.sparse->next(id))
+            f.round++;
+    }},
+    {"pset_to_ids", nullptr, [](Fixture &f) {
+        f.dense->getIds();
+    }},
+    {"pset_intersect", prepare_scratch, [](Fixture &f) {
+        *f.scratch /= *f.sparse;
+    }},
+    {"pset_union", prepare_scratch, [](Fixture &f) {
+        *f.scratch += *f.sparse;
+    }},
+    {"pset_difference", prepare_scratch, [](Fixture &f) {
+        *f.scratch -= *f.sparse;
+    }},
+    {"module_load", nullptr, [](Fixture &f) {
+        load_modules(f);
+    }},
+    {"module_resolve", [](Fixture &f) {
+        prepared_modules = load_modules(f);
+        for (auto &module : f.repos.modules)
+            prepared_modules->enable(module, "s1");
+    }, [](Fixture &f) {
+        prepared_modules->resolveActiveModulePackages(false);
+    }},
+};
+
+static void
+print_result(FILE *out, const char *name, unsigned npackages, std::vector<uint64_t> &times)
+{
+    std::sort(times.begin(), times.end());
+    uint64_t sum = 0;
+    for (auto time : times)
+        sum += time;
+    fprintf(out, "{\"benchmark\": \"%s\", \"packages\": %u, \"isa\": \"%s\", "
+            "\"iterations\": %zu, "
+            "\"min_ns\": %" G_GUINT64_FORMAT ", \"median_ns\": %" G_GUINT64_FORMAT ", "
+            "\"mean_ns\": %" G_GUINT64_FORMAT ", \"max_ns\": %" G_GUINT64_FORMAT "}\n",
+            name, npackages, libdnf::bitmap::isaToString(libdnf::bitmap::getIsa()),
+            times.size(), times.front(), times[times.size() / 2], sum / times.size(),
+            times.back());
+    fflush(out);
+}
+
+static void
+run_benchmarks(FILE *out, unsigned npackages, unsigned iterations, const char *filter)
+{
+    Fixture fixture;
+    fixture.install_root = g_dir_make_tmp("libdnf-benchmark-XXXXXX", NULL);
+    fixture.solv_path = g_build_filename(fixture.install_root, "synthetic.solv", NULL);
+    fixture.sack = create_sack(fixture.install_root);
+    fixture.repos = synthetic_repos_generate(fixture.sack, npackages, BENCHMARK_SEED);
+    fixture.round = 0;
+    fixture.dense.reset(new libdnf::PackageSet(*libdnf::Query(fixture.sack).getResultPset()));
+    fixture.sparse.reset(new libdnf::PackageSet(fixture.sack));
+    for (Id id = fixture.dense->next(-1); id != -1; id = fixture.dense->next(id)) {
+        if (id % 50 == 0)
+            fixture.sparse->set(id);
+    }
+
+    for (auto &benchmark : benchmarks) {
+        if (filter && !g_pattern_match_simple(filter, benchmark.name))
+            continue;
+        std::vector<uint64_t> times;
+        /* the first run is a warmup, e.g. it makes the provides ready */
+        for (unsigned i = 0; i <= iterations; i++) {
+            if (benchmark.prepare)
+                benchmark.prepare(fixture);
+            auto start = std::chrono::steady_clock::now();
+            benchmark.run(fixture);
+            auto end = std::chrono::steady_clock::now();
+            if (i > 0)
+                times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    end - start).count());
+        }
+        print_result(out, benchmark.name, npackages, times);
+    }
+
+    prepared_modules.reset();
+    if (prepared_upgrades) {
+        g_ptr_array_unref(prepared_upgrades);
+        prepared_upgrades = NULL;
+    }
+    prepared_upgrade.reset();
+    fixture.dense.reset();
+    fixture.sparse.reset();
+    fixture.scratch.reset();
+    g_object_unref(fixture.sack);
+    g_unlink(fixture.solv_path);
+    g_rmdir(fixture.install_root);
+    g_free(fixture.solv_path);
+    g_free(fixture.install_root);
+}
+
+int
+main(int argc, char *argv[])
+{
+    g_autoptr(GOptionContext) context = NULL;
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *sizes = NULL;
+    g_autofree gchar *filter = NULL;
+    g_autofree gchar *output = NULL;
+    g_autofree gchar *isa = NULL;
+    gint iterations = 20;
+    FILE *out = stdout;
+
+    const GOptionEntry options[] = {
+        { "sizes", 's', 0, G_OPTION_ARG_STRING, &sizes,
+          "Comma separated numbers of packages, 10000,100000,300000 by default", "SIZES" },
+        { "iterations", 'i', 0, G_OPTION_ARG_INT, &iterations,
+          "Timed runs of every benchmark, 20 by default", "N" },
+        { "filter", 'f', 0, G_OPTION_ARG_STRING, &filter,
+          "Run only the benchmarks matching the glob", "GLOB" },
+        { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output,
+          "Write the results to the file instead of stdout", "FILE" },
+        { "isa", 0, 0, G_OPTION_ARG_STRING, &isa,
+          "Bitmap kernels to use, generic or avx2, detected by default", "ISA" },
+        { NULL }
+    };
+
+    context = g_option_context_new("- libdnf benchmarks on synthetic repos");
+    g_option_context_add_main_entries(context, options, NULL);
+    if (!g_option_context_parse(context, &argc, &argv, &error)) {
+        fprintf(stderr, "%s\n", error->message);
+        return EXIT_FAILURE;
+    }
+    if (iterations < 1) {
+        fprintf(stderr, "The number of iterations must be positive\n");
+        return EXIT_FAILURE;
+    }
+    if (isa) {
+        bool ok = false;
+        if (g_strcmp0(isa, "generic") == 0)
+            ok = libdnf::bitmap::setIsa(libdnf::bitmap::Isa::GENERIC);
+        else if (g_strcmp0(isa, "avx2") == 0)
+            ok = libdnf::bitmap::setIsa(libdnf::bitmap::Isa::AVX2);
+        if (!ok) {
+            fprintf(stderr, "Unknown or unsupported bitmap kernels: %s\n", isa);
+            return EXIT_FAILURE;
+        }
+    }
+    if (output) {
+        out = fopen(output, "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open %s: %s\n", output, g_strerror(errno));
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* the generator needs at least one name with two versions */
+    g_auto(GStrv) npackages = g_strsplit(sizes ? sizes : "10000,100000,300000", ",", -1);
+    std::vector<unsigned> counts;
+    for (gchar **size = npackages; *size; size++) {
+        gchar *end = NULL;
+        guint64 count = g_ascii_strtoull(*size, &end, 10);
+        if (end == *size || *end != '\0' || count < 2 || count > G_MAXUINT) {
+            fprintf(stderr, "Invalid number of packages: %s, it must be at least 2\n", *size);
+            if (out != stdout)
+                fclose(out);
+            return EXIT_FAILURE;
+        }
+        counts.push_back(count);
+    }
+    for (unsigned count : counts)
+        run_benchmarks(out, count, iterations, filter);
+
+    if (out != stdout)
+        fclose(out);
+    return EXIT_SUCCESS;
+}
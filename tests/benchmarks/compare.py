@@ -0,0 +1,70 @@
+#!/usr/bin/python3
+#
+# Copyright (C) 2018 Red Hat, Inc.
+#
+# Licensed under the GNU Lesser General Public License Version 2.1
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+#
+
+"""Compares the medians of two outputs of benchmark_libdnf.
+
+usage: compare.py BASELINE.json CURRENT.json [--threshold PERCENT]
+
+Exits with 1 if any benchmark got slower by more than the threshold.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    results = {}
+    with open(path) as f:
+        for line in f:
+            if line.strip():
+                result = json.loads(line)
+                results[(result["benchmark"], result["packages"])] = result
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent, 10 by default")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    regressed = False
+    print("%-24s %8s %14s %14s %8s" % ("benchmark", "packages", "baseline ns", "current ns",
+                                         "change"))
+    for key in sorted(set(baseline) & set(current)):
+        before = baseline[key]["median_ns"]
+        after = current[key]["median_ns"]
+        change = (after - before) * 100.0 / before if before else 0.0
+        mark = ""
+        if change > args.threshold:
+            mark = " !"
+            regressed = True
+        print("%-24s %8d %14d %14d %+7.1f%%%s" % (key[0], key[1], before, after, change, mark))
+    return 1 if regressed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
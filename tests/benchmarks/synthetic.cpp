@@ -0,0 +1,336 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <random>
+
+#include <glib.h>
+
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repodata.h>
+
+#include "libdnf/hy-repo.h"
+#include "libdnf/hy-repo-private.hpp"
+#include "synthetic.hpp"
+
+static const char * const prefixes[] = {"", "lib", "python3-", "perl-", "golang-", "rubygem-"};
+static const char * const advisory_types[] = {"security", "bugfix", "enhancement"};
+static const char * const severities[] = {"Critical", "Important", "Moderate", "Low"};
+
+struct Generator {
+    Pool *pool;
+    std::mt19937 rng;
+    std::vector<std::string> names;
+    SyntheticRepos samples;
+
+    unsigned random(unsigned n) { return std::uniform_int_distribution<unsigned>(0, n - 1)(rng); }
+};
+
+/* odd packages have two versions, the others one */
+static unsigned
+versions_of(unsigned index)
+{
+    return index % 2 ? 2 : 1;
+}
+
+static std::string
+evr_of(unsigned index, unsigned version, bool installed)
+{
+    std::string evr = index % 50 == 0 ? "1:" : "";
+    evr += "1." + std::to_string(index % 7) + "." + std::to_string(version);
+    evr += installed ? "-0.fc27" : "-1.fc28";
+    return evr;
+}
+
+static const char *
+arch_of(unsigned index)
+{
+    return index % 10 == 0 ? "noarch" : "x86_64";
+}
+
+static Repo *
+create_repo(DnfSack *sack, const char *name)
+{
+    HyRepo hrepo = hy_repo_create(name);
+    Repo *repo = repo_create(dnf_sack_get_pool(sack), name);
+    hrepo->libsolv_repo = repo;
+    repo->appdata = hrepo;
+    return repo;
+}
+
+static void
+add_files(Generator &gen, Repodata *data, Id p, unsigned index, unsigned version)
+{
+    const std::string &name = gen.names[index];
+    const std::string prefix = prefixes[index % G_N_ELEMENTS(prefixes)];
+    Id dir;
+
+    if (index == 0) {
+        dir = repodata_str2dir(data, "/bin", 1);
+        repodata_add_dirstr(data, p, SOLVABLE_FILELIST, dir, "sh");
+    }
+    if (prefix == "lib") {
+        dir = repodata_str2dir(data, "/usr/lib64", 1);
+        std::string so = name + ".so." + std::to_string(version + 1);
+        repodata_add_dirstr(data, p, SOLVABLE_FILELIST, dir, so.c_str());
+    } else if (prefix == "python3-") {
+        std::string path = "/usr/lib/python3.6/site-packages/" + name.substr(prefix.size());
+        dir = repodata_str2dir(data, path.c_str(), 1);
+        repodata_add_dirstr(data, p, SOLVABLE_FILELIST, dir, "__init__.py");
+        for (unsigned i = gen.random(10); i > 0; i--) {
+            std::string module = "module" + std::to_string(i) + ".py";
+            repodata_add_dirstr(data, p, SOLVABLE_FILELIST, dir, module.c_str());
+        }
+    } else if (prefix == "perl-") {
+        dir = repodata_str2dir(data, "/usr/share/perl5", 1);
+        std::string pm = name.substr(prefix.size()) + ".pm";
+        repodata_add_dirstr(data, p, SOLVABLE_FILELIST, dir, pm.c_str());
+    } else {
+        dir = repodata_str2dir(data, "/usr/bin", 1);
+        repodata_add_dirstr(data, p, SOLVABLE_FILELIST, dir, name.c_str());
+    }
+
+    std::string path = "/usr/share/doc/" + name;
+    dir = repodata_str2dir(data, path.c_str(), 1);
+    repodata_add_dirstr(data, p, SOLVABLE_FILELIST, dir, "README");
+    repodata_add_dirstr(data, p, SOLVABLE_FILELIST, dir, "LICENSE");
+
+    path = "/usr/share/" + name;
+    dir = repodata_str2dir(data, path.c_str(), 1);
+    for (unsigned i = gen.random(25); i > 0; i--) {
+        std::string file = "data" + std::to_string(i) + ".dat";
+        repodata_add_dirstr(data, p, SOLVABLE_FILELIST, dir, file.c_str());
+    }
+}
+
+static Id
+add_package(Generator &gen, Repo *repo, Repodata *data, unsigned index, unsigned version,
+            bool installed)
+{
+    Pool *pool = gen.pool;
+    const std::string &name = gen.names[index];
+    const std::string prefix = prefixes[index % G_N_ELEMENTS(prefixes)];
+    const std::string evr = evr_of(index, version, installed);
+    Id p = repo_add_solvable(repo);
+    Solvable *s = pool_id2solvable(pool, p);
+
+    s->name = pool_str2id(pool, name.c_str(), 1);
+    s->evr = pool_str2id(pool, evr.c_str(), 1);
+    s->arch = pool_str2id(pool, arch_of(index), 1);
+    s->vendor = pool_str2id(pool, "Synthetic", 1);
+
+    /* provides */
+    s->provides = repo_addid_dep(repo, s->provides,
+                                 pool_rel2id(pool, s->name, s->evr, REL_EQ, 1), 0);
+    std::string provide = "bench(" + name + ")";
+    s->provides = repo_addid_dep(repo, s->provides, pool_str2id(pool, provide.c_str(), 1), 0);
+    if (prefix == "lib") {
+        provide = name + ".so." + std::to_string(version + 1) + "()(64bit)";
+        s->provides = repo_addid_dep(repo, s->provides, pool_str2id(pool, provide.c_str(), 1), 0);
+    } else if (prefix == "python3-") {
+        provide = "python3dist(" + name.substr(prefix.size()) + ")";
+        s->provides = repo_addid_dep(repo, s->provides, pool_str2id(pool, provide.c_str(), 1), 0);
+    }
+
+    /* requires, the installed packages have none so that the system is consistent */
+    if (!installed) {
+        Id one = pool_str2id(pool, "1.0", 1);
+        for (unsigned i = 2 + gen.random(7); i > 0; i--) {
+            const std::string &required = gen.names[gen.random(gen.names.size())];
+            Id dep;
+            if (gen.random(4) == 0) {
+                dep = pool_rel2id(pool, pool_str2id(pool, required.c_str(), 1), one,
+                                  REL_GT | REL_EQ, 1);
+            } else {
+                std::string bench = "bench(" + required + ")";
+                dep = pool_str2id(pool, bench.c_str(), 1);
+            }
+            s->requires = repo_addid_dep(repo, s->requires, dep, 0);
+        }
+        if (gen.random(4) == 0)
+            s->requires = repo_addid_dep(repo, s->requires, pool_str2id(pool, "/bin/sh", 1), 0);
+        if (gen.random(5) == 0) {
+            std::string bench = "bench(" + gen.names[gen.random(gen.names.size())] + ")";
+            s->recommends = repo_addid_dep(repo, s->recommends,
+                                           pool_str2id(pool, bench.c_str(), 1), 0);
+        }
+    }
+
+    add_files(gen, data, p, index, version);
+
+    /* primary metadata */
+    std::string summary = "Synthetic package " + name;
+    repodata_set_str(data, p, SOLVABLE_SUMMARY, summary.c_str());
+    repodata_set_str(data, p, SOLVABLE_DESCRIPTION, summary.c_str());
+    repodata_set_poolstr(data, p, SOLVABLE_LICENSE, "MIT");
+    repodata_set_str(data, p, SOLVABLE_URL, "https://example.com/");
+    repodata_set_num(data, p, SOLVABLE_DOWNLOADSIZE, 10000 + gen.random(1000000));
+    repodata_set_num(data, p, SOLVABLE_INSTALLSIZE, 30000 + gen.random(3000000));
+    repodata_set_num(data, p, SOLVABLE_BUILDTIME, 1500000000 + index);
+    if (installed) {
+        repodata_set_num(data, p, SOLVABLE_INSTALLTIME, 1510000000 + index);
+    } else {
+        std::string nevra = pool_solvable2str(pool, s);
+        std::string location = "Packages/" + nevra.substr(0, 1) + "/" + nevra + ".rpm";
+        repodata_set_location(data, p, 0, 0, location.c_str());
+        std::string sourcerpm = name + "-" + evr.substr(evr.find(':') + 1) + ".src.rpm";
+        repodata_set_sourcepkg(data, p, sourcerpm.c_str());
+    }
+    return p;
+}
+
+static void
+add_advisory(Generator &gen, Repo *repo, Repodata *data, unsigned index)
+{
+    Pool *pool = gen.pool;
+    char name[64];
+    Id p = repo_add_solvable(repo);
+    Solvable *s = pool_id2solvable(pool, p);
+    const char *type = advisory_types[index % G_N_ELEMENTS(advisory_types)];
+
+    g_snprintf(name, sizeof(name), "patch:BENCH-2018-%05u", index);
+    s->name = pool_str2id(pool, name, 1);
+    s->evr = pool_str2id(pool, "1", 1);
+    s->arch = pool_str2id(pool, "noarch", 1);
+    repodata_set_poolstr(data, p, SOLVABLE_PATCHCATEGORY, type);
+    repodata_set_str(data, p, SOLVABLE_SUMMARY, "Synthetic update");
+    repodata_set_num(data, p, SOLVABLE_BUILDTIME, 1520000000 + index);
+    if (index % G_N_ELEMENTS(advisory_types) == 0)
+        repodata_set_str(data, p, UPDATE_SEVERITY, severities[gen.random(G_N_ELEMENTS(severities))]);
+
+    /* references */
+    Id handle = repodata_new_handle(data);
+    std::string bug = std::to_string(1000000 + index);
+    repodata_set_poolstr(data, handle, UPDATE_REFERENCE_TYPE, "bugzilla");
+    repodata_set_str(data, handle, UPDATE_REFERENCE_ID, bug.c_str());
+    repodata_add_flexarray(data, p, UPDATE_REFERENCE, handle);
+    if (strcmp(type, "security") == 0) {
+        char cve[32];
+        g_snprintf(cve, sizeof(cve), "CVE-2018-%05u", index);
+        handle = repodata_new_handle(data);
+        repodata_set_poolstr(data, handle, UPDATE_REFERENCE_TYPE, "cve");
+        repodata_set_str(data, handle, UPDATE_REFERENCE_ID, cve);
+        repodata_add_flexarray(data, p, UPDATE_REFERENCE, handle);
+        if (gen.samples.cves.size() < 1000)
+            gen.samples.cves.push_back(cve);
+    }
+
+    /* the updated packages, always the newest version of one with two */
+    for (unsigned i = 1 + gen.random(4); i > 0; i--) {
+        unsigned pkg = 2 * gen.random(gen.names.size() / 2) + 1;
+        std::string evr = evr_of(pkg, 1, false);
+        handle = repodata_new_handle(data);
+        repodata_set_id(data, handle, UPDATE_COLLECTION_NAME,
+                        pool_str2id(pool, gen.names[pkg].c_str(), 1));
+        repodata_set_id(data, handle, UPDATE_COLLECTION_EVR, pool_str2id(pool, evr.c_str(), 1));
+        repodata_set_id(data, handle, UPDATE_COLLECTION_ARCH, pool_str2id(pool, arch_of(pkg), 1));
+        std::string filename = gen.names[pkg] + "-" + evr + "." + arch_of(pkg) + ".rpm";
+        repodata_set_str(data, handle, UPDATE_COLLECTION_FILENAME, filename.c_str());
+        repodata_add_flexarray(data, p, UPDATE_COLLECTION, handle);
+    }
+}
+
+static void
+add_module(Generator &gen, unsigned index, const char *stream)
+{
+    std::string &yaml = gen.samples.modulemd;
+    const std::string name = gen.samples.modules[index];
+
+    yaml += "---\ndocument: modulemd\nversion: 2\ndata:\n";
+    yaml += "  name: " + name + "\n";
+    yaml += std::string("  stream: ") + stream + "\n";
+    yaml += "  version: 1\n  context: 00000000\n  arch: x86_64\n";
+    yaml += "  summary: Synthetic module\n  description: >-\n    Synthetic module\n";
+    yaml += "  license:\n    module:\n    - MIT\n";
+    if (index > 0)
+        yaml += "  dependencies:\n  - requires:\n      " + gen.samples.modules[index / 2] + ": [s1]\n";
+    yaml += "  profiles:\n    default:\n      rpms:\n";
+    std::string artifacts;
+    for (unsigned i = 0; i < 5; i++) {
+        unsigned pkg = gen.random(gen.names.size());
+        std::string evr = evr_of(pkg, 0, false);
+        if (evr.find(':') == std::string::npos)
+            evr = "0:" + evr;
+        yaml += "      - " + gen.names[pkg] + "\n";
+        artifacts += "    - " + gen.names[pkg] + "-" + evr + "." + arch_of(pkg) + "\n";
+    }
+    yaml += "  artifacts:\n    rpms:\n" + artifacts + "...\n";
+}
+
+SyntheticRepos
+synthetic_repos_generate(DnfSack *sack, unsigned npackages, unsigned seed)
+{
+    Generator gen;
+    gen.pool = dnf_sack_get_pool(sack);
+    gen.rng.seed(seed);
+
+    /* half of the names have one version, the other half two */
+    unsigned count = 0;
+    for (unsigned index = 0; count < npackages; index++) {
+        const char *prefix = prefixes[index % G_N_ELEMENTS(prefixes)];
+        char name[64];
+        g_snprintf(name, sizeof(name), "%spkg%06u", prefix, index);
+        gen.names.push_back(name);
+        count += versions_of(index);
+    }
+    gen.names[0] = "bash";
+
+    Repo *available = create_repo(sack, SYNTHETIC_REPO_NAME);
+    Repo *system = create_repo(sack, HY_SYSTEM_REPO_NAME);
+    Repodata *available_data = repo_add_repodata(available, 0);
+    Repodata *system_data = repo_add_repodata(system, 0);
+
+    for (unsigned index = 0; index < gen.names.size(); index++) {
+        for (unsigned version = 0; version < versions_of(index); version++) {
+            Id p = add_package(gen, available, available_data, index, version, false);
+            if (index % 7 == 0)
+                gen.samples.nevras.push_back(pool_solvid2str(gen.pool, p));
+        }
+        if (index % 3 == 0)
+            add_package(gen, system, system_data, index, 0, true);
+        if (index % 11 == 0) {
+            gen.samples.provides.push_back("bench(" + gen.names[index] + ")");
+            gen.samples.files.push_back("/usr/share/doc/" + gen.names[index] + "/README");
+        }
+    }
+    gen.samples.names = gen.names;
+
+    for (unsigned index = 0; index < std::max(npackages / 40, 1u); index++)
+        add_advisory(gen, available, available_data, index);
+
+    for (unsigned index = 0; index < std::max(npackages / 500, 2u); index++) {
+        char name[64];
+        g_snprintf(name, sizeof(name), "benchmod%04u", index);
+        gen.samples.modules.push_back(name);
+    }
+    for (unsigned index = 0; index < gen.samples.modules.size(); index++) {
+        add_module(gen, index, "s1");
+        add_module(gen, index, "s2");
+    }
+
+    repodata_internalize(available_data);
+    repodata_internalize(system_data);
+    repo_internalize(available);
+    repo_internalize(system);
+    pool_set_installed(gen.pool, system);
+    return gen.samples;
+}
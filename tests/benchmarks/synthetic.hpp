@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef BENCHMARK_SYNTHETIC_HPP
+#define BENCHMARK_SYNTHETIC_HPP
+
+#include <string>
+#include <vector>
+
+#include "libdnf/dnf-sack.h"
+
+#define SYNTHETIC_REPO_NAME "synthetic"
+
+/* Samples of the generated data, used as the subjects of the benchmarks. */
+struct SyntheticRepos {
+    std::vector<std::string> names;
+    std::vector<std::string> nevras;
+    std::vector<std::string> provides;
+    std::vector<std::string> files;
+    std::vector<std::string> cves;
+    std::vector<std::string> modules;
+    std::string modulemd;
+};
+
+/* Adds an available repo with npackages packages and a system repo with an
+ * older version of every third package to the sack. The packages have
+ * provides, requires, file lists and advisories in roughly the proportions of
+ * the Fedora repos. The same seed gives the same repos. */
+SyntheticRepos synthetic_repos_generate(DnfSack *sack, unsigned npackages, unsigned seed);
+
+#endif /* BENCHMARK_SYNTHETIC_HPP */
@@ -184,7 +184,8 @@ void fixture_reset(void)
     dnf_sack_repo_enabled(sack, "updates", 1);
 }
 
-void setup_yum_sack(DnfSack *sack, const char *yum_repo_name)
+static void
+add_yum_repo(DnfSack *sack, const char *yum_repo_name)
 {
     Pool *pool = dnf_sack_get_pool(sack);
     const char *repo_path = pool_tmpjoin(pool, test_globals.repo_dir,
@@ -197,10 +198,27 @@ void setup_yum_sack(DnfSack *sack, const char *yum_repo_name)
                                DNF_SACK_LOAD_FLAG_USE_FILELISTS |
                                DNF_SACK_LOAD_FLAG_USE_UPDATEINFO |
                                DNF_SACK_LOAD_FLAG_USE_PRESTO, NULL));
-    fail_unless(dnf_sack_count(sack) == TEST_EXPECT_YUM_NSOLVABLES);
     hy_repo_free(repo);
 }
 
+void fixture_yum_delta(void)
+{
+    DnfSack *sack = create_ut_sack();
+    Pool *pool = dnf_sack_get_pool(sack);
+    const char *path = pool_tmpjoin(pool, test_globals.repo_dir,
+                                    "@System-delta.repo", NULL);
+
+    // the version of tour the delta of the yum repo applies to
+    fail_if(load_repo(pool, HY_SYSTEM_REPO_NAME, path, 1));
+    add_yum_repo(sack, YUM_REPO_NAME);
+}
+
+void setup_yum_sack(DnfSack *sack, const char *yum_repo_name)
+{
+    add_yum_repo(sack, yum_repo_name);
+    fail_unless(dnf_sack_count(sack) == TEST_EXPECT_YUM_NSOLVABLES);
+}
+
 void
 teardown(void)
 {
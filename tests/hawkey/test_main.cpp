@@ -83,6 +83,7 @@ main(int argc, const char **argv)
     srunner_add_suite(sr, advisory_suite());
     srunner_add_suite(sr, advisorypkg_suite());
     srunner_add_suite(sr, advisoryref_suite());
+    srunner_add_suite(sr, transaction_suite());
     srunner_run_all(sr, CK_NORMAL);
     number_failed = srunner_ntests_failed(sr);
     srunner_free(sr);
@@ -25,10 +25,12 @@
 #include "libdnf/dnf-advisory.h"
 #include "libdnf/hy-package.h"
 #include "libdnf/hy-package-private.hpp"
+#include "libdnf/hy-packageset.h"
 #include "libdnf/hy-query.h"
 #include "libdnf/dnf-reldep.h"
 #include "libdnf/dnf-reldep-list.h"
 #include "libdnf/dnf-sack-private.hpp"
+#include "libdnf/dnf-transaction-private.hpp"
 #include "libdnf/hy-util.h"
 #include "fixtures.h"
 #include "test_suites.h"
@@ -91,6 +93,27 @@ START_TEST(test_versions)
 }
 END_TEST
 
+START_TEST(test_nevra)
+{
+    DnfSack *sack = test_globals.sack;
+    DnfPackage *pkg1 = by_name(sack, "baby");
+    DnfPackage *pkg2 = by_name(sack, "baby");
+    const char *nevra = dnf_package_get_nevra(pkg1);
+
+    ck_assert_str_eq(nevra, "baby-6:5.0-11.x86_64");
+    fail_unless(dnf_package_get_nevra(pkg2) == nevra);
+
+    // the string outlives the temporary space of the pool
+    Pool *pool = dnf_sack_get_pool(sack);
+    for (Id id = 2; id < pool->nsolvables; ++id)
+        pool_solvable2str(pool, pool_id2solvable(pool, id));
+    ck_assert_str_eq(nevra, "baby-6:5.0-11.x86_64");
+
+    g_object_unref(pkg1);
+    g_object_unref(pkg2);
+}
+END_TEST
+
 START_TEST(test_no_sourcerpm)
 {
     DnfSack *sack = test_globals.sack;
@@ -178,6 +201,42 @@ START_TEST(test_get_files)
 }
 END_TEST
 
+static gboolean
+count_file_cb(const char *filename, const char *basename, gpointer user_data)
+{
+    fail_unless(basename > filename && basename[-1] == '/');
+    return ++*static_cast<int *>(user_data) < 4;
+}
+
+static gboolean
+count_set_file_cb(Id id, const char *filename, const char *basename, gpointer user_data)
+{
+    fail_unless(strchr(basename, '/') == NULL);
+    ++*static_cast<int *>(user_data);
+    return TRUE;
+}
+
+START_TEST(test_foreach_file)
+{
+    DnfSack *sack = test_globals.sack;
+    DnfPackage *pkg = by_name(sack, "tour");
+    int count = 0;
+
+    // stopped by the callback
+    fail_if(dnf_package_foreach_file(pkg, count_file_cb, &count));
+    g_assert_cmpint(count, ==, 4);
+
+    DnfPackageSet *pset = dnf_packageset_new(sack);
+    dnf_packageset_add(pset, pkg);
+    count = 0;
+    fail_unless(dnf_packageset_foreach_file(pset, count_set_file_cb, &count));
+    g_assert_cmpint(count, ==, 6);
+
+    dnf_packageset_free(pset);
+    g_object_unref(pkg);
+}
+END_TEST
+
 START_TEST(test_get_advisories)
 {
     GPtrArray *advisories;
@@ -325,6 +384,34 @@ START_TEST(test_presto)
 }
 END_TEST
 
+START_TEST(test_find_delta)
+{
+    DnfSack *sack = test_globals.sack;
+    DnfPackage *tour = by_name_repo(sack, "tour", YUM_REPO_NAME);
+
+    // the delta from the installed tour-4-5 has 3132 bytes, the package 3000
+    DnfPackageDelta *delta = dnf_transaction_find_delta(sack, tour, 200);
+    fail_if(delta == NULL);
+    ck_assert_str_eq(dnf_packagedelta_get_location(delta), "drpms/tour-4-5_4-6.noarch.drpm");
+    g_object_unref(delta);
+
+    // a delta which isn't smaller than the package is not used
+    fail_unless(dnf_transaction_find_delta(sack, tour, 100) == NULL);
+    g_object_unref(tour);
+}
+END_TEST
+
+START_TEST(test_find_delta_not_installed)
+{
+    DnfSack *sack = test_globals.sack;
+    DnfPackage *pkg = by_name_repo(sack, "mystery-devel", YUM_REPO_NAME);
+
+    // no installed version to apply a delta to, the package is downloaded in full
+    fail_unless(dnf_transaction_find_delta(sack, pkg, 200) == NULL);
+    g_object_unref(pkg);
+}
+END_TEST
+
 START_TEST(test_get_files_cmdline)
 {
     DnfSack *sack = test_globals.sack;
@@ -350,6 +437,7 @@ package_suite(void)
     tcase_add_test(tc, test_package_summary);
     tcase_add_test(tc, test_identical);
     tcase_add_test(tc, test_versions);
+    tcase_add_test(tc, test_nevra);
     tcase_add_test(tc, test_no_sourcerpm);
     suite_add_tcase(s, tc);
 
@@ -366,6 +454,7 @@ package_suite(void)
     tcase_add_unchecked_fixture(tc, fixture_yum, teardown);
     tcase_add_test(tc, test_checksums);
     tcase_add_test(tc, test_get_files);
+    tcase_add_test(tc, test_foreach_file);
     tcase_add_test(tc, test_get_advisories);
     tcase_add_test(tc, test_get_advisories_none);
     tcase_add_test(tc, test_lookup_num);
@@ -374,6 +463,12 @@ package_suite(void)
     tcase_add_test(tc, test_presto);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("Deltas");
+    tcase_add_unchecked_fixture(tc, fixture_yum_delta, teardown);
+    tcase_add_test(tc, test_find_delta);
+    tcase_add_test(tc, test_find_delta_not_installed);
+    suite_add_tcase(s, tc);
+
     tc = tcase_create("WithCmdlinePackage");
     tcase_add_unchecked_fixture(tc, fixture_cmdline_only, teardown);
     tcase_add_test(tc, test_get_files_cmdline);
@@ -19,12 +19,17 @@
  */
 
 
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
 #include "libdnf/hy-package-private.hpp"
 #include "libdnf/hy-packageset-private.hpp"
 #include "libdnf/dnf-sack-private.hpp"
 #include "fixtures.h"
 #include "test_suites.h"
 #include "libdnf/sack/packageset.hpp"
+#include "libdnf/utils/bitmap.hpp"
 
 static DnfPackageSet *pset;
 
@@ -169,6 +174,196 @@ START_TEST(test_get_pkgid)
 }
 END_TEST
 
+// byte by byte references of the bitmap kernels
+
+static std::vector<Id>
+reference_ids(const Map *map)
+{
+    std::vector<Id> ids;
+    for (int i = 0; i < map->size; ++i)
+        for (int bit = 0; bit < 8; ++bit)
+            if (map->map[i] & (1 << bit))
+                ids.push_back((i << 3) + bit);
+    return ids;
+}
+
+static void
+reference_intersect(Map *target, const Map *source)
+{
+    for (int i = 0; i < target->size; ++i)
+        target->map[i] &= i < source->size ? source->map[i] : 0;
+}
+
+static void
+reference_unite(Map *target, const Map *source)
+{
+    if (target->size < source->size)
+        map_grow(target, source->size << 3);
+    for (int i = 0; i < source->size; ++i)
+        target->map[i] |= source->map[i];
+}
+
+static void
+reference_subtract(Map *target, const Map *source)
+{
+    for (int i = 0; i < target->size && i < source->size; ++i)
+        target->map[i] &= ~source->map[i];
+}
+
+static void
+fill_map(Map *map, unsigned *random, unsigned density)
+{
+    for (int id = 0; id < map->size << 3; ++id) {
+        *random = *random * 1103515245 + 12345;
+        if ((*random >> 16) % 100 < density)
+            MAPSET(map, id);
+    }
+}
+
+static bool
+maps_equal(const Map *first, const Map *second)
+{
+    return first->size == second->size && memcmp(first->map, second->map, first->size) == 0;
+}
+
+static void
+check_map(const Map *map)
+{
+    std::vector<Id> expected = reference_ids(map);
+    fail_unless(libdnf::bitmap::count(map) == expected.size());
+    fail_unless(libdnf::bitmap::empty(map) == expected.empty());
+
+    std::vector<Id> ids(expected.size() + 1, -1);
+    fail_unless(libdnf::bitmap::toIds(map, ids.data()) == expected.size());
+    fail_unless(std::equal(expected.begin(), expected.end(), ids.begin()));
+
+    Id id = -1;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        id = libdnf::bitmap::next(map, id);
+        fail_unless(id == expected[i]);
+        // nth() scans from the start, sample it on the large maps
+        if (i % 13 == 0 || i + 1 == expected.size())
+            fail_unless(libdnf::bitmap::nth(map, i) == expected[i]);
+    }
+    fail_unless(libdnf::bitmap::next(map, id) == -1);
+    fail_unless(libdnf::bitmap::next(map, (map->size << 3) - 1) == -1);
+    fail_unless(libdnf::bitmap::nth(map, expected.size()) == -1);
+}
+
+START_TEST(test_bitmap_kernels)
+{
+    DnfSack *sack = test_globals.sack;
+    Pool *pool = dnf_sack_get_pool(sack);
+    const libdnf::bitmap::Isa isas[] = {libdnf::bitmap::Isa::GENERIC,
+                                        libdnf::bitmap::Isa::AVX2};
+    const libdnf::bitmap::Isa selected = libdnf::bitmap::getIsa();
+
+    for (auto isa : isas) {
+        if (!libdnf::bitmap::setIsa(isa))
+            continue;
+        for (unsigned seed = 1; seed < 50; ++seed) {
+            libdnf::PackageSet first(sack);
+            libdnf::PackageSet second(sack);
+            for (Id id = 0; id < pool->nsolvables; ++id) {
+                if ((id * seed) % 7 < seed % 5)
+                    first.set(id);
+                if ((id + seed) % 3 == 0)
+                    second.set(id);
+            }
+
+            fail_unless(first.size() == (size_t) map_count(first.getMap()));
+            std::vector<Id> ids = first.getIds();
+            fail_unless(ids.size() == first.size());
+            fail_unless(first.empty() == ids.empty());
+            Id id = -1;
+            for (unsigned i = 0; i < ids.size(); ++i) {
+                id = first.next(id);
+                fail_unless(id == ids[i]);
+                fail_unless(first[i] == ids[i]);
+                fail_unless(first.has(id));
+            }
+            fail_unless(first.next(id) == -1);
+            fail_unless(first[ids.size()] == -1);
+
+            Map expected;
+            map_init_clone(&expected, first.getMap());
+            libdnf::PackageSet result(first);
+            map_and(&expected, second.getMap());
+            result /= second;
+            fail_unless(memcmp(expected.map, result.getMap()->map, expected.size) == 0);
+            map_or(&expected, first.getMap());
+            result += first;
+            fail_unless(memcmp(expected.map, result.getMap()->map, expected.size) == 0);
+            map_subtract(&expected, second.getMap());
+            result -= second;
+            fail_unless(memcmp(expected.map, result.getMap()->map, expected.size) == 0);
+            map_free(&expected);
+        }
+    }
+    libdnf::bitmap::setIsa(selected);
+}
+END_TEST
+
+START_TEST(test_bitmap_kernels_map_sizes)
+{
+    // sizes in bytes not a multiple of 32 nor 8, so the kernels run their tails
+    const int nbits[] = {4099, 5003, 2050, 8192, 7};
+    const unsigned densities[] = {0, 1, 50, 99, 100};
+    const libdnf::bitmap::Isa isas[] = {libdnf::bitmap::Isa::GENERIC,
+                                        libdnf::bitmap::Isa::AVX2};
+    const libdnf::bitmap::Isa selected = libdnf::bitmap::getIsa();
+
+    for (auto isa : isas) {
+        if (!libdnf::bitmap::setIsa(isa))
+            continue;
+        unsigned random = 1;
+        for (int first_bits : nbits) {
+            for (int second_bits : nbits) {
+                for (unsigned density : densities) {
+                    Map first, second, expected, result;
+                    map_init(&first, first_bits);
+                    map_init(&second, second_bits);
+                    fill_map(&first, &random, density);
+                    fill_map(&second, &random, 50);
+                    check_map(&first);
+
+                    map_init_clone(&expected, &first);
+                    map_init_clone(&result, &first);
+                    reference_intersect(&expected, &second);
+                    libdnf::bitmap::intersect(&result, &second);
+                    fail_unless(maps_equal(&expected, &result));
+                    check_map(&result);
+                    map_free(&expected);
+                    map_free(&result);
+
+                    map_init_clone(&expected, &first);
+                    map_init_clone(&result, &first);
+                    reference_unite(&expected, &second);
+                    libdnf::bitmap::unite(&result, &second);
+                    fail_unless(maps_equal(&expected, &result));
+                    check_map(&result);
+                    map_free(&expected);
+                    map_free(&result);
+
+                    map_init_clone(&expected, &first);
+                    map_init_clone(&result, &first);
+                    reference_subtract(&expected, &second);
+                    libdnf::bitmap::subtract(&result, &second);
+                    fail_unless(maps_equal(&expected, &result));
+                    check_map(&result);
+                    map_free(&expected);
+                    map_free(&result);
+
+                    map_free(&first);
+                    map_free(&second);
+                }
+            }
+        }
+    }
+    libdnf::bitmap::setIsa(selected);
+}
+END_TEST
+
 Suite *
 packageset_suite(void)
 {
@@ -180,6 +375,8 @@ packageset_suite(void)
     tcase_add_test(tc, test_has);
     tcase_add_test(tc, test_get_clone);
     tcase_add_test(tc, test_get_pkgid);
+    tcase_add_test(tc, test_bitmap_kernels);
+    tcase_add_test(tc, test_bitmap_kernels_map_sizes);
     suite_add_tcase(s, tc);
 
     return s;
@@ -32,6 +32,7 @@
 #include "libdnf/dnf-reldep.h"
 #include "libdnf/dnf-reldep-list.h"
 #include "libdnf/dnf-sack-private.hpp"
+#include "libdnf/sack/packagecolumns.hpp"
 #include "libdnf/sack/packageset.hpp"
 #include "libdnf/sack/query.hpp"
 #include "fixtures.h"
@@ -101,6 +102,26 @@ START_TEST(test_query_clone)
 }
 END_TEST
 
+START_TEST(test_query_clone_diverge)
+{
+    const char *namelist[] = {"penny", "fool", NULL};
+    HyQuery q = hy_query_create(test_globals.sack);
+
+    hy_query_filter_in(q, HY_PKG_NAME, HY_EQ, namelist);
+    HyQuery clone = hy_query_clone(q);
+    // the clones share the filters until one of them adds another
+    hy_query_filter(clone, HY_PKG_NAME, HY_NEQ, "fool");
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "fool");
+    hy_query_free(q);
+    HyQuery clone2 = hy_query_clone(clone);
+    hy_query_filter(clone2, HY_PKG_NAME, HY_EQ, "fool");
+    fail_unless(query_count_results(clone) == 1);
+    fail_unless(query_count_results(clone2) == 0);
+    hy_query_free(clone);
+    hy_query_free(clone2);
+}
+END_TEST
+
 START_TEST(test_query_empty)
 {
     HyQuery q = hy_query_create(test_globals.sack);
@@ -145,6 +166,35 @@ START_TEST(test_query_name)
 }
 END_TEST
 
+START_TEST(test_query_columns)
+{
+    using Key = libdnf::PackageColumns::Key;
+    HyQuery q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    libdnf::PackageColumns columns(*q->runSet(), {Key::NAME, Key::EVR, Key::REPONAME,
+                                                  Key::EPOCH, Key::SUMMARY});
+    auto & strings = columns.getStrings();
+
+    fail_unless(columns.getIds().size() == 2);
+    auto & names = columns.getColumn(0);
+    fail_unless(names[0] == names[1]);
+    ck_assert_str_eq(strings[names[0]].c_str(), "jay");
+    auto & evrs = columns.getColumn(1);
+    ck_assert_str_eq(strings[evrs[0]].c_str(), "5.0-0");
+    ck_assert_str_eq(strings[evrs[1]].c_str(), "6.0-0");
+    ck_assert_str_eq(strings[columns.getColumn(2)[1]].c_str(), HY_SYSTEM_REPO_NAME);
+    fail_unless(columns.getColumn(3)[0] == 0);
+    // no summary in the test data
+    fail_unless(columns.getColumn(4)[0] == 0);
+
+    Key key;
+    fail_unless(libdnf::PackageColumns::keyFromString("reponame", &key));
+    fail_unless(key == Key::REPONAME);
+    fail_if(libdnf::PackageColumns::keyFromString("color", &key));
+    hy_query_free(q);
+}
+END_TEST
+
 START_TEST(test_query_evr)
 {
     HyQuery q = hy_query_create(test_globals.sack);
@@ -1023,9 +1073,11 @@ query_suite(void)
     tcase_add_test(tc, test_query_run_set_sanity);
     tcase_add_test(tc, test_query_clear);
     tcase_add_test(tc, test_query_clone);
+    tcase_add_test(tc, test_query_clone_diverge);
     tcase_add_test(tc, test_query_empty);
     tcase_add_test(tc, test_query_repo);
     tcase_add_test(tc, test_query_name);
+    tcase_add_test(tc, test_query_columns);
     tcase_add_test(tc, test_query_evr);
     tcase_add_test(tc, test_query_epoch);
     tcase_add_test(tc, test_query_version);
@@ -37,6 +37,7 @@ Suite *repo_suite(void);
 Suite *sack_suite(void);
 Suite *selector_suite(void);
 Suite *subject_suite(void);
+Suite *transaction_suite(void);
 Suite *util_suite(void);
 
 #endif // TEST_SUITES_H
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+#include "libdnf/dnf-types.h"
+#include "libdnf/dnf-transaction-private.hpp"
+#include "libdnf/hy-package.h"
+#include "fixtures.h"
+#include "test_suites.h"
+#include "testsys.h"
+
+static char *root;
+static char *etc;
+static char *usr;
+
+/* an install root with /usr on a filesystem without any free space */
+static void
+space_fixture(void)
+{
+    fixture_yum();
+
+    root = g_build_filename(test_globals.tmpdir, "space-root", NULL);
+    etc = g_build_filename(root, "etc", NULL);
+    usr = g_build_filename(root, "usr", NULL);
+    fail_if(g_mkdir_with_parents(etc, 0755));
+    fail_if(symlink("/proc", usr));
+}
+
+static void
+space_teardown(void)
+{
+    g_unlink(usr);
+    g_rmdir(etc);
+    g_rmdir(root);
+    g_free(usr);
+    g_free(etc);
+    g_free(root);
+    teardown();
+}
+
+static DnfTransactionSpace *
+space_find(GPtrArray *space, const char *path)
+{
+    for (guint i = 0; i < space->len; i++) {
+        auto entry = static_cast<DnfTransactionSpace *>(g_ptr_array_index(space, i));
+        if (g_strcmp0(entry->path, path) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+START_TEST(test_space_two_filesystems)
+{
+    DnfPackage *tour = by_name_repo(test_globals.sack, "tour", YUM_REPO_NAME);
+    GHashTable *prefixes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    GPtrArray *space = dnf_transaction_space_new();
+    GError *error = NULL;
+
+    // 193 bytes for 2 files in /etc and 4 in /usr
+    dnf_transaction_space_add_package(space, prefixes, root, tour, 1, TRUE);
+    fail_unless(space->len == 2);
+    DnfTransactionSpace *entry = space_find(space, usr);
+    fail_if(entry == NULL);
+    ck_assert_int_eq(entry->needed, 128);
+    entry = space_find(space, etc);
+    fail_if(entry == NULL);
+    ck_assert_int_eq(entry->needed, 64);
+
+    // only the full filesystem is reported
+    fail_if(dnf_transaction_space_check(space, &error));
+    fail_unless(g_error_matches(error, DNF_ERROR, DNF_ERROR_NO_SPACE));
+    fail_if(strstr(error->message, usr) == NULL);
+    fail_if(strstr(error->message, etc) != NULL);
+
+    g_error_free(error);
+    g_ptr_array_unref(space);
+    g_hash_table_unref(prefixes);
+    g_object_unref(tour);
+}
+END_TEST
+
+START_TEST(test_space_removed)
+{
+    DnfPackage *tour = by_name_repo(test_globals.sack, "tour", YUM_REPO_NAME);
+    GHashTable *prefixes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    GPtrArray *space = dnf_transaction_space_new();
+    GError *error = NULL;
+
+    // removing the package frees the space, the full filesystem is fine
+    dnf_transaction_space_add_package(space, prefixes, root, tour, -1, TRUE);
+    fail_unless(space->len == 2);
+    ck_assert_int_eq(space_find(space, usr)->needed, -128);
+    ck_assert_int_eq(space_find(space, etc)->needed, -64);
+    fail_unless(dnf_transaction_space_check(space, &error));
+    fail_unless(error == NULL);
+
+    g_ptr_array_unref(space);
+    g_hash_table_unref(prefixes);
+    g_object_unref(tour);
+}
+END_TEST
+
+Suite *
+transaction_suite(void)
+{
+    Suite *s = suite_create("Transaction");
+    TCase *tc = tcase_create("Space");
+    tcase_add_unchecked_fixture(tc, space_fixture, space_teardown);
+    tcase_add_test(tc, test_space_two_filesystems);
+    tcase_add_test(tc, test_space_removed);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
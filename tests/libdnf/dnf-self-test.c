@@ -22,7 +22,12 @@
 
 #include <glib-object.h>
 #include <stdlib.h>
+#include <string.h>
 #include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
 #include <glib/gstdio.h>
 #include "libdnf/libdnf.h"
 
@@ -788,6 +793,86 @@ dnf_state_small_step_func(void)
     g_object_unref(state);
 }
 
+static void
+dnf_state_trace_cb(const DnfStateSpan *span, gpointer user_data)
+{
+    GArray *spans = (GArray *) user_data;
+    DnfStateSpan copy = *span;
+    g_assert_cmpint(span->duration, >=, 0);
+    /* the strings are only valid during the callback */
+    copy.id = g_strdup(span->id);
+    copy.action_hint = g_strdup(span->action_hint);
+    g_array_append_vals(spans, &copy, 1);
+}
+
+static void
+dnf_state_trace_span_clear(gpointer data)
+{
+    DnfStateSpan *span = (DnfStateSpan *) data;
+    g_free((gchar *) span->id);
+    g_free((gchar *) span->action_hint);
+}
+
+static void
+dnf_state_trace_func(void)
+{
+    DnfState *state;
+    DnfState *child;
+    DnfStateSpan *span;
+    gboolean ret;
+    GError *error = NULL;
+    GArray *spans = g_array_new(FALSE, FALSE, sizeof(DnfStateSpan));
+    guint i;
+
+    g_array_set_clear_func(spans, dnf_state_trace_span_clear);
+    state = dnf_state_new();
+    dnf_state_set_trace_func(state, dnf_state_trace_cb, spans, NULL);
+    ret = dnf_state_set_steps(state, &error, 80, 20, -1);
+    g_assert_no_error(error);
+    g_assert(ret);
+
+    /* a child with its own action */
+    child = dnf_state_get_child(state);
+    dnf_state_set_number_steps(child, 3);
+    dnf_state_action_start(child, DNF_STATE_ACTION_DOWNLOAD_PACKAGES, "hello.rpm");
+    dnf_state_set_speed(child, 1000);
+    for (i = 0; i < 3; i++) {
+        ret = dnf_state_done(child, &error);
+        g_assert_no_error(error);
+        g_assert(ret);
+    }
+    ret = dnf_state_done(state, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    ret = dnf_state_finished(state, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+
+    /* 3 child steps, the child action and 2 parent steps */
+    g_assert_cmpint(spans->len, ==, 6);
+    span = &g_array_index(spans, DnfStateSpan, 0);
+    g_assert_cmpint(span->kind, ==, DNF_STATE_SPAN_KIND_STEP);
+    g_assert_cmpint(span->depth, ==, 1);
+    g_assert_cmpint(span->step, ==, 0);
+    g_assert_cmpint(span->steps, ==, 3);
+    g_assert_cmpint(span->speed, ==, 1000);
+    span = &g_array_index(spans, DnfStateSpan, 3);
+    g_assert_cmpint(span->kind, ==, DNF_STATE_SPAN_KIND_ACTION);
+    g_assert_cmpint(span->depth, ==, 1);
+    g_assert_cmpint(span->action, ==, DNF_STATE_ACTION_DOWNLOAD_PACKAGES);
+    g_assert_cmpstr(span->action_hint, ==, "hello.rpm");
+    g_assert_cmpint(span->speed, ==, 1000);
+    span = &g_array_index(spans, DnfStateSpan, 4);
+    g_assert_cmpint(span->kind, ==, DNF_STATE_SPAN_KIND_STEP);
+    g_assert_cmpint(span->depth, ==, 0);
+    g_assert_cmpint(span->step, ==, 0);
+    span = &g_array_index(spans, DnfStateSpan, 5);
+    g_assert_cmpint(span->step, ==, 1);
+
+    g_object_unref(state);
+    g_array_unref(spans);
+}
+
 static void
 dnf_repo_loader_func(void)
 {
@@ -1188,6 +1273,530 @@ dnf_context_cache_clean_check_func(void)
     g_assert_no_error(error);
 }
 
+/* minimal HTTP server serving the modules test repo under /one/ and /two/ */
+typedef struct {
+    int          fd;
+    guint16      port;
+    GThread     *thread;
+    GPtrArray   *clients;
+    GMutex       mutex;
+    gint         in_flight;
+    gint         max_in_flight;
+    gint         rpm_requests_one;
+    gint         rpm_requests_two;
+    gsize        drop_at;           /* cut rpms not requested by range here */
+    gint         range_requests;
+} DnfTestHttpServer;
+
+typedef struct {
+    DnfTestHttpServer   *server;
+    int                  fd;
+} DnfTestHttpClient;
+
+static void
+dnf_test_http_write_all(int fd, const gchar *data, gsize len)
+{
+    while (len > 0) {
+        ssize_t written = write(fd, data, len);
+        if (written <= 0)
+            return;
+        data += written;
+        len -= written;
+    }
+}
+
+static gpointer
+dnf_test_http_client_thread(gpointer user_data)
+{
+    DnfTestHttpClient *client = (DnfTestHttpClient *) user_data;
+    DnfTestHttpServer *server = client->server;
+    gchar buf[4096];
+    gsize len = 0;
+    gboolean is_rpm = FALSE;
+    const gchar *path = NULL;
+    g_auto(GStrv) request = NULL;
+    g_autofree gchar *filename = NULL;
+    g_autofree gchar *contents = NULL;
+    g_autofree gchar *header = NULL;
+    gsize contents_len = 0;
+    gsize offset = 0;
+    gboolean is_range = FALSE;
+    const gchar *range;
+
+    /* read the request header */
+    while (len < sizeof(buf) - 1) {
+        ssize_t received = read(client->fd, buf + len, sizeof(buf) - 1 - len);
+        if (received <= 0)
+            break;
+        len += received;
+        buf[len] = '\0';
+        if (strstr(buf, "\r\n\r\n") != NULL)
+            break;
+    }
+    buf[len] = '\0';
+
+    range = strstr(buf, "\r\nRange: bytes=");
+    if (range != NULL) {
+        offset = g_ascii_strtoull(range + strlen("\r\nRange: bytes="), NULL, 10);
+        is_range = TRUE;
+    }
+
+    request = g_strsplit(buf, " ", 3);
+    if (g_strv_length(request) == 3 && g_strcmp0(request[0], "GET") == 0)
+        path = request[1];
+    if (path != NULL &&
+        (g_str_has_prefix(path, "/one/") || g_str_has_prefix(path, "/two/")) &&
+        strstr(path, "..") == NULL) {
+        filename = g_build_filename(TESTDATADIR, "modules/modules/_all/x86_64", path + 5, NULL);
+        is_rpm = g_str_has_suffix(path, ".rpm");
+    }
+
+    if (is_rpm) {
+        gint in_flight = g_atomic_int_add(&server->in_flight, 1) + 1;
+        while (TRUE) {
+            gint max = g_atomic_int_get(&server->max_in_flight);
+            if (in_flight <= max ||
+                g_atomic_int_compare_and_exchange(&server->max_in_flight, max, in_flight))
+                break;
+        }
+        g_atomic_int_inc(g_str_has_prefix(path, "/one/") ?
+                         &server->rpm_requests_one : &server->rpm_requests_two);
+        /* give the other transfers a chance to start */
+        g_usleep(G_USEC_PER_SEC / 5);
+    }
+
+    if (filename != NULL && g_file_get_contents(filename, &contents, &contents_len, NULL) &&
+        offset < contents_len) {
+        gsize len_sent = contents_len - offset;
+        if (is_range) {
+            g_atomic_int_inc(&server->range_requests);
+            header = g_strdup_printf("HTTP/1.1 206 Partial Content\r\n"
+                                     "Content-Range: bytes %" G_GSIZE_FORMAT "-%" G_GSIZE_FORMAT
+                                     "/%" G_GSIZE_FORMAT "\r\n"
+                                     "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+                                     "Connection: close\r\n\r\n",
+                                     offset, contents_len - 1, contents_len, len_sent);
+        } else {
+            header = g_strdup_printf("HTTP/1.1 200 OK\r\n"
+                                     "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+                                     "Connection: close\r\n\r\n",
+                                     contents_len);
+            /* the connection drops in the middle of the transfer */
+            if (is_rpm && server->drop_at > 0 && server->drop_at < contents_len)
+                len_sent = server->drop_at;
+        }
+        dnf_test_http_write_all(client->fd, header, strlen(header));
+        dnf_test_http_write_all(client->fd, contents + offset, len_sent);
+    } else {
+        header = g_strdup("HTTP/1.1 404 Not Found\r\n"
+                          "Content-Length: 0\r\n"
+                          "Connection: close\r\n\r\n");
+        dnf_test_http_write_all(client->fd, header, strlen(header));
+    }
+
+    if (is_rpm)
+        g_atomic_int_add(&server->in_flight, -1);
+
+    close(client->fd);
+    g_free(client);
+    return NULL;
+}
+
+static gpointer
+dnf_test_http_server_thread(gpointer user_data)
+{
+    DnfTestHttpServer *server = (DnfTestHttpServer *) user_data;
+
+    while (TRUE) {
+        DnfTestHttpClient *client;
+        int fd = accept(server->fd, NULL, NULL);
+        /* the listening socket was shut down */
+        if (fd < 0)
+            break;
+        client = g_new0(DnfTestHttpClient, 1);
+        client->server = server;
+        client->fd = fd;
+        g_mutex_lock(&server->mutex);
+        g_ptr_array_add(server->clients,
+                        g_thread_new("dnf-http-client", dnf_test_http_client_thread, client));
+        g_mutex_unlock(&server->mutex);
+    }
+    return NULL;
+}
+
+static DnfTestHttpServer *
+dnf_test_http_server_new(void)
+{
+    DnfTestHttpServer *server = g_new0(DnfTestHttpServer, 1);
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    server->fd = socket(AF_INET, SOCK_STREAM, 0);
+    g_assert_cmpint(server->fd, >=, 0);
+    g_assert_cmpint(bind(server->fd, (struct sockaddr *) &addr, sizeof(addr)), ==, 0);
+    g_assert_cmpint(listen(server->fd, 16), ==, 0);
+    g_assert_cmpint(getsockname(server->fd, (struct sockaddr *) &addr, &addr_len), ==, 0);
+    server->port = ntohs(addr.sin_port);
+
+    g_mutex_init(&server->mutex);
+    server->clients = g_ptr_array_new();
+    server->thread = g_thread_new("dnf-http-server", dnf_test_http_server_thread, server);
+    return server;
+}
+
+static void
+dnf_test_http_server_free(DnfTestHttpServer *server)
+{
+    guint i;
+
+    shutdown(server->fd, SHUT_RDWR);
+    close(server->fd);
+    g_thread_join(server->thread);
+    for (i = 0; i < server->clients->len; i++)
+        g_thread_join((GThread *) g_ptr_array_index(server->clients, i));
+    g_ptr_array_unref(server->clients);
+    g_mutex_clear(&server->mutex);
+    g_free(server);
+}
+
+static DnfPackage *
+dnf_test_get_package(DnfSack *sack, const gchar *name, const gchar *reponame)
+{
+    DnfPackage *pkg;
+    HyQuery query;
+    g_autoptr(GPtrArray) pkgs = NULL;
+
+    query = hy_query_create(sack);
+    hy_query_filter(query, HY_PKG_NAME, HY_EQ, name);
+    hy_query_filter(query, HY_PKG_REPONAME, HY_EQ, reponame);
+    pkgs = hy_query_run(query);
+    hy_query_free(query);
+    g_assert_cmpint(pkgs->len, >, 0);
+    pkg = (DnfPackage *) g_object_ref(g_ptr_array_index(pkgs, 0));
+    return pkg;
+}
+
+/* loads both repos served by @server into a new sack */
+static DnfSack *
+dnf_test_http_sack_new(DnfTestHttpServer *server,
+                       const gchar *tmp_dir,
+                       DnfContext **ctx,
+                       DnfRepoLoader **repo_loader)
+{
+    DnfRepo *repo;
+    DnfSack *sack;
+    gboolean ret;
+    guint i;
+    const gchar *repo_ids[] = { "http-one", "http-two", NULL };
+    g_autoptr(GError) error = NULL;
+    g_autoptr(DnfState) state = NULL;
+    g_autofree gchar *repos_dir = NULL;
+    g_autofree gchar *repo_file = NULL;
+    g_autofree gchar *repo_data = NULL;
+    g_autofree gchar *cache_dir = NULL;
+
+    /* two remote repos served by the fixture */
+    repos_dir = g_build_filename(tmp_dir, "yum.repos.d", NULL);
+    cache_dir = g_build_filename(tmp_dir, "cache", NULL);
+    g_assert_cmpint(g_mkdir(repos_dir, 0755), ==, 0);
+    g_assert_cmpint(g_mkdir(cache_dir, 0755), ==, 0);
+    repo_file = g_build_filename(repos_dir, "http.repo", NULL);
+    repo_data = g_strdup_printf("[http-one]\nname=one\nbaseurl=http://127.0.0.1:%u/one/\n"
+                                "enabled=1\ngpgcheck=0\n\n"
+                                "[http-two]\nname=two\nbaseurl=http://127.0.0.1:%u/two/\n"
+                                "enabled=1\ngpgcheck=0\n",
+                                server->port, server->port);
+    ret = g_file_set_contents(repo_file, repo_data, -1, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+
+    *ctx = dnf_context_new();
+    dnf_context_set_repo_dir(*ctx, repos_dir);
+    dnf_context_set_solv_dir(*ctx, tmp_dir);
+    dnf_context_set_cache_dir(*ctx, cache_dir);
+    dnf_context_set_lock_dir(*ctx, tmp_dir);
+    ret = dnf_context_setup(*ctx, NULL, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+
+    /* load metadata of both repos over HTTP */
+    sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, cache_dir);
+    ret = dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    *repo_loader = dnf_repo_loader_new(*ctx);
+    state = dnf_state_new();
+    for (i = 0; repo_ids[i] != NULL; i++) {
+        repo = dnf_repo_loader_get_repo_by_id(*repo_loader, repo_ids[i], &error);
+        g_assert_no_error(error);
+        g_assert(repo != NULL);
+        dnf_state_reset(state);
+        ret = dnf_sack_add_repo(sack, repo, G_MAXUINT, DNF_SACK_ADD_FLAG_NONE, state, &error);
+        g_assert_no_error(error);
+        g_assert(ret);
+    }
+    return sack;
+}
+
+static void
+dnf_package_array_download_func(void)
+{
+    DnfTestHttpServer *server;
+    DnfRepoLoader *repo_loader;
+    gboolean ret;
+    guint i;
+    g_autoptr(GError) error = NULL;
+    g_autoptr(DnfContext) ctx = NULL;
+    g_autoptr(DnfSack) sack = NULL;
+    g_autoptr(DnfState) state = NULL;
+    g_autoptr(GPtrArray) packages = NULL;
+    g_autofree gchar *tmp_dir = NULL;
+    g_autofree gchar *download_dir = NULL;
+
+    server = dnf_test_http_server_new();
+    tmp_dir = g_dir_make_tmp("libdnf-test-XXXXXX", &error);
+    g_assert_no_error(error);
+    download_dir = g_build_filename(tmp_dir, "packages", NULL);
+    g_assert_cmpint(g_mkdir(download_dir, 0755), ==, 0);
+    sack = dnf_test_http_sack_new(server, tmp_dir, &ctx, &repo_loader);
+
+    /* download a package from each repo */
+    packages = g_ptr_array_new_with_free_func(g_object_unref);
+    g_ptr_array_add(packages, dnf_test_get_package(sack, "basesystem", "http-one"));
+    g_ptr_array_add(packages, dnf_test_get_package(sack, "bash-doc", "http-two"));
+    state = dnf_state_new();
+    ret = dnf_package_array_download(packages, download_dir, state, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+
+    for (i = 0; i < packages->len; i++) {
+        DnfPackage *pkg = (DnfPackage *) g_ptr_array_index(packages, i);
+        g_autofree gchar *basename = g_path_get_basename(dnf_package_get_location(pkg));
+        g_autofree gchar *filename = g_build_filename(download_dir, basename, NULL);
+        g_assert(g_file_test(filename, G_FILE_TEST_EXISTS));
+    }
+    g_assert_cmpint(dnf_state_get_percentage(state), ==, 100);
+
+    /* transfers from both repos were in flight at the same time */
+    g_assert_cmpint(server->rpm_requests_one, ==, 1);
+    g_assert_cmpint(server->rpm_requests_two, ==, 1);
+    g_assert_cmpint(server->max_in_flight, ==, 2);
+
+    g_object_unref(repo_loader);
+    dnf_test_http_server_free(server);
+    dnf_remove_recursive(tmp_dir, &error);
+    g_assert_no_error(error);
+}
+
+static void
+dnf_package_array_download_resume_func(void)
+{
+    DnfTestHttpServer *server;
+    DnfRepoLoader *repo_loader;
+    gboolean ret = FALSE;
+    guint i;
+    g_autoptr(GError) error = NULL;
+    g_autoptr(DnfContext) ctx = NULL;
+    g_autoptr(DnfSack) sack = NULL;
+    g_autoptr(DnfState) state = NULL;
+    g_autoptr(GPtrArray) packages = NULL;
+    g_autofree gchar *tmp_dir = NULL;
+    g_autofree gchar *download_dir = NULL;
+    g_autofree gchar *basename = NULL;
+    g_autofree gchar *filename = NULL;
+    g_autofree gchar *resume_fn = NULL;
+    g_autofree gchar *original_fn = NULL;
+    g_autofree gchar *contents = NULL;
+    g_autofree gchar *original = NULL;
+    gsize contents_len = 0;
+    gsize original_len = 0;
+
+    server = dnf_test_http_server_new();
+    tmp_dir = g_dir_make_tmp("libdnf-test-XXXXXX", &error);
+    g_assert_no_error(error);
+    download_dir = g_build_filename(tmp_dir, "packages", NULL);
+    g_assert_cmpint(g_mkdir(download_dir, 0755), ==, 0);
+    sack = dnf_test_http_sack_new(server, tmp_dir, &ctx, &repo_loader);
+
+    packages = g_ptr_array_new_with_free_func(g_object_unref);
+    g_ptr_array_add(packages, dnf_test_get_package(sack, "basesystem", "http-one"));
+    basename = g_path_get_basename(dnf_package_get_location(g_ptr_array_index(packages, 0)));
+    filename = g_build_filename(download_dir, basename, NULL);
+    resume_fn = g_strconcat(filename, ".resume", NULL);
+    original_fn = g_build_filename(TESTDATADIR, "modules/modules/_all/x86_64", basename, NULL);
+    ret = g_file_get_contents(original_fn, &original, &original_len, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+
+    /* partial data of another package are not resumed */
+    ret = g_file_set_contents(filename, "garbage", -1, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    ret = g_file_set_contents(resume_fn, "[resume]\nchecksum=sha256:00\nsize=7\n", -1, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    state = dnf_state_new();
+    ret = dnf_package_array_download(packages, download_dir, state, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    g_assert_cmpint(server->range_requests, ==, 0);
+    g_assert(!g_file_test(resume_fn, G_FILE_TEST_EXISTS));
+    g_assert_cmpint(g_unlink(filename), ==, 0);
+
+    /* every transfer from the start drops halfway, only resuming gets
+     * the complete file */
+    server->drop_at = original_len / 2;
+    ret = FALSE;
+    for (i = 0; i < 3 && !ret; i++) {
+        g_clear_error(&error);
+        dnf_state_reset(state);
+        ret = dnf_package_array_download(packages, download_dir, state, &error);
+        /* the interrupted download is recorded for resuming */
+        if (!ret)
+            g_assert(g_file_test(resume_fn, G_FILE_TEST_EXISTS));
+    }
+    g_assert_no_error(error);
+    g_assert(ret);
+    g_assert_cmpint(server->range_requests, >, 0);
+    g_assert(!g_file_test(resume_fn, G_FILE_TEST_EXISTS));
+
+    /* the partial data were reused and verified with the rest */
+    ret = g_file_get_contents(filename, &contents, &contents_len, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    g_assert_cmpint(contents_len, ==, original_len);
+    g_assert(memcmp(contents, original, original_len) == 0);
+
+    g_object_unref(repo_loader);
+    dnf_test_http_server_free(server);
+    dnf_remove_recursive(tmp_dir, &error);
+    g_assert_no_error(error);
+}
+
+static void
+dnf_transaction_pipeline_func(void)
+{
+    DnfTestHttpServer *server;
+    DnfRepoLoader *repo_loader;
+    DnfTransaction *transactions[2];
+    gboolean ret;
+    guint i;
+    g_autoptr(GError) error = NULL;
+    g_autoptr(DnfContext) ctx = NULL;
+    g_autoptr(DnfSack) sack = NULL;
+    g_autoptr(DnfState) state = NULL;
+    g_autoptr(DnfPackage) pkg = NULL;
+    g_autoptr(GPtrArray) repos = NULL;
+    g_autofree gchar *tmp_dir = NULL;
+    HyGoal goal;
+
+    /* the pipeline imports the system keys before it verifies anything */
+    if (!g_file_test("/etc/pki/rpm-gpg", G_FILE_TEST_IS_DIR)) {
+        g_test_skip("no /etc/pki/rpm-gpg");
+        return;
+    }
+
+    server = dnf_test_http_server_new();
+    tmp_dir = g_dir_make_tmp("libdnf-test-XXXXXX", &error);
+    g_assert_no_error(error);
+    sack = dnf_test_http_sack_new(server, tmp_dir, &ctx, &repo_loader);
+    repos = dnf_repo_loader_get_repos(repo_loader, &error);
+    g_assert_no_error(error);
+    g_assert(repos != NULL);
+
+    /* the test packages are not signed */
+    goal = hy_goal_create(sack);
+    pkg = dnf_test_get_package(sack, "filesystem", "http-one");
+    hy_goal_install(goal, pkg);
+
+    /* one transaction verifying while downloading, one afterwards */
+    state = dnf_state_new();
+    for (i = 0; i < G_N_ELEMENTS(transactions); i++) {
+        transactions[i] = dnf_transaction_new(ctx);
+        dnf_transaction_set_repos(transactions[i], repos);
+        dnf_transaction_set_flags(transactions[i],
+                                  DNF_TRANSACTION_FLAG_ONLY_TRUSTED |
+                                  (i == 0 ? DNF_TRANSACTION_FLAG_PIPELINE : 0));
+        dnf_state_reset(state);
+        ret = dnf_transaction_depsolve(transactions[i], goal, state, &error);
+        g_assert_no_error(error);
+        g_assert(ret);
+    }
+    g_assert_cmpint(dnf_transaction_get_remote_pkgs(transactions[0])->len, ==, 1);
+    dnf_state_reset(state);
+    ret = dnf_transaction_download(transactions[0], state, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    g_assert_cmpint(server->rpm_requests_one, ==, 1);
+
+    /* the verification in the pipeline rejects the package as well */
+    for (i = 0; i < G_N_ELEMENTS(transactions); i++) {
+        ret = dnf_transaction_check_untrusted(transactions[i], goal, &error);
+        g_assert_error(error, DNF_ERROR, DNF_ERROR_GPG_SIGNATURE_INVALID);
+        g_assert(!ret);
+        g_clear_error(&error);
+        g_object_unref(transactions[i]);
+    }
+
+    hy_goal_free(goal);
+    g_object_unref(repo_loader);
+    dnf_test_http_server_free(server);
+    dnf_remove_recursive(tmp_dir, &error);
+    g_assert_no_error(error);
+}
+
+static void
+dnf_keyring_check_untrusted_files_func(void)
+{
+    const gchar *names[] = { "bash-4.4.12-2.x86_64.rpm",
+                             "does-not-exist-1-1.x86_64.rpm",
+                             "basesystem-11-3.noarch.rpm",
+                             "bash-doc-4.4.12-2.noarch.rpm",
+                             NULL };
+    gboolean ret;
+    guint i;
+    GError *error = NULL;
+    GError *errors[5] = { NULL };
+    rpmKeyring keyring;
+    g_autofree gchar *key = NULL;
+    g_autofree gchar *packages = NULL;
+    g_autoptr(GPtrArray) filenames = g_ptr_array_new_with_free_func(g_free);
+
+    /* throw-away keyring, only the package in signed/ is signed by it */
+    keyring = rpmKeyringNew();
+    key = dnf_test_get_filename("gpgkey/signing_key.pub");
+    ret = dnf_keyring_add_public_key(keyring, key, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+
+    packages = dnf_test_get_filename("modules/modules/_all/x86_64");
+    for (i = 0; names[i] != NULL; i++)
+        g_ptr_array_add(filenames, g_build_filename(packages, names[i], NULL));
+    g_ptr_array_add(filenames, dnf_test_get_filename("signed/basesystem-11-3.noarch.rpm"));
+    ret = dnf_keyring_check_untrusted_files(keyring, filenames, errors, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+
+    /* each error is stored at the index of its file */
+    g_assert_error(errors[0], DNF_ERROR, DNF_ERROR_GPG_SIGNATURE_INVALID);
+    g_assert(g_str_has_suffix(errors[0]->message, names[0]));
+    g_assert_error(errors[1], DNF_ERROR, DNF_ERROR_FILE_INVALID);
+    g_assert_error(errors[2], DNF_ERROR, DNF_ERROR_GPG_SIGNATURE_INVALID);
+    g_assert(g_str_has_suffix(errors[2]->message, names[2]));
+    g_assert_error(errors[3], DNF_ERROR, DNF_ERROR_GPG_SIGNATURE_INVALID);
+    g_assert(g_str_has_suffix(errors[3]->message, names[3]));
+    g_assert_no_error(errors[4]);
+    for (i = 0; i < G_N_ELEMENTS(errors); i++)
+        g_clear_error(&errors[i]);
+    rpmKeyringFree(keyring);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1213,6 +1822,10 @@ main(int argc, char **argv)
     g_test_add_func("/libdnf/context", dnf_context_func);
     g_test_add_func("/libdnf/context{cache-clean-check}", dnf_context_cache_clean_check_func);
     g_test_add_func("/libdnf/lock", dnf_lock_func);
+    g_test_add_func("/libdnf/package[array-download]", dnf_package_array_download_func);
+    g_test_add_func("/libdnf/package[array-download-resume]", dnf_package_array_download_resume_func);
+    g_test_add_func("/libdnf/keyring[check-untrusted-files]", dnf_keyring_check_untrusted_files_func);
+    g_test_add_func("/libdnf/transaction[pipeline]", dnf_transaction_pipeline_func);
     g_test_add_func("/libdnf/lock[threads]", dnf_lock_threads_func);
     g_test_add_func("/libdnf/repo", ch_test_repo_func);
     g_test_add_func("/libdnf/state", dnf_state_func);
@@ -1225,6 +1838,7 @@ main(int argc, char **argv)
     g_test_add_func("/libdnf/state[locking]", dnf_state_locking_func);
     g_test_add_func("/libdnf/state[finished]", dnf_state_finished_func);
     g_test_add_func("/libdnf/state[small-step]", dnf_state_small_step_func);
+    g_test_add_func("/libdnf/state[trace]", dnf_state_trace_func);
 
     return g_test_run();
 }
@@ -0,0 +1,143 @@
+#include "PackageStoreTest.hpp"
+
+#include <cstdlib>
+#include <sys/stat.h>
+
+#include "libdnf/dnf-package-store.hpp"
+#include "libdnf/dnf-repo-loader.h"
+#include "libdnf/dnf-utils.h"
+#include "libdnf/hy-query.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PackageStoreTest);
+
+static std::string
+readFile(const std::string &path)
+{
+    g_autofree gchar *data = nullptr;
+    gsize len = 0;
+    if (!g_file_get_contents(path.c_str(), &data, &len, nullptr))
+        return std::string();
+    return std::string(data, len);
+}
+
+void PackageStoreTest::setUp()
+{
+    GError *error = nullptr;
+    char tmpl[] = "/tmp/libdnf_test_package_store_XXXXXX";
+    tmpDir = mkdtemp(tmpl);
+    storeDir = tmpDir + "/store";
+
+    context = dnf_context_new();
+    dnf_context_set_release_ver(context, "26");
+    dnf_context_set_arch(context, "x86_64");
+    dnf_context_set_install_root(context, TESTDATADIR "/modules/");
+    dnf_context_set_repo_dir(context, TESTDATADIR "/modules/yum.repos.d/");
+    dnf_context_set_solv_dir(context, tmpDir.c_str());
+    dnf_context_set_cache_dir(context, (tmpDir + "/cache").c_str());
+    auto ret = dnf_context_setup(context, nullptr, &error);
+    g_assert_no_error(error);
+    CPPUNIT_ASSERT(ret);
+    DnfRepo *repo = dnf_repo_loader_get_repo_by_id(dnf_context_get_repo_loader(context), "test", &error);
+    g_assert_no_error(error);
+    CPPUNIT_ASSERT(repo != nullptr);
+    g_autoptr(DnfState) state = dnf_state_new();
+    dnf_repo_check(repo, G_MAXUINT, state, &error);
+    g_clear_error(&error);
+    ret = dnf_context_setup_sack(context, dnf_context_get_state(context), &error);
+    g_assert_no_error(error);
+    CPPUNIT_ASSERT(ret);
+
+    HyQuery query = hy_query_create(dnf_context_get_sack(context));
+    hy_query_filter(query, HY_PKG_NAME, HY_EQ, "basesystem");
+    hy_query_filter(query, HY_PKG_REPONAME, HY_EQ, "test");
+    g_autoptr(GPtrArray) pkgs = hy_query_run(query);
+    hy_query_free(query);
+    CPPUNIT_ASSERT(pkgs->len > 0);
+    package = DNF_PACKAGE(g_object_ref(g_ptr_array_index(pkgs, 0)));
+
+    // a repo cache with the downloaded package, the test data stay untouched
+    contents = readFile(dnf_package_get_filename(package));
+    CPPUNIT_ASSERT(!contents.empty());
+    CPPUNIT_ASSERT(g_mkdir_with_parents((tmpDir + "/one").c_str(), 0755) == 0);
+    CPPUNIT_ASSERT(g_file_set_contents(cacheFile("one").c_str(), contents.data(), contents.size(), nullptr));
+    dnf_package_set_filename(package, cacheFile("one").c_str());
+}
+
+void PackageStoreTest::tearDown()
+{
+    g_object_unref(package);
+    g_object_unref(context);
+    dnf_remove_recursive(tmpDir.c_str(), nullptr);
+}
+
+std::string PackageStoreTest::cacheFile(const std::string &cache) const
+{
+    return tmpDir + "/" + cache + "/basesystem.rpm";
+}
+
+void PackageStoreTest::testPublish()
+{
+    GError *error = nullptr;
+    CPPUNIT_ASSERT(dnf_package_store_publish(storeDir.c_str(), package, &error));
+    g_assert_no_error(error);
+
+    // published again by another repo cache
+    CPPUNIT_ASSERT(dnf_package_store_publish(storeDir.c_str(), package, &error));
+    g_assert_no_error(error);
+
+    struct stat st;
+    CPPUNIT_ASSERT(stat(cacheFile("one").c_str(), &st) == 0);
+    CPPUNIT_ASSERT(st.st_nlink == 2);
+}
+
+void PackageStoreTest::testCheckout()
+{
+    GError *error = nullptr;
+    gboolean valid = FALSE;
+
+    // not in the store yet
+    dnf_package_set_filename(package, cacheFile("two").c_str());
+    CPPUNIT_ASSERT(!dnf_package_store_checkout(storeDir.c_str(), package));
+    CPPUNIT_ASSERT(!g_file_test(cacheFile("two").c_str(), G_FILE_TEST_EXISTS));
+
+    dnf_package_set_filename(package, cacheFile("one").c_str());
+    CPPUNIT_ASSERT(dnf_package_store_publish(storeDir.c_str(), package, &error));
+    g_assert_no_error(error);
+
+    dnf_package_set_filename(package, cacheFile("two").c_str());
+    CPPUNIT_ASSERT(dnf_package_store_checkout(storeDir.c_str(), package));
+    CPPUNIT_ASSERT(contents == readFile(cacheFile("two")));
+    CPPUNIT_ASSERT(dnf_package_check_filename(package, &valid, &error));
+    g_assert_no_error(error);
+    CPPUNIT_ASSERT(valid);
+}
+
+void PackageStoreTest::testCheckoutCorrupted()
+{
+    GError *error = nullptr;
+    CPPUNIT_ASSERT(dnf_package_store_publish(storeDir.c_str(), package, &error));
+    g_assert_no_error(error);
+
+    // an in-place write to a linked cache file reaches the store object
+    std::string corrupted(contents);
+    corrupted[corrupted.size() / 2] ^= 0xff;
+    FILE *fp = fopen(cacheFile("one").c_str(), "r+");
+    CPPUNIT_ASSERT(fp != nullptr);
+    CPPUNIT_ASSERT(fwrite(corrupted.data(), 1, corrupted.size(), fp) == corrupted.size());
+    fclose(fp);
+
+    // the corrupted object is not checked out and leaves the store
+    dnf_package_set_filename(package, cacheFile("two").c_str());
+    CPPUNIT_ASSERT(!dnf_package_store_checkout(storeDir.c_str(), package));
+    CPPUNIT_ASSERT(!g_file_test(cacheFile("two").c_str(), G_FILE_TEST_EXISTS));
+    CPPUNIT_ASSERT(!dnf_package_store_checkout(storeDir.c_str(), package));
+
+    // so a good copy can be published again
+    CPPUNIT_ASSERT(g_file_set_contents(cacheFile("one").c_str(), contents.data(), contents.size(), nullptr));
+    dnf_package_set_filename(package, cacheFile("one").c_str());
+    CPPUNIT_ASSERT(dnf_package_store_publish(storeDir.c_str(), package, &error));
+    g_assert_no_error(error);
+    dnf_package_set_filename(package, cacheFile("two").c_str());
+    CPPUNIT_ASSERT(dnf_package_store_checkout(storeDir.c_str(), package));
+    CPPUNIT_ASSERT(contents == readFile(cacheFile("two")));
+}
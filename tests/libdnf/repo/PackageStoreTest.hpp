@@ -0,0 +1,37 @@
+#ifndef LIBDNF_PACKAGESTORETEST_HPP
+#define LIBDNF_PACKAGESTORETEST_HPP
+
+#include <string>
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "libdnf/dnf-context.h"
+#include "libdnf/dnf-package.h"
+
+class PackageStoreTest : public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(PackageStoreTest);
+        CPPUNIT_TEST(testPublish);
+        CPPUNIT_TEST(testCheckout);
+        CPPUNIT_TEST(testCheckoutCorrupted);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void testPublish();
+    void testCheckout();
+    void testCheckoutCorrupted();
+
+private:
+    DnfContext *context;
+    DnfPackage *package;
+    std::string tmpDir;
+    std::string storeDir;
+    std::string contents;
+    std::string cacheFile(const std::string &cache) const;
+};
+
+#endif //LIBDNF_PACKAGESTORETEST_HPP
@@ -0,0 +1,74 @@
+#include <cstdlib>
+#include <string>
+
+#include "libdnf/dnf-transaction-private.hpp"
+#include "libdnf/dnf-utils.h"
+
+#include "DnfTransactionTest.hpp"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DnfTransactionTest);
+
+void
+DnfTransactionTest::setUp()
+{
+    char tmpl[] = "/tmp/libdnf_test_transaction_XXXXXX";
+    tmpDir = mkdtemp(tmpl);
+
+    // the test key covers the state of the rpmdb, an empty one will do
+    auto rpmDir = tmpDir + "/root/var/lib/rpm";
+    CPPUNIT_ASSERT(g_mkdir_with_parents(rpmDir.c_str(), 0755) == 0);
+    CPPUNIT_ASSERT(g_file_set_contents((rpmDir + "/Packages").c_str(), "", 0, nullptr));
+    auto reposDir = tmpDir + "/yum.repos.d";
+    CPPUNIT_ASSERT(g_mkdir_with_parents(reposDir.c_str(), 0755) == 0);
+
+    GError *error = nullptr;
+    context = dnf_context_new();
+    dnf_context_set_release_ver(context, "26");
+    dnf_context_set_arch(context, "x86_64");
+    dnf_context_set_install_root(context, (tmpDir + "/root").c_str());
+    dnf_context_set_repo_dir(context, reposDir.c_str());
+    dnf_context_set_cache_dir(context, (tmpDir + "/cache").c_str());
+    dnf_context_set_solv_dir(context, (tmpDir + "/solv").c_str());
+    auto ret = dnf_context_setup(context, nullptr, &error);
+    g_assert_no_error(error);
+    CPPUNIT_ASSERT(ret);
+    ret = dnf_context_setup_sack_with_flags(context,
+                                            dnf_context_get_state(context),
+                                            DNF_CONTEXT_SETUP_SACK_FLAG_SKIP_RPMDB,
+                                            &error);
+    g_assert_no_error(error);
+    CPPUNIT_ASSERT(ret);
+}
+
+void
+DnfTransactionTest::tearDown()
+{
+    g_object_unref(context);
+    dnf_remove_recursive(tmpDir.c_str(), nullptr);
+}
+
+void
+DnfTransactionTest::testTestKeyCheckTransaction()
+{
+    g_autoptr(GPtrArray) install = g_ptr_array_new();
+    g_autoptr(GPtrArray) remove = g_ptr_array_new();
+
+    // the test run doesn't call rpmtsCheck()
+    dnf_context_set_check_transaction(context, FALSE);
+    g_autofree gchar *testKey = dnf_transaction_get_test_key(context, 0, install, remove, nullptr);
+    CPPUNIT_ASSERT(testKey != nullptr);
+    dnf_transaction_set_tested(context, testKey);
+    CPPUNIT_ASSERT(dnf_transaction_was_tested(context, testKey));
+
+    // so the real commit with the check enabled must not skip it
+    dnf_context_set_check_transaction(context, TRUE);
+    g_autofree gchar *commitKey = dnf_transaction_get_test_key(context, 0, install, remove, nullptr);
+    CPPUNIT_ASSERT(commitKey != nullptr);
+    CPPUNIT_ASSERT(g_strcmp0(testKey, commitKey) != 0);
+    CPPUNIT_ASSERT(!dnf_transaction_was_tested(context, commitKey));
+
+    // an unchanged setting keeps the key
+    dnf_context_set_check_transaction(context, FALSE);
+    g_autofree gchar *againKey = dnf_transaction_get_test_key(context, 0, install, remove, nullptr);
+    CPPUNIT_ASSERT_EQUAL(std::string(testKey), std::string(againKey));
+}
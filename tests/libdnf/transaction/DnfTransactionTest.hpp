@@ -0,0 +1,27 @@
+#ifndef LIBDNF_DNF_TRANSACTION_TEST_HPP
+#define LIBDNF_DNF_TRANSACTION_TEST_HPP
+
+#include <string>
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "libdnf/dnf-context.h"
+
+class DnfTransactionTest : public CppUnit::TestCase {
+    CPPUNIT_TEST_SUITE(DnfTransactionTest);
+    CPPUNIT_TEST(testTestKeyCheckTransaction);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void testTestKeyCheckTransaction();
+
+private:
+    DnfContext *context;
+    std::string tmpDir;
+};
+
+#endif // LIBDNF_DNF_TRANSACTION_TEST_HPP
@@ -0,0 +1,286 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libdnf/transaction/HistoryExporter.hpp"
+#include "libdnf/transaction/RPMItem.hpp"
+#include "libdnf/transaction/Transformer.hpp"
+#include "libdnf/transaction/private/Transaction.hpp"
+
+#include "HistoryExporterTest.hpp"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HistoryExporterTest);
+
+using namespace libdnf;
+
+/**
+ * Decoded content of a history export
+ */
+struct Export {
+    struct Item {
+        std::string name;
+        int32_t epoch;
+        std::string version;
+        std::string release;
+        std::string arch;
+        std::string repoid;
+        int action;
+        int reason;
+        int state;
+    };
+
+    struct Trans {
+        int64_t id;
+        int64_t dtBegin;
+        int64_t dtEnd;
+        uint32_t userId;
+        std::string releasever;
+        std::string cmdline;
+        int state;
+        std::vector< Item > items;
+    };
+
+    uint32_t version;
+    int64_t sinceId;
+    int64_t lastId;
+    std::vector< std::string > strings{""};
+    std::vector< Trans > transactions;
+};
+
+static uint64_t
+readUInt(std::istream &in, std::size_t size)
+{
+    uint64_t value = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        value |= static_cast< uint64_t >(static_cast< unsigned char >(in.get())) << (8 * i);
+    }
+    CPPUNIT_ASSERT(in.good());
+    return value;
+}
+
+static Export
+decode(const std::string &data)
+{
+    std::istringstream in(data);
+    Export result;
+
+    char magic[8];
+    in.read(magic, sizeof(magic));
+    CPPUNIT_ASSERT(std::string(magic, sizeof(magic)) == std::string("DNFHIST", 8));
+    result.version = readUInt(in, 4);
+    result.sinceId = readUInt(in, 8);
+
+    auto string = [&in, &result]() { return result.strings.at(readUInt(in, 4)); };
+
+    while (true) {
+        char type = readUInt(in, 1);
+        if (type == 'S') {
+            std::string value(readUInt(in, 4), '\0');
+            in.read(&value[0], value.size());
+            result.strings.push_back(value);
+        } else if (type == 'T') {
+            Export::Trans trans;
+            trans.id = readUInt(in, 8);
+            trans.dtBegin = readUInt(in, 8);
+            trans.dtEnd = readUInt(in, 8);
+            trans.userId = readUInt(in, 4);
+            trans.releasever = string();
+            trans.cmdline = string();
+            trans.state = readUInt(in, 1);
+            result.transactions.push_back(trans);
+        } else if (type == 'I') {
+            CPPUNIT_ASSERT(!result.transactions.empty());
+            Export::Item item;
+            item.name = string();
+            item.epoch = readUInt(in, 4);
+            item.version = string();
+            item.release = string();
+            item.arch = string();
+            item.repoid = string();
+            item.action = readUInt(in, 1);
+            item.reason = readUInt(in, 1);
+            item.state = readUInt(in, 1);
+            result.transactions.back().items.push_back(item);
+        } else {
+            CPPUNIT_ASSERT_EQUAL('E', type);
+            result.lastId = readUInt(in, 8);
+            break;
+        }
+    }
+
+    // nothing follows the end record
+    in.peek();
+    CPPUNIT_ASSERT(in.eof());
+    return result;
+}
+
+static void
+addRPM(SQLite3Ptr conn,
+       swdb_private::Transaction &trans,
+       const std::string &name,
+       int64_t epoch,
+       const std::string &version,
+       const std::string &repoid,
+       TransactionItemAction action)
+{
+    auto rpm = std::make_shared< RPMItem >(conn);
+    rpm->setName(name);
+    rpm->setEpoch(epoch);
+    rpm->setVersion(version);
+    rpm->setRelease("1.fc26");
+    rpm->setArch("x86_64");
+    auto ti = trans.addItem(rpm, repoid, action, TransactionItemReason::USER);
+    ti->setState(TransactionItemState::DONE);
+}
+
+void
+HistoryExporterTest::setUp()
+{
+    conn = std::make_shared< SQLite3 >(":memory:");
+    Transformer::createDatabase(conn);
+}
+
+void
+HistoryExporterTest::tearDown()
+{
+}
+
+void
+HistoryExporterTest::testExport()
+{
+    swdb_private::Transaction first(conn);
+    first.setDtBegin(1);
+    first.setDtEnd(2);
+    first.setUserId(1000);
+    first.setReleasever("26");
+    first.setCmdline("dnf install bash vim-enhanced");
+    addRPM(conn, first, "bash", 0, "4.4.12", "base", TransactionItemAction::INSTALL);
+    addRPM(conn, first, "vim-enhanced", 2, "8.0.1", "updates", TransactionItemAction::INSTALL);
+    first.begin();
+    first.finish(TransactionState::DONE);
+
+    swdb_private::Transaction second(conn);
+    second.setDtBegin(3);
+    second.setDtEnd(4);
+    second.setReleasever("26");
+    addRPM(conn, second, "bash", 0, "4.4.19", "updates", TransactionItemAction::UPGRADE);
+    second.begin();
+    second.finish(TransactionState::ERROR);
+
+    std::ostringstream out;
+    HistoryExporter exporter(conn);
+    CPPUNIT_ASSERT_EQUAL(second.getId(), exporter.exportTransactions(out, 0));
+
+    auto result = decode(out.str());
+    CPPUNIT_ASSERT_EQUAL(HistoryExporter::formatVersion, result.version);
+    CPPUNIT_ASSERT_EQUAL(static_cast< int64_t >(0), result.sinceId);
+    CPPUNIT_ASSERT_EQUAL(second.getId(), result.lastId);
+    CPPUNIT_ASSERT_EQUAL(static_cast< std::size_t >(2), result.transactions.size());
+
+    auto &trans = result.transactions[0];
+    CPPUNIT_ASSERT_EQUAL(first.getId(), trans.id);
+    CPPUNIT_ASSERT_EQUAL(static_cast< int64_t >(1), trans.dtBegin);
+    CPPUNIT_ASSERT_EQUAL(static_cast< int64_t >(2), trans.dtEnd);
+    CPPUNIT_ASSERT_EQUAL(static_cast< uint32_t >(1000), trans.userId);
+    CPPUNIT_ASSERT_EQUAL(std::string("26"), trans.releasever);
+    CPPUNIT_ASSERT_EQUAL(std::string("dnf install bash vim-enhanced"), trans.cmdline);
+    CPPUNIT_ASSERT_EQUAL(static_cast< int >(TransactionState::DONE), trans.state);
+    CPPUNIT_ASSERT_EQUAL(static_cast< std::size_t >(2), trans.items.size());
+
+    auto &item = trans.items[1];
+    CPPUNIT_ASSERT_EQUAL(std::string("vim-enhanced"), item.name);
+    CPPUNIT_ASSERT_EQUAL(2, item.epoch);
+    CPPUNIT_ASSERT_EQUAL(std::string("8.0.1"), item.version);
+    CPPUNIT_ASSERT_EQUAL(std::string("1.fc26"), item.release);
+    CPPUNIT_ASSERT_EQUAL(std::string("x86_64"), item.arch);
+    CPPUNIT_ASSERT_EQUAL(std::string("updates"), item.repoid);
+    CPPUNIT_ASSERT_EQUAL(static_cast< int >(TransactionItemAction::INSTALL), item.action);
+    CPPUNIT_ASSERT_EQUAL(static_cast< int >(TransactionItemReason::USER), item.reason);
+    CPPUNIT_ASSERT_EQUAL(static_cast< int >(TransactionItemState::DONE), item.state);
+
+    auto &trans2 = result.transactions[1];
+    CPPUNIT_ASSERT_EQUAL(std::string(), trans2.cmdline);
+    CPPUNIT_ASSERT_EQUAL(static_cast< int >(TransactionState::ERROR), trans2.state);
+    CPPUNIT_ASSERT_EQUAL(static_cast< std::size_t >(1), trans2.items.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("4.4.19"), trans2.items[0].version);
+    CPPUNIT_ASSERT_EQUAL(static_cast< int >(TransactionItemAction::UPGRADE), trans2.items[0].action);
+
+    // each string is stored only once
+    CPPUNIT_ASSERT_EQUAL(static_cast< std::size_t >(12), result.strings.size());
+}
+
+void
+HistoryExporterTest::testIncrementalExport()
+{
+    swdb_private::Transaction first(conn);
+    first.setDtBegin(1);
+    first.setReleasever("26");
+    addRPM(conn, first, "bash", 0, "4.4.12", "base", TransactionItemAction::INSTALL);
+    first.begin();
+    first.finish(TransactionState::DONE);
+
+    // unfinished transaction is not exported
+    swdb_private::Transaction second(conn);
+    second.setDtBegin(2);
+    second.setReleasever("26");
+    addRPM(conn, second, "vim-enhanced", 2, "8.0.1", "updates", TransactionItemAction::INSTALL);
+    second.begin();
+
+    HistoryExporter exporter(conn);
+    std::ostringstream out;
+    auto lastId = exporter.exportTransactions(out, 0);
+    CPPUNIT_ASSERT_EQUAL(first.getId(), lastId);
+    CPPUNIT_ASSERT_EQUAL(static_cast< std::size_t >(1), decode(out.str()).transactions.size());
+
+    // nothing new
+    std::ostringstream empty;
+    CPPUNIT_ASSERT_EQUAL(lastId, exporter.exportTransactions(empty, lastId));
+    CPPUNIT_ASSERT(decode(empty.str()).transactions.empty());
+
+    second.finish(TransactionState::DONE);
+
+    // only the new transaction is exported, with its own string table
+    std::ostringstream delta;
+    CPPUNIT_ASSERT_EQUAL(second.getId(), exporter.exportTransactions(delta, lastId));
+    auto result = decode(delta.str());
+    CPPUNIT_ASSERT_EQUAL(lastId, result.sinceId);
+    CPPUNIT_ASSERT_EQUAL(static_cast< std::size_t >(1), result.transactions.size());
+    CPPUNIT_ASSERT_EQUAL(second.getId(), result.transactions[0].id);
+    CPPUNIT_ASSERT_EQUAL(std::string("vim-enhanced"), result.transactions[0].items[0].name);
+    CPPUNIT_ASSERT_EQUAL(std::string("26"), result.transactions[0].releasever);
+}
+
+void
+HistoryExporterTest::testExportInterrupted()
+{
+    // crashed transaction, never finished
+    swdb_private::Transaction first(conn);
+    first.setDtBegin(1);
+    first.setReleasever("26");
+    addRPM(conn, first, "bash", 0, "4.4.12", "base", TransactionItemAction::INSTALL);
+    first.begin();
+
+    swdb_private::Transaction second(conn);
+    second.setDtBegin(2);
+    second.setReleasever("26");
+    addRPM(conn, second, "vim-enhanced", 2, "8.0.1", "updates", TransactionItemAction::INSTALL);
+    second.begin();
+    second.finish(TransactionState::DONE);
+
+    // the interrupted transaction doesn't block the newer one
+    HistoryExporter exporter(conn);
+    std::ostringstream out;
+    CPPUNIT_ASSERT_EQUAL(second.getId(), exporter.exportTransactions(out, 0));
+    auto result = decode(out.str());
+    CPPUNIT_ASSERT_EQUAL(static_cast< std::size_t >(2), result.transactions.size());
+    CPPUNIT_ASSERT_EQUAL(first.getId(), result.transactions[0].id);
+    CPPUNIT_ASSERT_EQUAL(static_cast< int >(TransactionState::UNKNOWN), result.transactions[0].state);
+    CPPUNIT_ASSERT_EQUAL(std::string("bash"), result.transactions[0].items[0].name);
+    CPPUNIT_ASSERT_EQUAL(second.getId(), result.transactions[1].id);
+    CPPUNIT_ASSERT_EQUAL(static_cast< int >(TransactionState::DONE), result.transactions[1].state);
+
+    // the cursor moved past both
+    std::ostringstream empty;
+    CPPUNIT_ASSERT_EQUAL(second.getId(), exporter.exportTransactions(empty, second.getId()));
+    CPPUNIT_ASSERT(decode(empty.str()).transactions.empty());
+}
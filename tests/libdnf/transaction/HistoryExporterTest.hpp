@@ -0,0 +1,28 @@
+#ifndef LIBDNF_SWDB_HISTORYEXPORTER_TEST_HPP
+#define LIBDNF_SWDB_HISTORYEXPORTER_TEST_HPP
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "libdnf/utils/sqlite3/Sqlite3.hpp"
+
+class HistoryExporterTest : public CppUnit::TestCase {
+    CPPUNIT_TEST_SUITE(HistoryExporterTest);
+    CPPUNIT_TEST(testExport);
+    CPPUNIT_TEST(testIncrementalExport);
+    CPPUNIT_TEST(testExportInterrupted);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void testExport();
+    void testIncrementalExport();
+    void testExportInterrupted();
+
+private:
+    std::shared_ptr< SQLite3 > conn;
+};
+
+#endif // LIBDNF_SWDB_HISTORYEXPORTER_TEST_HPP
@@ -5,6 +5,8 @@
 
 #include "../backports.hpp"
 
+#include "libdnf/hy-subject.h"
+#include "libdnf/nevra.hpp"
 #include "libdnf/transaction/RPMItem.hpp"
 #include "libdnf/transaction/Transformer.hpp"
 
@@ -117,3 +119,105 @@ RpmItemTest::testGetTransactionItems()
     //CPPUNIT_ASSERT(createMs.count() == 0);
     //CPPUNIT_ASSERT(readMs.count() == 0);
 }
+
+void
+RpmItemTest::testGetTransactionItemsBulk()
+{
+    auto bash = std::make_shared< RPMItem >(conn);
+    bash->setName("bash");
+    bash->setEpoch(0);
+    bash->setVersion("4.4.12");
+    bash->setRelease("5.fc26");
+    bash->setArch("x86_64");
+
+    auto vim = std::make_shared< RPMItem >(conn);
+    vim->setName("vim-enhanced");
+    vim->setEpoch(2);
+    vim->setVersion("8.0.1");
+    vim->setRelease("1.fc26");
+    vim->setArch("x86_64");
+
+    std::vector< int64_t > ids;
+    for (int i = 0; i < 3; i++) {
+        libdnf::swdb_private::Transaction trans(conn);
+        auto ti = trans.addItem(bash, "base", TransactionItemAction::INSTALL, TransactionItemReason::USER);
+        ti->setState(TransactionItemState::DONE);
+        if (i != 1) {
+            auto ti2 = trans.addItem(vim, "updates", TransactionItemAction::INSTALL, TransactionItemReason::DEPENDENCY);
+            ti2->setState(TransactionItemState::DONE);
+        }
+        trans.begin();
+        trans.finish(TransactionState::DONE);
+        ids.push_back(trans.getId());
+    }
+
+    auto items = RPMItem::getTransactionItems(conn, ids);
+    CPPUNIT_ASSERT_EQUAL((size_t)3, items.size());
+
+    for (auto id : ids) {
+        // bulk loaded items have to match items loaded per transaction
+        auto expected = RPMItem::getTransactionItems(conn, id);
+        auto &loaded = items.at(id);
+        CPPUNIT_ASSERT_EQUAL(expected.size(), loaded.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            CPPUNIT_ASSERT_EQUAL(expected[i]->getId(), loaded[i]->getId());
+            CPPUNIT_ASSERT_EQUAL(expected[i]->getRepoid(), loaded[i]->getRepoid());
+            CPPUNIT_ASSERT(expected[i]->getReason() == loaded[i]->getReason());
+            CPPUNIT_ASSERT_EQUAL(expected[i]->getItem()->toStr(), loaded[i]->getItem()->toStr());
+        }
+    }
+
+    // RPMItem objects are shared among transactions
+    CPPUNIT_ASSERT(items.at(ids[0]).at(0)->getItem() == items.at(ids[1]).at(0)->getItem());
+    CPPUNIT_ASSERT(items.at(ids[0]).at(1)->getItem() == items.at(ids[2]).at(1)->getItem());
+    CPPUNIT_ASSERT_EQUAL(std::string("vim-enhanced-2:8.0.1-1.fc26.x86_64"),
+                         items.at(ids[2]).at(1)->getItem()->toStr());
+}
+
+static int64_t
+createTransaction(SQLite3Ptr conn, const std::vector< std::string > &nevras, TransactionState state)
+{
+    libdnf::swdb_private::Transaction trans(conn);
+    for (auto &nevraStr : nevras) {
+        Nevra nevra;
+        nevra.parse(nevraStr.c_str(), HY_FORM_NEVRA);
+        auto rpm = std::make_shared< RPMItem >(conn);
+        rpm->setName(nevra.getName());
+        rpm->setEpoch(nevra.getEpoch() < 0 ? 0 : nevra.getEpoch());
+        rpm->setVersion(nevra.getVersion());
+        rpm->setRelease(nevra.getRelease());
+        rpm->setArch(nevra.getArch());
+        auto ti = trans.addItem(rpm, "base", TransactionItemAction::INSTALL, TransactionItemReason::USER);
+        ti->setState(TransactionItemState::DONE);
+    }
+    trans.begin();
+    trans.finish(state);
+    return trans.getId();
+}
+
+void
+RpmItemTest::testSearchTransactions()
+{
+    auto first = createTransaction(conn, {"bash-4.4.12-5.fc26.x86_64"}, TransactionState::DONE);
+    auto second = createTransaction(conn, {"bash-completion-1:2.7-1.fc26.noarch"}, TransactionState::DONE);
+    auto third = createTransaction(
+        conn, {"vim-enhanced-2:8.0.1-1.fc26.x86_64", "bash-4.4.19-1.fc26.x86_64"}, TransactionState::DONE);
+    createTransaction(conn, {"zsh-5.3.1-1.fc26.x86_64"}, TransactionState::ERROR);
+
+    // exact name
+    CPPUNIT_ASSERT(RPMItem::searchTransactions(conn, {"bash"}) ==
+                   std::vector< int64_t >({first, third}));
+    // glob with a literal prefix
+    CPPUNIT_ASSERT(RPMItem::searchTransactions(conn, {"bash*"}) ==
+                   std::vector< int64_t >({first, second, third}));
+    // full NEVRA and NEVR
+    CPPUNIT_ASSERT(RPMItem::searchTransactions(conn, {"bash-4.4.12-5.fc26.x86_64"}) ==
+                   std::vector< int64_t >({first}));
+    CPPUNIT_ASSERT(RPMItem::searchTransactions(conn, {"bash-completion-1:2.7-1.fc26"}) ==
+                   std::vector< int64_t >({second}));
+    // multiple patterns, glob without a literal prefix
+    CPPUNIT_ASSERT(RPMItem::searchTransactions(conn, {"*.noarch", "vim-enhanced"}) ==
+                   std::vector< int64_t >({second, third}));
+    // failed transactions and unknown packages are not reported
+    CPPUNIT_ASSERT(RPMItem::searchTransactions(conn, {"zsh", "nonexistent"}).empty());
+}
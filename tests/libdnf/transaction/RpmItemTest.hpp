@@ -10,6 +10,8 @@ class RpmItemTest : public CppUnit::TestCase {
     CPPUNIT_TEST(testCreate);
     CPPUNIT_TEST(testCreateDuplicates);
     CPPUNIT_TEST(testGetTransactionItems);
+    CPPUNIT_TEST(testGetTransactionItemsBulk);
+    CPPUNIT_TEST(testSearchTransactions);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -19,6 +21,8 @@ public:
     void testCreate();
     void testCreateDuplicates();
     void testGetTransactionItems();
+    void testGetTransactionItemsBulk();
+    void testSearchTransactions();
 
 private:
     std::shared_ptr< SQLite3 > conn;
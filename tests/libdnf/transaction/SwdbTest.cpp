@@ -0,0 +1,220 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "../backports.hpp"
+
+#include "libdnf/transaction/RPMItem.hpp"
+#include "libdnf/transaction/Swdb.hpp"
+#include "libdnf/transaction/Transformer.hpp"
+
+#include "SwdbTest.hpp"
+
+using namespace libdnf;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SwdbTest);
+
+static const char *create_history_sql =
+#include "sql/create_test_history_db.sql"
+    ;
+
+void
+SwdbTest::setUp()
+{
+    char tmpl[] = "/tmp/libdnf_test_swdb_XXXXXX";
+    tmpDir = mkdtemp(tmpl);
+    dbPath = tmpDir + "/history.sqlite";
+
+    auto conn = std::make_shared< SQLite3 >(dbPath);
+    Transformer::createDatabase(conn);
+}
+
+void
+SwdbTest::tearDown()
+{
+    for (auto suffix : {"", "-wal", "-shm", "-journal"}) {
+        unlink((dbPath + suffix).c_str());
+    }
+    rmdir(tmpDir.c_str());
+}
+
+static void
+addRPM(Swdb &swdb, const std::string &name)
+{
+    auto rpm = swdb.createRPMItem();
+    rpm->setName(name);
+    rpm->setEpoch(0);
+    rpm->setVersion("1.0");
+    rpm->setRelease("1.fc28");
+    rpm->setArch("x86_64");
+    swdb.addItem(rpm, "base", TransactionItemAction::INSTALL, TransactionItemReason::USER);
+}
+
+static int64_t
+countItems(Swdb &swdb)
+{
+    SQLite3::Query query(*swdb.getConn(), "SELECT COUNT(*) as count FROM trans_item");
+    query.step();
+    return query.get< int64_t >("count");
+}
+
+void
+SwdbTest::testWalConcurrentReaders()
+{
+    Swdb writer(dbPath, false, true);
+    Swdb firstReader(dbPath, true);
+    Swdb secondReader(dbPath, true);
+
+    // the writer starts a long running transaction
+    writer.initTransaction();
+    addRPM(writer, "foo");
+    addRPM(writer, "bar");
+    auto transId = writer.beginTransaction(1, "begin", "dnf install foo bar", 1000);
+
+    // the first reader takes a snapshot while the transaction is in progress
+    firstReader.getConn()->exec("BEGIN");
+    auto transactions = firstReader.listTransactions();
+    CPPUNIT_ASSERT_EQUAL((size_t)1, transactions.size());
+    CPPUNIT_ASSERT_EQUAL(TransactionState::UNKNOWN, transactions.at(0)->getState());
+    CPPUNIT_ASSERT_EQUAL((int64_t)2, countItems(firstReader));
+
+    // the writer isn't blocked by the open read transaction
+    for (auto item : writer.getItems()) {
+        item->setState(TransactionItemState::DONE);
+    }
+    CPPUNIT_ASSERT_EQUAL(transId, writer.endTransaction(2, "end", TransactionState::DONE));
+
+    writer.initTransaction();
+    addRPM(writer, "baz");
+    writer.beginTransaction(3, "end", "dnf install baz", 1000);
+
+    // the second reader sees the finished transaction and the one in progress
+    secondReader.getConn()->exec("BEGIN");
+    transactions = secondReader.listTransactions();
+    CPPUNIT_ASSERT_EQUAL((size_t)2, transactions.size());
+    CPPUNIT_ASSERT_EQUAL(TransactionState::DONE, transactions.at(0)->getState());
+    CPPUNIT_ASSERT_EQUAL((int64_t)3, countItems(secondReader));
+
+    for (auto item : writer.getItems()) {
+        item->setState(TransactionItemState::DONE);
+    }
+    writer.endTransaction(4, "end 2", TransactionState::DONE);
+
+    // the first reader still sees its original snapshot
+    transactions = firstReader.listTransactions();
+    CPPUNIT_ASSERT_EQUAL((size_t)1, transactions.size());
+    CPPUNIT_ASSERT_EQUAL(TransactionState::UNKNOWN, transactions.at(0)->getState());
+    CPPUNIT_ASSERT_EQUAL((int64_t)2, countItems(firstReader));
+    firstReader.getConn()->exec("COMMIT");
+
+    // the second reader still sees the second transaction in progress
+    transactions = secondReader.listTransactions();
+    CPPUNIT_ASSERT_EQUAL((size_t)2, transactions.size());
+    CPPUNIT_ASSERT_EQUAL(TransactionState::UNKNOWN, transactions.at(1)->getState());
+    secondReader.getConn()->exec("COMMIT");
+
+    // new read transactions see all the changes
+    transactions = firstReader.listTransactions();
+    CPPUNIT_ASSERT_EQUAL((size_t)2, transactions.size());
+    CPPUNIT_ASSERT_EQUAL(TransactionState::DONE, transactions.at(1)->getState());
+    CPPUNIT_ASSERT_EQUAL((int64_t)3, countItems(firstReader));
+    CPPUNIT_ASSERT_EQUAL((size_t)2, firstReader.searchTransactionsByRPM({"foo", "baz"}).size());
+}
+
+void
+SwdbTest::testReadOnly()
+{
+    Swdb reader(dbPath, true);
+    CPPUNIT_ASSERT(reader.getConn()->isReadOnly());
+    CPPUNIT_ASSERT(reader.listTransactions().empty());
+
+    // writing through a read-only instance fails
+    reader.initTransaction();
+    addRPM(reader, "foo");
+    CPPUNIT_ASSERT_THROW(reader.beginTransaction(1, "begin", "dnf install foo", 1000),
+                         SQLite3::LibException);
+}
+
+void
+SwdbTest::testDefaultKeepsWal()
+{
+    {
+        Swdb writer(dbPath, false, true);
+        CPPUNIT_ASSERT_EQUAL(std::string("wal"), writer.getConn()->getJournalMode());
+    }
+
+    // the rollback journal isn't forced on a database switched to WAL
+    Swdb swdb(dbPath, false);
+    CPPUNIT_ASSERT_EQUAL(std::string("wal"), swdb.getConn()->getJournalMode());
+    Swdb legacy(dbPath);
+    CPPUNIT_ASSERT_EQUAL(std::string("wal"), legacy.getConn()->getJournalMode());
+}
+
+void
+SwdbTest::testDefaultWaitsForReader()
+{
+    Swdb writer(dbPath, false);
+    Swdb reader(dbPath, true);
+    CPPUNIT_ASSERT_EQUAL(std::string("truncate"), writer.getConn()->getJournalMode());
+
+    // the reader holds a shared lock until its read transaction ends
+    reader.getConn()->exec("BEGIN");
+    CPPUNIT_ASSERT_EQUAL((int64_t)0, countItems(reader));
+    std::thread endRead([&reader]() {
+        usleep(200000);
+        reader.getConn()->exec("COMMIT");
+    });
+
+    // the commit waits for the lock instead of failing right away
+    writer.initTransaction();
+    addRPM(writer, "foo");
+    CPPUNIT_ASSERT_NO_THROW(writer.beginTransaction(1, "begin", "dnf install foo", 1000));
+    endRead.join();
+    CPPUNIT_ASSERT_EQUAL((int64_t)1, countItems(reader));
+}
+
+void
+SwdbTest::testMigrateProgress()
+{
+    // legacy yum history next to a database which doesn't exist yet
+    auto historyDir = tmpDir + "/history";
+    auto historyPath = historyDir + "/history-2018-01-01.sqlite";
+    auto migratedPath = tmpDir + "/migrated.sqlite";
+    CPPUNIT_ASSERT_EQUAL(0, mkdir(historyDir.c_str(), 0755));
+    {
+        SQLite3 history(historyPath);
+        history.exec(create_history_sql);
+    }
+
+    std::vector< std::pair< int64_t, int64_t > > progress;
+    {
+        Swdb swdb(migratedPath, [&progress](int64_t done, int64_t total) {
+            progress.emplace_back(done, total);
+        });
+        CPPUNIT_ASSERT_EQUAL((size_t)2, swdb.listTransactions().size());
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t)2, progress.size());
+    CPPUNIT_ASSERT_EQUAL((int64_t)1, progress[0].first);
+    CPPUNIT_ASSERT_EQUAL((int64_t)2, progress[1].first);
+    CPPUNIT_ASSERT_EQUAL((int64_t)2, progress[1].second);
+
+    // an existing database isn't migrated again
+    progress.clear();
+    {
+        Swdb swdb(migratedPath, false, true, [&progress](int64_t done, int64_t total) {
+            progress.emplace_back(done, total);
+        });
+    }
+    CPPUNIT_ASSERT(progress.empty());
+
+    for (auto suffix : {"", "-wal", "-shm", "-journal"}) {
+        unlink((migratedPath + suffix).c_str());
+    }
+    unlink(historyPath.c_str());
+    rmdir(historyDir.c_str());
+}
@@ -0,0 +1,33 @@
+#ifndef LIBDNF_SWDB_SWDB_TEST_HPP
+#define LIBDNF_SWDB_SWDB_TEST_HPP
+
+#include <string>
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class SwdbTest : public CppUnit::TestCase {
+    CPPUNIT_TEST_SUITE(SwdbTest);
+    CPPUNIT_TEST(testWalConcurrentReaders);
+    CPPUNIT_TEST(testReadOnly);
+    CPPUNIT_TEST(testDefaultKeepsWal);
+    CPPUNIT_TEST(testDefaultWaitsForReader);
+    CPPUNIT_TEST(testMigrateProgress);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void testWalConcurrentReaders();
+    void testReadOnly();
+    void testDefaultKeepsWal();
+    void testDefaultWaitsForReader();
+    void testMigrateProgress();
+
+private:
+    std::string tmpDir;
+    std::string dbPath;
+};
+
+#endif // LIBDNF_SWDB_SWDB_TEST_HPP
@@ -2,6 +2,7 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "../backports.hpp"
 
@@ -110,9 +111,19 @@ TransformerTest::testGroupTransformation()
 void
 TransformerTest::testTransformTrans()
 {
+    // track the progress
+    std::vector< std::pair< int64_t, int64_t > > progress;
+    transformer.setProgressCallback(
+        [&progress](int64_t done, int64_t total) { progress.emplace_back(done, total); });
+
     // perform database transformation
     transformer.transformTrans(swdb, history);
 
+    CPPUNIT_ASSERT_EQUAL(static_cast< std::size_t >(2), progress.size());
+    CPPUNIT_ASSERT_EQUAL(static_cast< int64_t >(1), progress[0].first);
+    CPPUNIT_ASSERT_EQUAL(static_cast< int64_t >(2), progress[1].first);
+    CPPUNIT_ASSERT_EQUAL(static_cast< int64_t >(2), progress[1].second);
+
     // check first transaction attributes
     libdnf::Transaction first(swdb, 1);
     CPPUNIT_ASSERT(first.getId() == 1);
@@ -11,6 +11,7 @@ public:
     TransformerMock();
     using libdnf::Transformer::Exception;
     using libdnf::Transformer::processGroupPersistor;
+    using libdnf::Transformer::setProgressCallback;
     using libdnf::Transformer::transformTrans;
 };
 